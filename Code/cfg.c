@@ -0,0 +1,486 @@
+#include "cfg.h"
+#include "optimize.h"
+
+int ir_get_label_no(InterCodes code)
+{
+    if (code->code.kind != LABEL_InterCode || code->code.u.singleOP.op->kind != LABEL_OP) {
+        return -1;
+    }
+    return code->code.u.singleOP.op->var_no;
+}
+
+int ir_get_jump_target(InterCodes code)
+{
+    if (code->code.kind == GOTO_InterCode) {
+        return code->code.u.singleOP.op->var_no;
+    }
+    if (code->code.kind == IFGOTO_InterCode) {
+        return code->code.u.ifgotoOP.label->var_no;
+    }
+    return -1;
+}
+
+/* ir_ends_block 代码之后是否必须开始新的基本块 */
+static bool ir_ends_block(InterCodes code)
+{
+    return code->code.kind == GOTO_InterCode || code->code.kind == IFGOTO_InterCode ||
+           code->code.kind == RETURN_InterCode;
+}
+
+/* ir_is_function_end 是否已走出函数：到达下一个FUNCTION或链表头 */
+static bool ir_is_function_end(InterCodes code)
+{
+    return code == interCodeListHead || code->code.kind == FUNC_InterCode;
+}
+
+/* ir_add_block 追加一个基本块；前驱和支配信息由后面的分析重新计算，形状不变时保留 */
+static IRBlock *ir_add_block(IRCfg cfg, InterCodes first)
+{
+    if (cfg->blockCount == cfg->blockCapacity) {
+        int newCapacity = cfg->blockCapacity ? cfg->blockCapacity * 2 : 16;
+        cfg->blocks = (IRBlock *)realloc(cfg->blocks, newCapacity * sizeof(IRBlock));
+        for (int i = cfg->blockCapacity; i < newCapacity; i++) {
+            cfg->blocks[i].preds = NULL;
+            cfg->blocks[i].predCount = 0;
+            cfg->blocks[i].predCapacity = 0;
+        }
+        cfg->blockCapacity = newCapacity;
+    }
+    IRBlock *block = &cfg->blocks[cfg->blockCount++];
+    block->first = first;
+    block->last = first;
+    block->codeCount = 0;
+    block->succ[0] = block->succ[1] = -1;
+    block->succCount = 0;
+    return block;
+}
+
+/* ir_split_blocks 划分基本块并建立标号表 */
+static void ir_split_blocks(IRCfg cfg)
+{
+    cfg->blockCount = 0;
+    int minLabel = -1, maxLabel = -1;
+    IRBlock *block = NULL;
+    for (InterCodes cur = cfg->funcHead->next; !ir_is_function_end(cur); cur = cur->next) {
+        // 标号开始新块，跳转和返回结束当前块
+        if (!block || cur->code.kind == LABEL_InterCode || ir_ends_block(block->last)) {
+            block = ir_add_block(cfg, cur);
+        }
+        block->last = cur;
+        block->codeCount++;
+
+        int labelNo = ir_get_label_no(cur);
+        if (labelNo >= 0) {
+            minLabel = (minLabel < 0 || labelNo < minLabel) ? labelNo : minLabel;
+            maxLabel = labelNo > maxLabel ? labelNo : maxLabel;
+        }
+    }
+
+    cfg->labelBase = minLabel < 0 ? 0 : minLabel;
+    cfg->labelSpan = minLabel < 0 ? 0 : maxLabel - minLabel + 1;
+    if (cfg->labelSpan > cfg->labelCapacity) {
+        cfg->labelCapacity = cfg->labelSpan;
+        cfg->labelBlock = (int *)realloc(cfg->labelBlock, cfg->labelCapacity * sizeof(int));
+    }
+    for (int i = 0; i < cfg->labelSpan; i++) {
+        cfg->labelBlock[i] = -1;
+    }
+    for (int b = 0; b < cfg->blockCount; b++) {
+        int labelNo = ir_get_label_no(cfg->blocks[b].first);
+        if (labelNo >= 0) {
+            cfg->labelBlock[labelNo - cfg->labelBase] = b;
+        }
+    }
+}
+
+/* ir_link_blocks 计算后继块 */
+static void ir_link_blocks(IRCfg cfg)
+{
+    for (int b = 0; b < cfg->blockCount; b++) {
+        IRBlock *block = &cfg->blocks[b];
+        InterCodes last = block->last;
+        int fallThrough = b + 1 < cfg->blockCount ? b + 1 : -1;
+        int target = ir_get_jump_target(last);
+        int targetBlock = target >= 0 ? ir_cfg_label_block(cfg, target) : -1;
+
+        if (last->code.kind == GOTO_InterCode) {
+            block->succ[0] = targetBlock;
+        } else if (last->code.kind == IFGOTO_InterCode) {
+            block->succ[0] = fallThrough;
+            // 跳转目标恰好是下一块时只保留一条边
+            block->succ[1] = targetBlock != fallThrough ? targetBlock : -1;
+        } else if (last->code.kind != RETURN_InterCode) {
+            block->succ[0] = fallThrough;
+        }
+        if (block->succ[0] < 0) {
+            block->succ[0] = block->succ[1];
+            block->succ[1] = -1;
+        }
+        block->succCount = (block->succ[0] >= 0) + (block->succ[1] >= 0);
+    }
+}
+
+/* ir_shape_unchanged 块数和每个块的后继是否与上一次构建相同，并记录本次的后继 */
+static bool ir_shape_unchanged(IRCfg cfg)
+{
+    bool same = cfg->prevSucc && cfg->prevBlockCount == cfg->blockCount;
+    for (int b = 0; same && b < cfg->blockCount; b++) {
+        same = cfg->prevSucc[2 * b] == cfg->blocks[b].succ[0] && cfg->prevSucc[2 * b + 1] == cfg->blocks[b].succ[1];
+    }
+    if (!same) {
+        cfg->prevSucc = (int *)realloc(cfg->prevSucc, (2 * cfg->blockCount + 1) * sizeof(int));
+        for (int b = 0; b < cfg->blockCount; b++) {
+            cfg->prevSucc[2 * b] = cfg->blocks[b].succ[0];
+            cfg->prevSucc[2 * b + 1] = cfg->blocks[b].succ[1];
+        }
+        cfg->prevBlockCount = cfg->blockCount;
+    }
+    return same;
+}
+
+/* ir_add_pred 记录前驱 */
+static void ir_add_pred(IRBlock *block, int pred)
+{
+    if (block->predCount == block->predCapacity) {
+        block->predCapacity = block->predCapacity ? block->predCapacity * 2 : 2;
+        block->preds = (int *)realloc(block->preds, block->predCapacity * sizeof(int));
+    }
+    block->preds[block->predCount++] = pred;
+}
+
+/* ir_compute_order 建立前驱，并用非递归深度优先搜索求逆后序 */
+static void ir_compute_order(IRCfg cfg)
+{
+    for (int b = 0; b < cfg->blockCount; b++) {
+        cfg->blocks[b].predCount = 0;
+        cfg->blocks[b].rpo = -1;
+    }
+    for (int b = 0; b < cfg->blockCount; b++) {
+        for (int s = 0; s < cfg->blocks[b].succCount; s++) {
+            ir_add_pred(&cfg->blocks[cfg->blocks[b].succ[s]], b);
+        }
+    }
+
+    cfg->rpoOrder = (int *)realloc(cfg->rpoOrder, (cfg->blockCount + 1) * sizeof(int));
+    cfg->reachableCount = 0;
+    if (cfg->blockCount == 0) {
+        return;
+    }
+
+    // 栈中保存块号和下一个要访问的后继下标，后序依次写到 rpoOrder 尾部
+    int *stack = (int *)malloc(cfg->blockCount * 2 * sizeof(int));
+    int top = 0;
+    int postCount = 0;
+    cfg->blocks[0].rpo = 0;
+    stack[top++] = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        int b = stack[top - 2];
+        int next = stack[top - 1];
+        if (next < cfg->blocks[b].succCount) {
+            stack[top - 1]++;
+            int s = cfg->blocks[b].succ[next];
+            if (cfg->blocks[s].rpo < 0) {
+                cfg->blocks[s].rpo = 0;
+                stack[top++] = s;
+                stack[top++] = 0;
+            }
+        } else {
+            top -= 2;
+            cfg->rpoOrder[cfg->blockCount - 1 - postCount++] = b;
+        }
+    }
+    free(stack);
+
+    // 把可达块移到数组开头
+    cfg->reachableCount = postCount;
+    memmove(cfg->rpoOrder, cfg->rpoOrder + cfg->blockCount - postCount, postCount * sizeof(int));
+    for (int i = 0; i < postCount; i++) {
+        cfg->blocks[cfg->rpoOrder[i]].rpo = i;
+    }
+}
+
+/* ir_intersect_dominators 两个块在支配树上的最近公共祖先 */
+static int ir_intersect_dominators(IRCfg cfg, int a, int b)
+{
+    while (a != b) {
+        while (cfg->blocks[a].rpo > cfg->blocks[b].rpo) {
+            a = cfg->blocks[a].idom;
+        }
+        while (cfg->blocks[b].rpo > cfg->blocks[a].rpo) {
+            b = cfg->blocks[b].idom;
+        }
+    }
+    return a;
+}
+
+/* ir_compute_dominators 按逆后序迭代求直接支配者（Cooper-Harvey-Kennedy），再给支配树编号 */
+static void ir_compute_dominators(IRCfg cfg)
+{
+    for (int b = 0; b < cfg->blockCount; b++) {
+        cfg->blocks[b].idom = -1;
+        cfg->blocks[b].domChild = -1;
+        cfg->blocks[b].domSibling = -1;
+        cfg->blocks[b].domPre = -1;
+        cfg->blocks[b].domPost = -1;
+    }
+    if (cfg->reachableCount == 0) {
+        return;
+    }
+
+    int entry = cfg->rpoOrder[0];
+    cfg->blocks[entry].idom = entry;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = 1; i < cfg->reachableCount; i++) {
+            IRBlock *block = &cfg->blocks[cfg->rpoOrder[i]];
+            int newIdom = -1;
+            for (int p = 0; p < block->predCount; p++) {
+                int pred = block->preds[p];
+                if (cfg->blocks[pred].idom < 0) {
+                    continue;
+                }
+                newIdom = newIdom < 0 ? pred : ir_intersect_dominators(cfg, pred, newIdom);
+            }
+            if (newIdom != block->idom) {
+                block->idom = newIdom;
+                changed = true;
+            }
+        }
+    }
+
+    // 逆序插入使子结点按逆后序排列
+    for (int i = cfg->reachableCount - 1; i > 0; i--) {
+        int b = cfg->rpoOrder[i];
+        IRBlock *parent = &cfg->blocks[cfg->blocks[b].idom];
+        cfg->blocks[b].domSibling = parent->domChild;
+        parent->domChild = b;
+    }
+
+    // 非递归遍历支配树，栈中保存结点和下一个要访问的子结点
+    int *stack = (int *)malloc(cfg->reachableCount * 2 * sizeof(int));
+    int top = 0;
+    int counter = 0;
+    cfg->blocks[entry].domPre = counter++;
+    stack[top++] = entry;
+    stack[top++] = cfg->blocks[entry].domChild;
+    while (top > 0) {
+        int b = stack[top - 2];
+        int next = stack[top - 1];
+        if (next >= 0) {
+            stack[top - 1] = cfg->blocks[next].domSibling;
+            cfg->blocks[next].domPre = counter++;
+            stack[top++] = next;
+            stack[top++] = cfg->blocks[next].domChild;
+        } else {
+            top -= 2;
+            cfg->blocks[b].domPost = counter++;
+        }
+    }
+    free(stack);
+}
+
+/* ir_compute_loops 由回边求自然循环，外层循环先于内层循环求出 */
+static void ir_compute_loops(IRCfg cfg)
+{
+    cfg->loopCount = 0;
+    for (int b = 0; b < cfg->blockCount; b++) {
+        cfg->blocks[b].loop = -1;
+    }
+
+    int *mark = (int *)malloc((cfg->blockCount + 1) * sizeof(int));
+    int *worklist = (int *)malloc((cfg->blockCount + 1) * sizeof(int));
+    for (int b = 0; b < cfg->blockCount; b++) {
+        mark[b] = -1;
+    }
+    int *loopStart = NULL;
+    int poolSize = 0;
+    int poolCapacity = cfg->blockCount + 1;
+    int *pool = (int *)malloc(poolCapacity * sizeof(int));
+
+    // 外层循环的头支配内层循环的头，按逆后序处理保证外层先处理，内层块的 loop 随后被覆盖
+    for (int i = 0; i < cfg->reachableCount; i++) {
+        int header = cfg->rpoOrder[i];
+        IRBlock *headerBlock = &cfg->blocks[header];
+        int loopIndex = cfg->loopCount;
+        bool hasBackEdge = false;
+        int count = 0;
+        mark[header] = loopIndex;
+        for (int p = 0; p < headerBlock->predCount; p++) {
+            int latch = headerBlock->preds[p];
+            if (!ir_cfg_dominates(cfg, header, latch)) {
+                continue;
+            }
+            hasBackEdge = true;
+            if (mark[latch] != loopIndex) {
+                mark[latch] = loopIndex;
+                worklist[count++] = latch;
+            }
+        }
+        if (!hasBackEdge) {
+            continue;
+        }
+
+        if (cfg->loopCount == cfg->loopCapacity) {
+            cfg->loopCapacity = cfg->loopCapacity ? cfg->loopCapacity * 2 : 8;
+            cfg->loops = (IRLoop *)realloc(cfg->loops, cfg->loopCapacity * sizeof(IRLoop));
+        }
+        loopStart = (int *)realloc(loopStart, cfg->loopCapacity * sizeof(int));
+        cfg->loopCount++;
+        IRLoop *loop = &cfg->loops[loopIndex];
+        loop->header = header;
+        loop->parent = headerBlock->loop;
+        loop->depth = loop->parent < 0 ? 1 : cfg->loops[loop->parent].depth + 1;
+        loopStart[loopIndex] = poolSize;
+
+        // 从回边的源点沿前驱反向走到循环头
+        int blockCount = 0;
+        worklist[count++] = header;
+        while (count > 0) {
+            int b = worklist[--count];
+            if (poolSize == poolCapacity) {
+                poolCapacity *= 2;
+                pool = (int *)realloc(pool, poolCapacity * sizeof(int));
+            }
+            pool[poolSize++] = b;
+            blockCount++;
+            cfg->blocks[b].loop = loopIndex;
+            if (b == header) {
+                continue;
+            }
+            for (int p = 0; p < cfg->blocks[b].predCount; p++) {
+                int pred = cfg->blocks[b].preds[p];
+                if (mark[pred] != loopIndex && cfg->blocks[pred].rpo >= 0) {
+                    mark[pred] = loopIndex;
+                    worklist[count++] = pred;
+                }
+            }
+        }
+        loop->blockCount = blockCount;
+    }
+
+    // 块列表全部求出后 pool 不再扩容，再换成指针
+    free(cfg->loopBlockPool);
+    cfg->loopBlockPool = pool;
+    for (int l = 0; l < cfg->loopCount; l++) {
+        cfg->loops[l].blocks = pool + loopStart[l];
+    }
+    free(loopStart);
+    free(mark);
+    free(worklist);
+}
+
+/* ir_analyze_cfg 划分基本块，形状变化时重新计算支配树和循环 */
+static void ir_analyze_cfg(IRCfg cfg)
+{
+    ir_split_blocks(cfg);
+    ir_link_blocks(cfg);
+    cfg->shapeChanged = !ir_shape_unchanged(cfg);
+    if (!cfg->shapeChanged) {
+        IR_DEBUG(IR_DEBUG_VERBOSE, "控制流图形状未变，沿用支配树和循环信息\n");
+        return;
+    }
+    ir_compute_order(cfg);
+    ir_compute_dominators(cfg);
+    ir_compute_loops(cfg);
+}
+
+IRCfg ir_build_cfg(InterCodes funcHead)
+{
+    IRCfg cfg = (IRCfg)calloc(1, sizeof(*cfg));
+    if (!cfg) {
+        IR_DEBUG(IR_DEBUG_ERROR, "内存分配失败，无法构建控制流图\n");
+        return NULL;
+    }
+    cfg->funcHead = funcHead;
+    ir_analyze_cfg(cfg);
+    return cfg;
+}
+
+void ir_rebuild_cfg(IRCfg cfg)
+{
+    ir_analyze_cfg(cfg);
+}
+
+int ir_cfg_remove_unreachable(IRCfg cfg)
+{
+    int removed = 0;
+    for (int b = 0; b < cfg->blockCount; b++) {
+        IRBlock *block = &cfg->blocks[b];
+        if (block->rpo >= 0) {
+            continue;
+        }
+        // 跳到不可达块标号的代码本身也不可达，一并被删除
+        InterCodes stop = block->last->next;
+        for (InterCodes cur = block->first; cur != stop;) {
+            InterCodes next = cur->next;
+            ir_remove_code(cur);
+            cur = next;
+            removed++;
+        }
+    }
+    if (removed > 0) {
+        ir_rebuild_cfg(cfg);
+    }
+    return removed;
+}
+
+void ir_free_cfg(IRCfg cfg)
+{
+    if (!cfg) {
+        return;
+    }
+    for (int b = 0; b < cfg->blockCapacity; b++) {
+        free(cfg->blocks[b].preds);
+    }
+    free(cfg->blocks);
+    free(cfg->rpoOrder);
+    free(cfg->loops);
+    free(cfg->loopBlockPool);
+    free(cfg->labelBlock);
+    free(cfg->prevSucc);
+    free(cfg);
+}
+
+int ir_cfg_label_block(IRCfg cfg, int labelNo)
+{
+    if (labelNo < cfg->labelBase || labelNo >= cfg->labelBase + cfg->labelSpan) {
+        return -1;
+    }
+    return cfg->labelBlock[labelNo - cfg->labelBase];
+}
+
+bool ir_cfg_dominates(IRCfg cfg, int a, int b)
+{
+    IRBlock *x = &cfg->blocks[a];
+    IRBlock *y = &cfg->blocks[b];
+    return x->domPre >= 0 && y->domPre >= 0 && x->domPre <= y->domPre && y->domPost <= x->domPost;
+}
+
+int ir_cfg_loop_depth(IRCfg cfg, int block)
+{
+    int loop = cfg->blocks[block].loop;
+    return loop < 0 ? 0 : cfg->loops[loop].depth;
+}
+
+void ir_print_cfg(IRCfg cfg, FILE *file)
+{
+    for (int b = 0; b < cfg->blockCount; b++) {
+        IRBlock *block = &cfg->blocks[b];
+        fprintf(file, "B%d: %d codes, rpo %d, idom %d, loop depth %d, succ",
+                b, block->codeCount, block->rpo, block->idom, ir_cfg_loop_depth(cfg, b));
+        for (int s = 0; s < block->succCount; s++) {
+            fprintf(file, " B%d", block->succ[s]);
+        }
+        fprintf(file, ", pred");
+        for (int p = 0; p < block->predCount; p++) {
+            fprintf(file, " B%d", block->preds[p]);
+        }
+        fprintf(file, "\n");
+    }
+    for (int l = 0; l < cfg->loopCount; l++) {
+        fprintf(file, "loop %d: header B%d, parent %d, depth %d, %d blocks\n", l,
+                cfg->loops[l].header, cfg->loops[l].parent, cfg->loops[l].depth, cfg->loops[l].blockCount);
+    }
+}
@@ -0,0 +1,131 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include "intermediate.h"
+
+/* 控制流图模块：把一个 FUNCTION 的中间代码划分为基本块，并计算支配树和循环嵌套 */
+
+/* 基本块，代码是中间代码链表中从 first 到 last 的连续一段 */
+typedef struct IRBlock_ {
+    InterCodes first;        // 块内第一条代码
+    InterCodes last;         // 块内最后一条代码
+    int codeCount;           // 块内代码条数
+    int succ[2];             // 后继块：succ[0] 为顺序执行或 GOTO 的目标，succ[1] 为 IFGOTO 的目标
+    int succCount;
+    int *preds;              // 前驱块，按前驱的块号排列
+    int predCount;
+    int predCapacity;
+    int rpo;                 // 逆后序编号，不可达块为-1
+    int idom;                // 直接支配者，入口块为自身，不可达块为-1
+    int domChild;            // 支配树中的第一个子结点，-1表示没有
+    int domSibling;          // 支配树中的下一个兄弟结点，-1表示没有
+    int domPre, domPost;     // 支配树先序/后序编号，用于O(1)判断支配关系
+    int loop;                // 所在最内层循环，-1表示不在循环中
+} IRBlock;
+
+/* 自然循环，多条回边指向同一个循环头时合并为一个循环 */
+typedef struct IRLoop_ {
+    int header;              // 循环头
+    int parent;              // 外层循环，-1表示最外层
+    int depth;               // 嵌套深度，最外层循环为1
+    int *blocks;             // 循环包含的基本块（含内层循环的块）
+    int blockCount;
+} IRLoop;
+
+typedef struct IRCfg_ {
+    InterCodes funcHead;     // 函数的 FUNCTION 代码
+    IRBlock *blocks;         // 按代码顺序排列，blocks[0] 为入口块
+    int blockCount;
+    int blockCapacity;
+    int *rpoOrder;           // 按逆后序排列的可达块
+    int reachableCount;
+    IRLoop *loops;           // 外层循环排在内层循环之前
+    int loopCount;
+    int loopCapacity;
+    int *loopBlockPool;      // 所有循环的块列表
+    int *labelBlock;         // 标号 var_no - labelBase 到基本块的映射
+    int labelBase;
+    int labelSpan;
+    int labelCapacity;
+    int *prevSucc;           // 上一次构建时的后继，用于判断图的形状是否改变
+    int prevBlockCount;
+    bool shapeChanged;       // 最近一次构建是否改变了块和边
+} *IRCfg;
+
+/* 依次访问基本块中的每条代码 */
+#define IR_FOR_EACH_BLOCK_CODE(block, code) \
+    for (InterCodes code = (block)->first; code; code = code == (block)->last ? NULL : code->next)
+
+/**
+ * @brief LABEL代码的标号
+ * @param code 中间代码
+ * @return 标号的 var_no，其余代码返回-1
+ */
+int ir_get_label_no(InterCodes code);
+
+/**
+ * @brief GOTO/IFGOTO代码的跳转目标
+ * @param code 中间代码
+ * @return 目标标号的 var_no，其余代码返回-1
+ */
+int ir_get_jump_target(InterCodes code);
+
+/**
+ * @brief 为函数构建控制流图
+ * @param funcHead 函数的FUNCTION代码
+ * @return 控制流图，用 ir_free_cfg 释放
+ */
+IRCfg ir_build_cfg(InterCodes funcHead);
+
+/**
+ * @brief 中间代码被修改后重新划分基本块；块和边都没有变化时保留原来的支配树和循环信息
+ * @param cfg 控制流图
+ */
+void ir_rebuild_cfg(IRCfg cfg);
+
+/**
+ * @brief 删除从入口不可达的基本块中的全部代码，并重新构建控制流图
+ * @param cfg 控制流图
+ * @return 删除的代码条数
+ */
+int ir_cfg_remove_unreachable(IRCfg cfg);
+
+/**
+ * @brief 释放控制流图
+ * @param cfg 控制流图
+ */
+void ir_free_cfg(IRCfg cfg);
+
+/**
+ * @brief 标号所在的基本块
+ * @param cfg 控制流图
+ * @param labelNo 标号的 var_no
+ * @return 基本块编号，标号不在本函数中时返回-1
+ */
+int ir_cfg_label_block(IRCfg cfg, int labelNo);
+
+/**
+ * @brief 判断基本块 a 是否支配基本块 b
+ * @param cfg 控制流图
+ * @param a 基本块编号
+ * @param b 基本块编号
+ * @return 是否支配，不可达块不被任何块支配
+ */
+bool ir_cfg_dominates(IRCfg cfg, int a, int b);
+
+/**
+ * @brief 基本块的循环嵌套深度
+ * @param cfg 控制流图
+ * @param block 基本块编号
+ * @return 不在循环中时为0
+ */
+int ir_cfg_loop_depth(IRCfg cfg, int block);
+
+/**
+ * @brief 输出控制流图，调试用
+ * @param cfg 控制流图
+ * @param file 输出文件
+ */
+void ir_print_cfg(IRCfg cfg, FILE *file);
+
+#endif
@@ -0,0 +1,452 @@
+#include "constprop.h"
+#include <limits.h>
+
+/* 格值：TOP 表示还没有算出值，BOTTOM 表示不是常量 */
+enum { IR_CONST_TOP, IR_CONST_VALUE, IR_CONST_BOTTOM };
+
+typedef struct IRConstLattice {
+    int state;
+    int value;
+} IRConstLattice;
+
+static IRValueTable values = NULL;
+static IRConstLattice *lattice = NULL;
+static bool *pinned = NULL;            // 以 *t 形式读取，不能替换为常量
+
+static bool *blockExec = NULL;
+static bool *edgeExec = NULL;          // edgeExec[b * 2 + s] 对应 blocks[b].succ[s]
+static int *edgeWork = NULL;
+static int edgeWorkCount = 0;
+static int *valueWork = NULL;
+static bool *inValueWork = NULL;
+static int valueWorkCount = 0;
+
+/* ir_const_operand 操作数的格值 */
+static IRConstLattice ir_const_operand(Operand op)
+{
+    IRConstLattice result = {IR_CONST_BOTTOM, 0};
+    if (op->kind == CONSTANT_OP) {
+        result.state = IR_CONST_VALUE;
+        result.value = op->value;
+    }
+    else if (op->type == VAL && ir_value_index(values, op) >= 0) {
+        result = lattice[ir_value_index(values, op)];
+    }
+    return result;
+}
+
+/* ir_const_meet 两个格值的交 */
+static IRConstLattice ir_const_meet(IRConstLattice a, IRConstLattice b)
+{
+    if (a.state == IR_CONST_TOP) {
+        return b;
+    }
+    if (b.state == IR_CONST_TOP) {
+        return a;
+    }
+    if (a.state == IR_CONST_VALUE && b.state == IR_CONST_VALUE && a.value == b.value) {
+        return a;
+    }
+    IRConstLattice bottom = {IR_CONST_BOTTOM, 0};
+    return bottom;
+}
+
+/* ir_const_lower 用新算出的值更新格值，下降时把值加入工作表 */
+static void ir_const_lower(Operand def, IRConstLattice value)
+{
+    int v = ir_value_index(values, def);
+    IRConstLattice old = lattice[v];
+    IRConstLattice now = ir_const_meet(old, value);
+    if (now.state == old.state && now.value == old.value) {
+        return;
+    }
+    lattice[v] = now;
+    if (!inValueWork[v]) {
+        inValueWork[v] = true;
+        valueWork[valueWorkCount++] = v;
+    }
+}
+
+/* ir_const_fold 折叠两个常量的运算，除数为0或溢出时返回 false */
+static bool ir_const_fold(int kind, int a, int b, int *result)
+{
+    switch (kind) {
+        case ADD_InterCode:
+            *result = (int)((unsigned int)a + (unsigned int)b);
+            return true;
+        case SUB_InterCode:
+            *result = (int)((unsigned int)a - (unsigned int)b);
+            return true;
+        case MUL_InterCode:
+            *result = (int)((unsigned int)a * (unsigned int)b);
+            return true;
+        case DIV_InterCode:
+            // 和 MIPS 的 div 一样向零取整
+            if (b == 0 || (a == INT_MIN && b == -1)) {
+                return false;
+            }
+            *result = a / b;
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* ir_const_compare 按 relop 比较两个常量 */
+static bool ir_const_compare(const char *relop, int a, int b)
+{
+    if (strcmp(relop, "==") == 0) {
+        return a == b;
+    }
+    if (strcmp(relop, "!=") == 0) {
+        return a != b;
+    }
+    if (strcmp(relop, "<") == 0) {
+        return a < b;
+    }
+    if (strcmp(relop, "<=") == 0) {
+        return a <= b;
+    }
+    if (strcmp(relop, ">") == 0) {
+        return a > b;
+    }
+    return a >= b;
+}
+
+/* ir_const_branch 条件跳转的结果：1 总是跳转，0 从不跳转，-1 不确定，-2 还没有算出 */
+static int ir_const_branch(InterCodes code)
+{
+    IRConstLattice x = ir_const_operand(code->code.u.ifgotoOP.op1);
+    IRConstLattice y = ir_const_operand(code->code.u.ifgotoOP.op2);
+    if (x.state == IR_CONST_BOTTOM || y.state == IR_CONST_BOTTOM) {
+        return -1;
+    }
+    if (x.state == IR_CONST_TOP || y.state == IR_CONST_TOP) {
+        return -2;
+    }
+    return ir_const_compare(code->code.u.ifgotoOP.relop, x.value, y.value) ? 1 : 0;
+}
+
+/* ir_const_jump_succ 条件跳转的目标在 succ 中的下标 */
+static int ir_const_jump_succ(IRCfg cfg, int b)
+{
+    IRBlock *block = &cfg->blocks[b];
+    int target = ir_cfg_label_block(cfg, ir_get_jump_target(block->last));
+    return block->succCount > 1 && block->succ[1] == target ? 1 : 0;
+}
+
+/* ir_const_mark_edge 标记一条边可能执行 */
+static void ir_const_mark_edge(int b, int s)
+{
+    if (!edgeExec[b * 2 + s]) {
+        edgeExec[b * 2 + s] = true;
+        edgeWork[edgeWorkCount++] = b * 2 + s;
+    }
+}
+
+/* ir_const_visit_terminator 按块的最后一条代码标记可能执行的出边 */
+static void ir_const_visit_terminator(IRCfg cfg, int b)
+{
+    IRBlock *block = &cfg->blocks[b];
+    if (block->last->code.kind != IFGOTO_InterCode || block->succCount < 2) {
+        for (int s = 0; s < block->succCount; s++) {
+            ir_const_mark_edge(b, s);
+        }
+        return;
+    }
+    int outcome = ir_const_branch(block->last);
+    int jump = ir_const_jump_succ(cfg, b);
+    if (outcome == 1 || outcome == -1) {
+        ir_const_mark_edge(b, jump);
+    }
+    if (outcome == 0 || outcome == -1) {
+        ir_const_mark_edge(b, 1 - jump);
+    }
+}
+
+/* ir_const_edge_exec 前驱 pred 到 b 的边是否可能执行 */
+static bool ir_const_edge_exec(IRCfg cfg, int pred, int b)
+{
+    IRBlock *block = &cfg->blocks[pred];
+    for (int s = 0; s < block->succCount; s++) {
+        if (block->succ[s] == b && edgeExec[pred * 2 + s]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ir_const_visit 计算一条代码定值的格值 */
+static void ir_const_visit(IRCfg cfg, int b, InterCodes code)
+{
+    if (code->code.kind == IFGOTO_InterCode && code == cfg->blocks[b].last) {
+        ir_const_visit_terminator(cfg, b);
+        return;
+    }
+    Operand def = ir_get_def_operand(code);
+    int v = ir_value_index(values, def);
+    if (v < 0 || lattice[v].state == IR_CONST_BOTTOM) {
+        return;
+    }
+
+    IRConstLattice value = {IR_CONST_BOTTOM, 0};
+    switch (code->code.kind) {
+        case ASSIGN_InterCode:
+            value = ir_const_operand(code->code.u.doubleOP.right);
+            break;
+        case ADD_InterCode:
+        case SUB_InterCode:
+        case MUL_InterCode:
+        case DIV_InterCode: {
+            IRConstLattice x = ir_const_operand(code->code.u.tripleOP.op1);
+            IRConstLattice y = ir_const_operand(code->code.u.tripleOP.op2);
+            if (code->code.kind == MUL_InterCode &&
+                ((x.state == IR_CONST_VALUE && x.value == 0) || (y.state == IR_CONST_VALUE && y.value == 0))) {
+                value.state = IR_CONST_VALUE;
+                value.value = 0;
+            }
+            else if (x.state == IR_CONST_BOTTOM || y.state == IR_CONST_BOTTOM) {
+                value.state = IR_CONST_BOTTOM;
+            }
+            else if (x.state == IR_CONST_TOP || y.state == IR_CONST_TOP) {
+                value.state = IR_CONST_TOP;
+            }
+            else if (ir_const_fold(code->code.kind, x.value, y.value, &value.value)) {
+                value.state = IR_CONST_VALUE;
+            }
+            break;
+        }
+        case PHI_InterCode: {
+            IRBlock *block = &cfg->blocks[b];
+            value.state = IR_CONST_TOP;
+            for (int i = 0; i < code->code.u.phiOP.argCount; i++) {
+                if (ir_const_edge_exec(cfg, block->preds[i], b)) {
+                    value = ir_const_meet(value, ir_const_operand(code->code.u.phiOP.args[i]));
+                }
+            }
+            break;
+        }
+        default:
+            // CALL、READ、PARAM、取地址和取内容的结果都不是常量
+            break;
+    }
+    ir_const_lower(def, value);
+}
+
+/* ir_const_init 在内存中或定值不唯一的值直接为 BOTTOM；没有定值的值在入口处未知，定值不止一次的只可能是在内存中的变量 */
+static void ir_const_init(void)
+{
+    for (int v = 0; v < values->count; v++) {
+        if (values->inMemory[v] || values->defCount[v] != 1) {
+            lattice[v].state = IR_CONST_BOTTOM;
+        }
+    }
+}
+
+/* ir_const_solve 交替处理边工作表和值工作表直到不动点 */
+static void ir_const_solve(IRCfg cfg)
+{
+    ir_const_mark_edge(cfg->blockCount, 0);
+    while (edgeWorkCount > 0 || valueWorkCount > 0) {
+        if (edgeWorkCount > 0) {
+            int edge = edgeWork[--edgeWorkCount];
+            // 入口块由一条虚拟的边进入
+            int b = edge / 2 == cfg->blockCount ? 0 : cfg->blocks[edge / 2].succ[edge % 2];
+            IRBlock *block = &cfg->blocks[b];
+            if (blockExec[b]) {
+                // 新的入边只影响φ函数
+                IR_FOR_EACH_BLOCK_CODE(block, code) {
+                    if (code->code.kind == PHI_InterCode) {
+                        ir_const_visit(cfg, b, code);
+                    }
+                }
+                continue;
+            }
+            blockExec[b] = true;
+            IR_FOR_EACH_BLOCK_CODE(block, code) {
+                ir_const_visit(cfg, b, code);
+            }
+            if (block->last->code.kind != IFGOTO_InterCode) {
+                ir_const_visit_terminator(cfg, b);
+            }
+            continue;
+        }
+
+        int v = valueWork[--valueWorkCount];
+        inValueWork[v] = false;
+        for (int i = values->useStart[v]; i < values->useStart[v + 1]; i++) {
+            IRValueUse *use = &values->uses[i];
+            if (blockExec[use->block]) {
+                ir_const_visit(cfg, use->block, use->code);
+            }
+        }
+    }
+}
+
+/* ir_const_constant 新的常量操作数 */
+static Operand ir_const_constant(int value)
+{
+    return ir_create_operand(CONSTANT_OP, VAL, value);
+}
+
+/* ir_const_rewrite 按求出的格值改写中间代码，返回改动的条数 */
+static int ir_const_rewrite(IRCfg cfg)
+{
+    int changed = 0;
+    int removeCount = 0;
+    int removeCapacity = 16;
+    InterCodes *removeList = (InterCodes *)malloc(removeCapacity * sizeof(InterCodes));
+#define IR_CONST_REMOVE_LATER(c)                                                                 \
+    do {                                                                                         \
+        if (removeCount == removeCapacity) {                                                     \
+            removeCapacity *= 2;                                                                 \
+            removeList = (InterCodes *)realloc(removeList, removeCapacity * sizeof(InterCodes)); \
+        }                                                                                        \
+        removeList[removeCount++] = (c);                                                         \
+    } while (0)
+
+    // 不可能执行的入边对应的φ参数，倒序删除使下标不变
+    for (int b = 0; b < cfg->blockCount; b++) {
+        if (!blockExec[b]) {
+            continue;
+        }
+        IRBlock *block = &cfg->blocks[b];
+        for (int i = block->predCount - 1; i >= 0; i--) {
+            if (!ir_const_edge_exec(cfg, block->preds[i], b)) {
+                ir_ssa_remove_phi_arg(cfg, b, i);
+            }
+        }
+    }
+
+    for (int b = 0; b < cfg->blockCount; b++) {
+        if (!blockExec[b]) {
+            continue;
+        }
+        IRBlock *block = &cfg->blocks[b];
+        IR_FOR_EACH_BLOCK_CODE(block, code) {
+            if (code->code.kind == IFGOTO_InterCode) {
+                int outcome = ir_const_branch(code);
+                if (outcome == 1) {
+                    Operand label = code->code.u.ifgotoOP.label;
+                    code->code.kind = GOTO_InterCode;
+                    code->code.u.singleOP.op = label;
+                    changed++;
+                    continue;
+                }
+                if (outcome == 0) {
+                    IR_CONST_REMOVE_LATER(code);
+                    changed++;
+                    continue;
+                }
+            }
+
+            if (code->code.kind == PHI_InterCode) {
+                for (int i = 0; i < code->code.u.phiOP.argCount; i++) {
+                    IRConstLattice arg = ir_const_operand(code->code.u.phiOP.args[i]);
+                    if (arg.state == IR_CONST_VALUE && code->code.u.phiOP.args[i]->kind != CONSTANT_OP) {
+                        code->code.u.phiOP.args[i] = ir_const_constant(arg.value);
+                    }
+                }
+            }
+            else {
+                Operand *slots[3];
+                int slotCount = ir_get_use_operands(code, slots);
+                for (int i = 0; i < slotCount; i++) {
+                    int v = ir_value_index(values, *slots[i]);
+                    if (lattice[v].state != IR_CONST_VALUE) {
+                        continue;
+                    }
+                    if ((*slots[i])->type == ADDRESS) {
+                        pinned[v] = true;
+                        continue;
+                    }
+                    *slots[i] = ir_const_constant(lattice[v].value);
+                    changed++;
+                }
+            }
+        }
+    }
+
+    // 结果为常量的定值：不再被读取的删除，否则改为直接赋常量
+    for (int v = 0; v < values->count; v++) {
+        InterCodes code = values->defCode[v];
+        if (lattice[v].state != IR_CONST_VALUE) {
+            continue;
+        }
+        int kind = code->code.kind;
+        if (kind != ASSIGN_InterCode && kind != PHI_InterCode && (kind < ADD_InterCode || kind > DIV_InterCode)) {
+            continue;
+        }
+        if (!pinned[v]) {
+            if (kind == PHI_InterCode) {
+                free(code->code.u.phiOP.args);
+            }
+            IR_CONST_REMOVE_LATER(code);
+            changed++;
+            continue;
+        }
+        if (kind == ASSIGN_InterCode && code->code.u.doubleOP.right->kind == CONSTANT_OP) {
+            continue;
+        }
+        Operand def = ir_get_def_operand(code);
+        if (kind == PHI_InterCode) {
+            // 赋值放在块中所有φ函数之后
+            InterCodes position = code->next;
+            while (position->code.kind == PHI_InterCode) {
+                position = position->next;
+            }
+            free(code->code.u.phiOP.args);
+            IR_CONST_REMOVE_LATER(code);
+            code = ir_insert_code_before(position, ASSIGN_InterCode);
+        }
+        code->code.kind = ASSIGN_InterCode;
+        code->code.u.doubleOP.left = def;
+        code->code.u.doubleOP.right = ir_const_constant(lattice[v].value);
+        changed++;
+    }
+#undef IR_CONST_REMOVE_LATER
+
+    for (int i = 0; i < removeCount; i++) {
+        ir_remove_code(removeList[i]);
+    }
+    free(removeList);
+    return changed;
+}
+
+bool ir_propagate_constants(IRCfg cfg)
+{
+    if (cfg->blockCount == 0) {
+        return false;
+    }
+
+    values = ir_build_value_table(cfg, true);
+    lattice = (IRConstLattice *)calloc(values->count, sizeof(IRConstLattice));
+    pinned = (bool *)calloc(values->count, sizeof(bool));
+    valueWork = (int *)malloc(values->count * sizeof(int));
+    inValueWork = (bool *)calloc(values->count, sizeof(bool));
+    valueWorkCount = 0;
+    blockExec = (bool *)calloc(cfg->blockCount, sizeof(bool));
+    edgeExec = (bool *)calloc(cfg->blockCount * 2 + 2, sizeof(bool));
+    edgeWork = (int *)malloc((cfg->blockCount * 2 + 2) * sizeof(int));
+    edgeWorkCount = 0;
+
+    ir_const_init();
+    ir_const_solve(cfg);
+    int changed = ir_const_rewrite(cfg);
+
+    ir_free_value_table(values);
+    free(lattice);
+    free(pinned);
+    free(valueWork);
+    free(inValueWork);
+    free(blockExec);
+    free(edgeExec);
+    free(edgeWork);
+    values = NULL;
+
+    // 条件跳转改写后图的形状可能变化，先重建再删除不可达块
+    ir_rebuild_cfg(cfg);
+    changed += ir_cfg_remove_unreachable(cfg);
+    IR_DEBUG(IR_DEBUG_INFO, "常量传播: 改写%d处\n", changed);
+    return changed > 0;
+}
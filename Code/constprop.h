@@ -0,0 +1,18 @@
+#ifndef CONSTPROP_H
+#define CONSTPROP_H
+
+#include "ssa.h"
+
+/* 常量传播模块：在SSA形式上做稀疏条件常量传播（SCCP） */
+
+/**
+ * @brief 稀疏条件常量传播
+ *        只沿可能执行的边传播常量，折叠结果为常量的运算和φ函数，把读取换成常量；
+ *        结果确定的条件跳转改为 GOTO 或删除，随后删除不可达的基本块。
+ *        在内存中的变量以及 CALL、READ、PARAM、取内容的结果都视为未知。
+ * @param cfg SSA形式的函数控制流图，返回时已重新构建
+ * @return 是否修改了中间代码
+ */
+bool ir_propagate_constants(IRCfg cfg);
+
+#endif
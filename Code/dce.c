@@ -0,0 +1,195 @@
+#include "dce.h"
+
+static IRValueTable values = NULL;
+static bool *deadObject = NULL;        // 只被写入的数组
+static bool *derived = NULL;           // 由某个只被写入的数组的地址算出的指针
+
+/* ir_dce_store_address 向内存存储的赋值，返回存储地址所在的位置；READ *t 总要读入，不算在内 */
+static Operand *ir_dce_store_address(InterCodes code)
+{
+    if (code->code.kind == ASSIGN_InterCode && code->code.u.doubleOP.left->kind == TEMP_OP &&
+        code->code.u.doubleOP.left->type == ADDRESS) {
+        return &code->code.u.doubleOP.left;
+    }
+    if (code->code.kind == TO_ADDR_InterCode) {
+        return &code->code.u.doubleOP.left;
+    }
+    return NULL;
+}
+
+/* ir_dce_find_dead_objects 找出只被写入的数组：地址只经过加减、复制和φ函数得到新的指针，
+ * 这些指针只用作存储的地址；被读取、作为参数传出或存入内存的都算逃逸 */
+static void ir_dce_find_dead_objects(IRCfg cfg)
+{
+    int *found = (int *)malloc(values->count * sizeof(int));
+    bool *visited = (bool *)calloc(values->count, sizeof(bool));
+    for (int b = 0; b < cfg->blockCount; b++) {
+        IR_FOR_EACH_BLOCK_CODE(&cfg->blocks[b], dec) {
+            if (dec->code.kind != DEC_InterCode) {
+                continue;
+            }
+            // found 中是由数组地址得到的所有值，也是待处理的工作表
+            int object = ir_value_index(values, dec->code.u.doubleOP.left);
+            int foundCount = 0;
+            found[foundCount++] = object;
+            visited[object] = true;
+            bool escapes = false;
+            for (int next = 0; next < foundCount && !escapes; next++) {
+                int v = found[next];
+                for (int i = values->useStart[v]; i < values->useStart[v + 1]; i++) {
+                    InterCodes code = values->uses[i].code;
+                    Operand *slot = values->uses[i].slot;
+                    if (code->code.kind == DEC_InterCode || slot == ir_dce_store_address(code)) {
+                        continue;
+                    }
+                    // 对象本身只能以 &v 的形式出现，指针只能以值的形式出现
+                    bool asAddress = v == object ? (*slot)->type == ADDRESS : (*slot)->type == VAL;
+                    Operand def = ir_get_def_operand(code);
+                    int d = ir_value_index(values, def);
+                    bool derives = asAddress && d >= 0 && !values->inMemory[d] && values->defCount[d] == 1 &&
+                                   (code->code.kind == ADD_InterCode ||
+                                    (code->code.kind == SUB_InterCode && slot == &code->code.u.tripleOP.op1) ||
+                                    code->code.kind == ASSIGN_InterCode || code->code.kind == PHI_InterCode);
+                    if (!derives) {
+                        escapes = true;
+                        break;
+                    }
+                    if (!visited[d]) {
+                        visited[d] = true;
+                        found[foundCount++] = d;
+                    }
+                }
+            }
+            // φ函数的参数必须都来自这个数组，否则指针可能指向别处
+            for (int i = 1; i < foundCount && !escapes; i++) {
+                InterCodes code = values->defCode[found[i]];
+                if (code->code.kind != PHI_InterCode) {
+                    continue;
+                }
+                for (int j = 0; j < code->code.u.phiOP.argCount; j++) {
+                    int a = ir_value_index(values, code->code.u.phiOP.args[j]);
+                    if (a < 0 || !visited[a]) {
+                        escapes = true;
+                        break;
+                    }
+                }
+            }
+            for (int i = 0; i < foundCount; i++) {
+                visited[found[i]] = false;
+                if (!escapes && i > 0) {
+                    derived[found[i]] = true;
+                }
+            }
+            deadObject[object] = !escapes;
+        }
+    }
+    free(found);
+    free(visited);
+}
+
+/* ir_dce_is_critical 有副作用、必须保留的代码 */
+static bool ir_dce_is_critical(InterCodes code)
+{
+    switch (code->code.kind) {
+        case ASSIGN_InterCode:
+        case TO_ADDR_InterCode: {
+            Operand *address = ir_dce_store_address(code);
+            if (address) {
+                int v = ir_value_index(values, *address);
+                return v < 0 || !derived[v];
+            }
+            break;
+        }
+        case DEC_InterCode:
+            return !deadObject[ir_value_index(values, code->code.u.doubleOP.left)];
+        case LABEL_InterCode:
+        case FUNC_InterCode:
+        case GOTO_InterCode:
+        case IFGOTO_InterCode:
+        case RETURN_InterCode:
+        case ARG_InterCode:
+        case CALL_InterCode:
+        case PARAM_InterCode:
+        case READ_InterCode:
+        case WRITE_InterCode:
+            return true;
+        default:
+            break;
+    }
+    // 不是SSA值的变量（在内存中或多次定值）的赋值都保留
+    int v = ir_value_index(values, ir_get_def_operand(code));
+    return v >= 0 && (values->inMemory[v] || values->defCount[v] != 1);
+}
+
+int ir_eliminate_dead_code(IRCfg cfg)
+{
+    int removed = ir_cfg_remove_unreachable(cfg);
+    if (cfg->blockCount == 0) {
+        return removed;
+    }
+
+    values = ir_build_value_table(cfg, true);
+    deadObject = (bool *)calloc(values->count, sizeof(bool));
+    derived = (bool *)calloc(values->count, sizeof(bool));
+    ir_dce_find_dead_objects(cfg);
+
+    // 标记：活跃代码读取的值，其定值代码也活跃
+    InterCodes *worklist = (InterCodes *)malloc((values->codeCount + 1) * sizeof(InterCodes));
+    bool *live = (bool *)calloc(values->count, sizeof(bool));  // 定值代码已被标记的值
+    int count = 0;
+    for (int b = 0; b < cfg->blockCount; b++) {
+        IR_FOR_EACH_BLOCK_CODE(&cfg->blocks[b], code) {
+            if (ir_dce_is_critical(code)) {
+                worklist[count++] = code;
+                int v = ir_value_index(values, ir_get_def_operand(code));
+                if (v >= 0 && values->defCount[v] == 1) {
+                    live[v] = true;
+                }
+            }
+        }
+    }
+    while (count > 0) {
+        InterCodes code = worklist[--count];
+        Operand *slots[3];
+        int slotCount = ir_get_use_operands(code, slots);
+        int argCount = code->code.kind == PHI_InterCode ? code->code.u.phiOP.argCount : 0;
+        for (int i = 0; i < slotCount + argCount; i++) {
+            Operand op = i < slotCount ? *slots[i] : code->code.u.phiOP.args[i - slotCount];
+            int v = ir_value_index(values, op);
+            if (v >= 0 && values->defCount[v] == 1 && !live[v]) {
+                live[v] = true;
+                worklist[count++] = values->defCode[v];
+            }
+        }
+    }
+
+    // 删除：既不关键、定值也没有被用到的代码
+    for (int b = 0; b < cfg->blockCount; b++) {
+        IRBlock *block = &cfg->blocks[b];
+        InterCodes stop = block->last->next;
+        for (InterCodes code = block->first; code != stop;) {
+            InterCodes next = code->next;
+            int v = ir_value_index(values, ir_get_def_operand(code));
+            bool dead = !ir_dce_is_critical(code) && !(v >= 0 && live[v]);
+            if (dead) {
+                if (code->code.kind == PHI_InterCode) {
+                    free(code->code.u.phiOP.args);
+                }
+                ir_remove_code(code);
+                removed++;
+            }
+            code = next;
+        }
+    }
+    IR_DEBUG(IR_DEBUG_INFO, "死代码删除: 删除%d条代码\n", removed);
+
+    free(worklist);
+    free(live);
+    ir_free_value_table(values);
+    free(deadObject);
+    free(derived);
+    values = NULL;
+
+    ir_rebuild_cfg(cfg);
+    return removed;
+}
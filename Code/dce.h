@@ -0,0 +1,18 @@
+#ifndef DCE_H
+#define DCE_H
+
+#include "ssa.h"
+
+/* 死代码删除模块：在SSA形式上删除结果不会被用到的代码 */
+
+/**
+ * @brief 死代码和死存储删除
+ *        从有副作用的代码（跳转、返回、调用、读写、向内存存储）出发，沿定值-使用关系标记活跃的代码，
+ *        其余代码全部删除；只被写入、从未被读取且地址没有逃逸的数组连同它的 DEC 一起删除。
+ *        在内存中的变量的赋值总是保留。
+ * @param cfg SSA形式的函数控制流图，返回时已重新构建
+ * @return 删除的代码条数
+ */
+int ir_eliminate_dead_code(IRCfg cfg);
+
+#endif
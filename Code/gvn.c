@@ -0,0 +1,418 @@
+#include "gvn.h"
+
+/* 表达式的种类：运算直接使用中间代码的种类，另外还有读取内存和取地址 */
+enum { IR_GVN_LOAD = -1, IR_GVN_ADDR = -2 };
+
+/* 操作数在表达式中的编码 */
+enum { IR_GVN_CONST, IR_GVN_VALUE, IR_GVN_VAR_ADDR, IR_GVN_DEREF };
+
+typedef struct IRGvnEntry {
+    bool used;
+    int kind;
+    int tag1, id1, tag2, id2;
+    int gen;                 // 依赖内存的表达式所在的内存版本，其余为0
+    Operand rep;             // 最先算出这个表达式的值或常量
+} IRGvnEntry;
+
+static IRValueTable values = NULL;
+static Operand *leader = NULL;         // 值编号相同的值中最先定值的一个，NULL表示自身
+
+static IRGvnEntry *table = NULL;
+static int tableMask = 0;
+static int *undoLog = NULL;            // 插入的表项，离开块时倒序删除
+static int undoCount = 0;
+static int genCounter = 0;
+
+/* ir_gvn_is_ssa_index 只定值一次、不在内存中的值 */
+static bool ir_gvn_is_ssa_index(int v)
+{
+    return v >= 0 && !values->inMemory[v] && values->defCount[v] == 1;
+}
+
+/* ir_gvn_leader 读取值 op 时实际使用的操作数 */
+static Operand ir_gvn_leader(Operand op)
+{
+    int v = ir_value_index(values, op);
+    if (op->type == VAL && ir_gvn_is_ssa_index(v) && leader[v]) {
+        return leader[v];
+    }
+    return op;
+}
+
+/* ir_gvn_encode 把操作数编码为表达式的一部分，读取内存的操作数置 memory；不能编码时返回 false */
+static bool ir_gvn_encode(Operand op, int *tag, int *id, bool *memory)
+{
+    op = ir_gvn_leader(op);
+    if (op->kind == CONSTANT_OP) {
+        *tag = IR_GVN_CONST;
+        *id = op->value;
+        return true;
+    }
+    int v = ir_value_index(values, op);
+    if (v < 0) {
+        return false;
+    }
+    if (op->type == VAL) {
+        // 在内存中或多次定值的变量，读到的值随内存版本变化
+        *memory = *memory || !ir_gvn_is_ssa_index(v);
+        *tag = IR_GVN_VALUE;
+        *id = v;
+        return true;
+    }
+    if (op->kind == VARIABLE_OP) {
+        *tag = IR_GVN_VAR_ADDR;
+        *id = v;
+        return true;
+    }
+    // *t 按指针 t 的值编号
+    Operand pointer = ir_gvn_is_ssa_index(v) && leader[v] ? leader[v] : op;
+    if (pointer->kind != TEMP_OP) {
+        return false;
+    }
+    *tag = IR_GVN_DEREF;
+    *id = ir_value_index(values, pointer);
+    *memory = true;
+    return true;
+}
+
+/* ir_gvn_find 查找表达式，返回表项下标；不存在时返回应插入的空位取反 */
+static int ir_gvn_find(IRGvnEntry *key)
+{
+    unsigned int h = (unsigned int)key->kind * 31u;
+    h = (h ^ (unsigned int)key->tag1) * 16777619u ^ (unsigned int)key->id1;
+    h = (h * 16777619u ^ (unsigned int)key->tag2) * 16777619u ^ (unsigned int)key->id2;
+    h = (h * 16777619u) ^ (unsigned int)key->gen;
+    h ^= h >> 15;
+    for (int i = (int)(h & (unsigned int)tableMask);; i = (i + 1) & tableMask) {
+        IRGvnEntry *e = &table[i];
+        if (!e->used) {
+            return ~i;
+        }
+        if (e->kind == key->kind && e->tag1 == key->tag1 && e->id1 == key->id1 && e->tag2 == key->tag2 &&
+            e->id2 == key->id2 && e->gen == key->gen) {
+            return i;
+        }
+    }
+}
+
+/* ir_gvn_lookup 查找表达式的代表，没有时登记 rep（rep 为 NULL 时只查找） */
+static Operand ir_gvn_lookup(IRGvnEntry *key, Operand rep)
+{
+    int slot = ir_gvn_find(key);
+    if (slot >= 0) {
+        return table[slot].rep;
+    }
+    if (rep) {
+        slot = ~slot;
+        table[slot] = *key;
+        table[slot].used = true;
+        table[slot].rep = rep;
+        undoLog[undoCount++] = slot;
+    }
+    return NULL;
+}
+
+/* ir_gvn_store_slot 向内存存储的代码中存储地址所在的位置 */
+static Operand *ir_gvn_store_slot(InterCodes code)
+{
+    if (code->code.kind == ASSIGN_InterCode && code->code.u.doubleOP.left->kind == TEMP_OP &&
+        code->code.u.doubleOP.left->type == ADDRESS) {
+        return &code->code.u.doubleOP.left;
+    }
+    if (code->code.kind == READ_InterCode && code->code.u.singleOP.op->kind == TEMP_OP &&
+        code->code.u.singleOP.op->type == ADDRESS) {
+        return &code->code.u.singleOP.op;
+    }
+    return NULL;
+}
+
+/* ir_gvn_load_key 读取 *t 或在内存中的变量 v 的表达式 */
+static bool ir_gvn_load_key(Operand op, IRGvnEntry *key)
+{
+    memset(key, 0, sizeof(IRGvnEntry));
+    bool memory = false;
+    key->kind = IR_GVN_LOAD;
+    key->gen = genCounter;
+    return ir_gvn_encode(op, &key->tag1, &key->id1, &memory) && memory;
+}
+
+/* ir_gvn_reuse_loads 块内已经读过或刚存入的内存直接使用寄存器中的值 */
+static void ir_gvn_reuse_loads(InterCodes code)
+{
+    Operand *slots[3];
+    int slotCount = ir_get_use_operands(code, slots);
+    Operand *store = ir_gvn_store_slot(code);
+    for (int i = 0; i < slotCount; i++) {
+        if (slots[i] == store || (*slots[i])->kind != TEMP_OP || (*slots[i])->type != ADDRESS) {
+            continue;
+        }
+        IRGvnEntry key;
+        if (!ir_gvn_load_key(*slots[i], &key)) {
+            continue;
+        }
+        Operand rep = ir_gvn_lookup(&key, NULL);
+        if (rep) {
+            *slots[i] = rep;
+        }
+    }
+}
+
+/* ir_gvn_expression 定值代码的表达式，不能编号时返回 false */
+static bool ir_gvn_expression(InterCodes code, IRGvnEntry *key)
+{
+    memset(key, 0, sizeof(IRGvnEntry));
+    bool memory = false;
+    switch (code->code.kind) {
+        case ADD_InterCode:
+        case SUB_InterCode:
+        case MUL_InterCode:
+        case DIV_InterCode:
+            key->kind = code->code.kind;
+            if (!ir_gvn_encode(code->code.u.tripleOP.op1, &key->tag1, &key->id1, &memory) ||
+                !ir_gvn_encode(code->code.u.tripleOP.op2, &key->tag2, &key->id2, &memory)) {
+                return false;
+            }
+            // 加法和乘法交换操作数后是同一个表达式
+            if ((key->kind == ADD_InterCode || key->kind == MUL_InterCode) &&
+                (key->tag1 > key->tag2 || (key->tag1 == key->tag2 && key->id1 > key->id2))) {
+                int tag = key->tag1, id = key->id1;
+                key->tag1 = key->tag2;
+                key->id1 = key->id2;
+                key->tag2 = tag;
+                key->id2 = id;
+            }
+            break;
+        case ASSIGN_InterCode:
+        case GET_ADDR_InterCode: {
+            Operand right = code->code.u.doubleOP.right;
+            key->kind = right->type == ADDRESS && right->kind == VARIABLE_OP ? IR_GVN_ADDR : IR_GVN_LOAD;
+            if (code->code.kind == GET_ADDR_InterCode) {
+                key->kind = IR_GVN_ADDR;
+            }
+            if (!ir_gvn_encode(right, &key->tag1, &key->id1, &memory)) {
+                return false;
+            }
+            if (key->kind == IR_GVN_ADDR) {
+                key->tag1 = IR_GVN_VAR_ADDR;
+            }
+            // 读取不可变的值就是复制，不需要查表
+            else if (!memory) {
+                return false;
+            }
+            break;
+        }
+        default:
+            return false;
+    }
+    key->gen = memory ? genCounter : 0;
+    return true;
+}
+
+/* ir_gvn_is_constant 操作数是否为常量 c */
+static bool ir_gvn_is_constant(Operand op, int c)
+{
+    op = ir_gvn_leader(op);
+    return op->kind == CONSTANT_OP && op->value == c;
+}
+
+/* ir_gvn_simplify x + 0、x - 0、x * 1、x / 1 改为复制 */
+static void ir_gvn_simplify(InterCodes code)
+{
+    int kind = code->code.kind;
+    if (kind < ADD_InterCode || kind > DIV_InterCode) {
+        return;
+    }
+    Operand result = code->code.u.tripleOP.result;
+    Operand op1 = code->code.u.tripleOP.op1;
+    Operand op2 = code->code.u.tripleOP.op2;
+    Operand source = NULL;
+    int identity = kind == ADD_InterCode || kind == SUB_InterCode ? 0 : 1;
+    if (ir_gvn_is_constant(op2, identity)) {
+        source = op1;
+    }
+    else if ((kind == ADD_InterCode || kind == MUL_InterCode) && ir_gvn_is_constant(op1, identity)) {
+        source = op2;
+    }
+    if (source) {
+        code->code.kind = ASSIGN_InterCode;
+        code->code.u.doubleOP.left = result;
+        code->code.u.doubleOP.right = source;
+    }
+}
+
+/* ir_gvn_changes_memory 代码执行后内存中的值可能改变 */
+static bool ir_gvn_changes_memory(InterCodes code)
+{
+    if (ir_gvn_store_slot(code) || code->code.kind == TO_ADDR_InterCode || code->code.kind == CALL_InterCode) {
+        return true;
+    }
+    Operand def = ir_get_def_operand(code);
+    return def && !ir_gvn_is_ssa_index(ir_value_index(values, def));
+}
+
+/* ir_gvn_visit 为一条代码编号，重复的计算改为复制，返回是否复用了已有的值 */
+static bool ir_gvn_visit(InterCodes code)
+{
+    if (code->code.kind == PHI_InterCode) {
+        // 参数（除自身外）都是同一个值时φ函数就是这个值
+        Operand result = code->code.u.phiOP.result;
+        Operand same = NULL;
+        for (int i = 0; i < code->code.u.phiOP.argCount; i++) {
+            Operand arg = ir_gvn_leader(code->code.u.phiOP.args[i]);
+            if (ir_value_index(values, arg) == ir_value_index(values, result) && arg->kind == result->kind) {
+                continue;
+            }
+            bool equal = same && arg->kind == same->kind &&
+                         (arg->kind == CONSTANT_OP ? arg->value == same->value : arg->var_no == same->var_no);
+            if (same && !equal) {
+                return false;
+            }
+            same = arg;
+        }
+        if (same && (same->kind == CONSTANT_OP || ir_gvn_is_ssa_index(ir_value_index(values, same)))) {
+            leader[ir_value_index(values, result)] = same;
+        }
+        return false;
+    }
+
+    ir_gvn_reuse_loads(code);
+    ir_gvn_simplify(code);
+
+    bool reused = false;
+    Operand def = ir_get_def_operand(code);
+    int d = ir_value_index(values, def);
+    bool ssaDef = def && def->type == VAL && ir_gvn_is_ssa_index(d);
+    IRGvnEntry key;
+    if (def && def->type == VAL && ir_gvn_expression(code, &key)) {
+        Operand rep = ir_gvn_lookup(&key, ssaDef ? def : NULL);
+        if (rep) {
+            code->code.kind = ASSIGN_InterCode;
+            code->code.u.doubleOP.left = def;
+            code->code.u.doubleOP.right = rep;
+            reused = true;
+        }
+    }
+    // 复制（包括改写出的复制）的目标和来源是同一个值
+    if (ssaDef && code->code.kind == ASSIGN_InterCode) {
+        Operand right = ir_gvn_leader(code->code.u.doubleOP.right);
+        if (right->kind == CONSTANT_OP || (right->type == VAL && ir_gvn_is_ssa_index(ir_value_index(values, right)))) {
+            leader[d] = right;
+        }
+    }
+
+    if (ir_gvn_changes_memory(code)) {
+        genCounter++;
+        // 存入的值可以直接被随后的读取使用
+        Operand *store = ir_gvn_store_slot(code);
+        Operand value = NULL;
+        Operand place = NULL;
+        if (store && code->code.kind == ASSIGN_InterCode) {
+            place = *store;
+            value = code->code.u.doubleOP.right;
+        }
+        else if (def && def->type == VAL && code->code.kind == ASSIGN_InterCode) {
+            place = def;
+            value = code->code.u.doubleOP.right;
+        }
+        if (place) {
+            value = ir_gvn_leader(value);
+            bool stable = value->kind == CONSTANT_OP ||
+                          (value->type == VAL && ir_gvn_is_ssa_index(ir_value_index(values, value)));
+            if (stable && ir_gvn_load_key(place, &key)) {
+                ir_gvn_lookup(&key, value);
+            }
+        }
+    }
+    return reused;
+}
+
+/* ir_gvn_replace_uses 把每个值的读取换成它的代表 */
+static void ir_gvn_replace_uses(IRCfg cfg)
+{
+    for (int b = 0; b < cfg->blockCount; b++) {
+        IR_FOR_EACH_BLOCK_CODE(&cfg->blocks[b], code) {
+            if (code->code.kind == PHI_InterCode) {
+                for (int i = 0; i < code->code.u.phiOP.argCount; i++) {
+                    code->code.u.phiOP.args[i] = ir_gvn_leader(code->code.u.phiOP.args[i]);
+                }
+                continue;
+            }
+            Operand *slots[3];
+            int slotCount = ir_get_use_operands(code, slots);
+            for (int i = 0; i < slotCount; i++) {
+                Operand op = *slots[i];
+                int v = ir_value_index(values, op);
+                if (!ir_gvn_is_ssa_index(v) || !leader[v]) {
+                    continue;
+                }
+                if (op->type == VAL) {
+                    *slots[i] = leader[v];
+                }
+                else if (leader[v]->kind == TEMP_OP) {
+                    // *t 换成 *t'，保持指针解引用的形式
+                    Operand deref = ir_duplicate_operand(leader[v]);
+                    deref->type = ADDRESS;
+                    *slots[i] = deref;
+                }
+            }
+        }
+    }
+}
+
+int ir_number_values(IRCfg cfg)
+{
+    if (cfg->blockCount == 0) {
+        return 0;
+    }
+    values = ir_build_value_table(cfg, false);
+    leader = (Operand *)calloc(values->count, sizeof(Operand));
+    int codeCount = values->codeCount;
+
+    int capacity = 64;
+    while (capacity < codeCount * 4) {
+        capacity *= 2;
+    }
+    table = (IRGvnEntry *)calloc(capacity, sizeof(IRGvnEntry));
+    tableMask = capacity - 1;
+    undoLog = (int *)malloc((codeCount * 2 + 1) * sizeof(int));
+    undoCount = 0;
+
+    // 沿支配树先序遍历，离开子树时删除其中登记的表达式
+    int reused = 0;
+    int *undoMark = (int *)malloc(cfg->blockCount * sizeof(int));
+    int *stack = (int *)malloc((cfg->blockCount * 2 + 1) * sizeof(int));
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        int item = stack[--top];
+        if (item < 0) {
+            while (undoCount > undoMark[~item]) {
+                table[undoLog[--undoCount]].used = false;
+            }
+            continue;
+        }
+        IRBlock *block = &cfg->blocks[item];
+        undoMark[item] = undoCount;
+        stack[top++] = ~item;
+        // 从其他前驱进入时内存可能已被改写
+        genCounter++;
+        IR_FOR_EACH_BLOCK_CODE(block, code) {
+            reused += ir_gvn_visit(code);
+        }
+        for (int child = block->domChild; child >= 0; child = cfg->blocks[child].domSibling) {
+            stack[top++] = child;
+        }
+    }
+    ir_gvn_replace_uses(cfg);
+    IR_DEBUG(IR_DEBUG_INFO, "值编号: 复用%d处计算\n", reused);
+
+    free(stack);
+    free(undoMark);
+    free(table);
+    free(undoLog);
+    ir_free_value_table(values);
+    free(leader);
+    table = NULL;
+    values = NULL;
+    return reused;
+}
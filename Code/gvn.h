@@ -0,0 +1,18 @@
+#ifndef GVN_H
+#define GVN_H
+
+#include "ssa.h"
+
+/* 值编号模块：在SSA形式上沿支配树做全局值编号，复用重复的计算 */
+
+/**
+ * @brief 基于支配树的值编号
+ *        加减乘除和取地址按运算和操作数的值编号查表，支配它的块中已经算过的直接复用；
+ *        读取内存只在同一基本块内、两次之间没有存储和调用时复用，存储后紧接的读取直接使用存入的值。
+ *        重复的计算和 x + 0、x * 1 一类的运算改为复制，读取处换成最先算出的值，不再使用的复制留给死代码删除。
+ * @param cfg SSA形式的函数控制流图
+ * @return 被复用的计算条数
+ */
+int ir_number_values(IRCfg cfg);
+
+#endif
@@ -0,0 +1,275 @@
+#include "inliner.h"
+
+/* 程序中的一个函数 */
+typedef struct IRInlineFunc {
+    InterCodes head;         // FUNCTION 代码
+    char *name;
+    int paramCount;
+    int size;                // 不计 FUNCTION、PARAM 和标号的代码条数
+    int callCount;           // 程序中调用它的次数
+    bool leaf;               // 可以被内联：不含 CALL、DEC 和取地址
+} IRInlineFunc;
+
+static IRInlineFunc *funcs = NULL;
+static int funcCount = 0;
+static int funcCapacity = 0;
+
+/* 复制函数代码时变量、临时变量和标号到新编号的映射，按原来的 var_no 索引 */
+static Operand *varMap = NULL;
+static Operand *tempMap = NULL;
+static Operand *labelMap = NULL;
+
+/* ir_inline_is_end 是否已走出函数：到达下一个FUNCTION或链表头 */
+static bool ir_inline_is_end(InterCodes code)
+{
+    return code == interCodeListHead || code->code.kind == FUNC_InterCode;
+}
+
+/* ir_inline_body 函数中 PARAM 之后的第一条代码 */
+static InterCodes ir_inline_body(InterCodes head)
+{
+    InterCodes code = head->next;
+    while (!ir_inline_is_end(code) && code->code.kind == PARAM_InterCode) {
+        code = code->next;
+    }
+    return code;
+}
+
+/* ir_inline_find 按函数名查找函数 */
+static IRInlineFunc *ir_inline_find(const char *name)
+{
+    for (int i = 0; i < funcCount; i++) {
+        if (name && funcs[i].name && strcmp(funcs[i].name, name) == 0) {
+            return &funcs[i];
+        }
+    }
+    return NULL;
+}
+
+/* ir_inline_scan 收集所有函数的大小、参数个数、调用次数以及能否被内联 */
+static void ir_inline_scan(void)
+{
+    funcCount = 0;
+    for (InterCodes cur = interCodeListHead->next; cur != interCodeListHead; cur = cur->next) {
+        if (cur->code.kind != FUNC_InterCode) {
+            continue;
+        }
+        if (funcCount == funcCapacity) {
+            funcCapacity = funcCapacity ? funcCapacity * 2 : 16;
+            funcs = (IRInlineFunc *)realloc(funcs, funcCapacity * sizeof(IRInlineFunc));
+        }
+        IRInlineFunc *func = &funcs[funcCount++];
+        func->head = cur;
+        func->name = cur->code.u.singleOP.op->funcName;
+        func->paramCount = 0;
+        func->size = 0;
+        func->callCount = 0;
+        func->leaf = func->name && strcmp(func->name, "main") != 0;
+        for (InterCodes code = cur->next; !ir_inline_is_end(code); code = code->next) {
+            switch (code->code.kind) {
+                case PARAM_InterCode:
+                    func->paramCount++;
+                    continue;
+                case LABEL_InterCode:
+                    continue;
+                case CALL_InterCode:
+                case ARG_InterCode:
+                case DEC_InterCode:
+                case GET_ADDR_InterCode:
+                    func->leaf = false;
+                    break;
+                default:
+                    break;
+            }
+            func->size++;
+            // 数组和结构体不能换成临时变量
+            Operand *uses[3];
+            int useCount = ir_get_use_operands(code, uses);
+            for (int i = 0; i < useCount; i++) {
+                if ((*uses[i])->kind == VARIABLE_OP && (*uses[i])->type == ADDRESS) {
+                    func->leaf = false;
+                }
+            }
+            Operand def = ir_get_def_operand(code);
+            if (def && def->kind == VARIABLE_OP && def->type == ADDRESS) {
+                func->leaf = false;
+            }
+        }
+    }
+
+    for (InterCodes cur = interCodeListHead->next; cur != interCodeListHead; cur = cur->next) {
+        if (cur->code.kind == CALL_InterCode) {
+            IRInlineFunc *callee = ir_inline_find(cur->code.u.doubleOP.right->funcName);
+            if (callee) {
+                callee->callCount++;
+            }
+        }
+    }
+}
+
+/* ir_inline_worth 调用处是否值得内联：小函数总是内联，只调用一次的函数放宽大小限制 */
+static bool ir_inline_worth(IRInlineFunc *callee)
+{
+    return callee->leaf && (callee->size <= IR_MAX_INLINE_CODES ||
+                            (callee->callCount == 1 && callee->size <= IR_MAX_INLINE_SINGLE_CALL_CODES));
+}
+
+/* ir_inline_rename 把复制出的操作数换成本次内联的新编号 */
+static void ir_inline_rename(Operand op)
+{
+    if (!op) {
+        return;
+    }
+    Operand *map = op->kind == VARIABLE_OP ? varMap : op->kind == TEMP_OP ? tempMap :
+                   op->kind == LABEL_OP ? labelMap : NULL;
+    if (!map) {
+        return;
+    }
+    if (!map[op->var_no]) {
+        map[op->var_no] = op->kind == LABEL_OP ? ir_new_label() : ir_new_temp();
+    }
+    op->kind = map[op->var_no]->kind;
+    op->var_no = map[op->var_no]->var_no;
+}
+
+/* ir_inline_rename_code 换掉一条复制出的代码中的全部操作数 */
+static void ir_inline_rename_code(InterCodes code)
+{
+    switch (code->code.kind) {
+        case ASSIGN_InterCode:
+        case GET_CONTENT_InterCode:
+        case TO_ADDR_InterCode:
+            ir_inline_rename(code->code.u.doubleOP.left);
+            ir_inline_rename(code->code.u.doubleOP.right);
+            break;
+        case ADD_InterCode:
+        case SUB_InterCode:
+        case MUL_InterCode:
+        case DIV_InterCode:
+            ir_inline_rename(code->code.u.tripleOP.result);
+            ir_inline_rename(code->code.u.tripleOP.op1);
+            ir_inline_rename(code->code.u.tripleOP.op2);
+            break;
+        case IFGOTO_InterCode:
+            ir_inline_rename(code->code.u.ifgotoOP.op1);
+            ir_inline_rename(code->code.u.ifgotoOP.op2);
+            ir_inline_rename(code->code.u.ifgotoOP.label);
+            break;
+        default:
+            ir_inline_rename(code->code.u.singleOP.op);
+            break;
+    }
+}
+
+/* ir_inline_call 把一处调用替换为被调函数代码的副本 */
+static bool ir_inline_call(InterCodes call, IRInlineFunc *callee)
+{
+    // 实参按倒序紧挨在 CALL 之前：最后一条 ARG 对应第一个 PARAM
+    InterCodes arg = call;
+    for (int i = 0; i < callee->paramCount; i++) {
+        arg = arg->prev;
+        if (arg->code.kind != ARG_InterCode) {
+            return false;
+        }
+    }
+
+    varMap = (Operand *)calloc(varNo, sizeof(Operand));
+    tempMap = (Operand *)calloc(tempNo, sizeof(Operand));
+    labelMap = (Operand *)calloc(labelNo, sizeof(Operand));
+
+    arg = call->prev;
+    for (InterCodes param = callee->head->next; param->code.kind == PARAM_InterCode; param = param->next) {
+        Operand formal = ir_duplicate_operand(param->code.u.singleOP.op);
+        formal->type = VAL;
+        ir_inline_rename(formal);
+        InterCodes assign = ir_insert_code_before(call, ASSIGN_InterCode);
+        assign->code.u.doubleOP.left = formal;
+        assign->code.u.doubleOP.right = arg->code.u.singleOP.op;
+        InterCodes prev = arg->prev;
+        ir_remove_code(arg);
+        arg = prev;
+    }
+
+    Operand result = call->code.u.doubleOP.left;
+    Operand returnLabel = NULL;
+    for (InterCodes code = ir_inline_body(callee->head); !ir_inline_is_end(code); code = code->next) {
+        if (code->code.kind != RETURN_InterCode) {
+            ir_inline_rename_code(ir_copy_code_before(code, call));
+            continue;
+        }
+        // RETURN x 改为 result := x，不是最后一条代码时再跳到调用之后
+        InterCodes assign = ir_insert_code_before(call, ASSIGN_InterCode);
+        assign->code.u.doubleOP.left = ir_duplicate_operand(result);
+        assign->code.u.doubleOP.right = ir_duplicate_operand(code->code.u.singleOP.op);
+        ir_inline_rename(assign->code.u.doubleOP.right);
+        if (!ir_inline_is_end(code->next)) {
+            if (!returnLabel) {
+                returnLabel = ir_new_label();
+            }
+            InterCodes jump = ir_insert_code_before(call, GOTO_InterCode);
+            jump->code.u.singleOP.op = returnLabel;
+        }
+    }
+    if (returnLabel) {
+        InterCodes label = ir_insert_code_before(call, LABEL_InterCode);
+        label->code.u.singleOP.op = returnLabel;
+    }
+    ir_remove_code(call);
+
+    free(varMap);
+    free(tempMap);
+    free(labelMap);
+    varMap = tempMap = labelMap = NULL;
+    return true;
+}
+
+/* ir_inline_remove_function 删除一个函数的全部代码 */
+static void ir_inline_remove_function(InterCodes head)
+{
+    InterCodes code = head->next;
+    while (!ir_inline_is_end(code)) {
+        InterCodes next = code->next;
+        ir_remove_code(code);
+        code = next;
+    }
+    ir_remove_code(head);
+}
+
+int ir_inline_functions(void)
+{
+    int inlined = 0;
+    bool changed = true;
+    // 每次内联都少一条 CALL，且被内联的函数不含 CALL，循环必然结束
+    while (changed) {
+        changed = false;
+        ir_inline_scan();
+        for (int f = 0; f < funcCount; f++) {
+            for (InterCodes code = funcs[f].head->next; !ir_inline_is_end(code);) {
+                InterCodes next = code->next;
+                if (code->code.kind == CALL_InterCode) {
+                    IRInlineFunc *callee = ir_inline_find(code->code.u.doubleOP.right->funcName);
+                    if (callee && callee != &funcs[f] && ir_inline_worth(callee) && ir_inline_call(code, callee)) {
+                        callee->callCount--;
+                        inlined++;
+                        changed = true;
+                    }
+                }
+                code = next;
+            }
+        }
+    }
+
+    // 不再被调用的函数直接删除
+    ir_inline_scan();
+    for (int f = 0; f < funcCount; f++) {
+        if (inlined > 0 && funcs[f].callCount == 0 && funcs[f].name && strcmp(funcs[f].name, "main") != 0) {
+            ir_inline_remove_function(funcs[f].head);
+        }
+    }
+    IR_DEBUG(IR_DEBUG_INFO, "函数内联: 内联%d处调用\n", inlined);
+
+    free(funcs);
+    funcs = NULL;
+    funcCount = funcCapacity = 0;
+    return inlined;
+}
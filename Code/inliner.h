@@ -0,0 +1,24 @@
+#ifndef INLINER_H
+#define INLINER_H
+
+#include "optimize.h"
+
+/* 函数内联模块：把小的叶子函数的代码复制到调用处，省去传参、保存现场和返回的开销 */
+
+/* 被内联的函数最多包含的代码条数（不计 FUNCTION、PARAM 和标号） */
+#define IR_MAX_INLINE_CODES 16
+
+/* 只有一处调用的函数放宽到的代码条数，内联后原函数被删除，代码不会变多 */
+#define IR_MAX_INLINE_SINGLE_CALL_CODES 64
+
+/**
+ * @brief 内联整个程序中的小函数
+ *        被内联的函数不含 CALL、DEC 和取地址，因此递归函数永远不会被内联；
+ *        内联后不再调用其他函数的调用者在下一轮也可能被内联。
+ *        参数改为对新临时变量的赋值，函数中的变量、临时变量和标号都换成新的，RETURN 改为对调用结果的赋值和跳到调用之后。
+ *        内联后不再被调用的函数（main 除外）被删除。
+ * @return 内联的调用个数
+ */
+int ir_inline_functions(void);
+
+#endif
@@ -36,6 +36,8 @@ void ir_translate_program(ASTNode *root, FILE *file)
         return;
     }
     
+    // 语义分析退出作用域时摘下了局部变量，按同样的顺序重新进入
+    restartScopeReplay();
     IR_DEBUG(IR_DEBUG_VERBOSE, "开始处理外部定义列表\n");
     ir_translate_ext_def_list(externalDefinitions);
     
@@ -108,16 +110,16 @@ void ir_translate_ext_def(ASTNode *root)
     }
     
     // 根据语法规则分情况处理
-    const char *secondNodeName = secondNode->name;
-    
     // 处理变量声明列表
-    if (stringComparison(secondNodeName, "ExtDecList")) {
+    if (root->production == PROD_ExtDef_Global) {
         IR_DEBUG(IR_DEBUG_VERBOSE, "处理全局变量声明\n");
         ir_translate_ext_dec_list(secondNode);
     } 
     // 处理函数定义
-    else if (stringComparison(secondNodeName, "FunDec")) {
-        if (thirdNode && stringComparison(thirdNode->name, "CompSt")) {
+    else if (root->production == PROD_ExtDef_Function || root->production == PROD_ExtDef_FunDecl) {
+        // 进入语义分析为函数建立的作用域，参数和函数体中的局部变量都在其中
+        HashTableNode functionScope = reenterScope(root);
+        if (thirdNode && thirdNode->kind == AST_CompSt) {
             IR_DEBUG(IR_DEBUG_VERBOSE, "处理函数定义(带函数体)\n");
             ir_translate_fun_dec(secondNode);
             ir_translate_comp_st(thirdNode);
@@ -125,6 +127,9 @@ void ir_translate_ext_def(ASTNode *root)
             IR_DEBUG(IR_DEBUG_VERBOSE, "处理函数声明(无函数体)\n");
             // 函数声明不生成中间代码
         }
+        if (functionScope) {
+            popCurrentScope();
+        }
     } else {
         IR_DEBUG(IR_DEBUG_VERBOSE, "处理类型定义或其他声明\n");
         // 纯类型定义或其他情况，不需要生成代码
@@ -198,8 +203,8 @@ Operand ir_translate_var_dec(ASTNode *root)
     Operand resultOperand = NULL;
     
     // 处理简单变量声明 (VarDec -> ID)
-    if (stringComparison(firstChild->name, "ID")) {
-        const char *varName = firstChild->value;
+    if (firstChild->kind == AST_ID) {
+        const char *varName = ast_value(firstChild);
         IR_DEBUG(IR_DEBUG_INFO, "处理ID类型的变量声明: %s\n", varName);
         
         // 在符号表中查找变量
@@ -234,8 +239,8 @@ Operand ir_translate_var_dec(ASTNode *root)
         
         // 向下查找ID节点
         ASTNode *idNode = firstChild;
-        while (idNode && !stringComparison(idNode->name, "ID")) {
-            idNode = idNode->firstChild;
+        while (idNode && idNode->kind != AST_ID) {
+            idNode = getChild(idNode, 0);
         }
         
         if (!idNode) {
@@ -243,7 +248,7 @@ Operand ir_translate_var_dec(ASTNode *root)
             return NULL;
         }
         
-        const char *arrayName = idNode->value;
+        const char *arrayName = ast_value(idNode);
         IR_DEBUG(IR_DEBUG_INFO, "处理数组声明: %s\n", arrayName);
         
         // 在符号表中查找数组
@@ -291,12 +296,12 @@ void ir_translate_fun_dec(ASTNode *root)
     
     // 获取函数名节点
     ASTNode *idNode = getChild(root, 0);
-    if (!idNode || !stringComparison(idNode->name, "ID")) {
+    if (!idNode || idNode->kind != AST_ID) {
         IR_DEBUG(IR_DEBUG_ERROR, "函数声明缺少有效的函数名\n");
         return;
     }
     
-    const char *funcName = idNode->value;
+    const char *funcName = ast_value(idNode);
     IR_DEBUG(IR_DEBUG_INFO, "处理函数: %s\n", funcName);
     
     // 创建函数操作数并生成函数定义中间代码
@@ -468,7 +473,7 @@ void ir_translate_comp_st(ASTNode *root)
     ASTNode *thirdNode = getChild(root, 2);      // StmtList 或 RC
     ASTNode *rcNode = getChild(root, 3);         // 右大括号或NULL
     
-    if (!lcNode || !stringComparison(lcNode->name, "LC")) {
+    if (!lcNode || lcNode->kind != AST_LC) {
         IR_DEBUG(IR_DEBUG_ERROR, "复合语句缺少左大括号\n");
         return;
     }
@@ -476,27 +481,27 @@ void ir_translate_comp_st(ASTNode *root)
     // 检查语法结构并相应处理
     if (secondNode) {
         // 判断第二个节点是否为DefList
-        if (stringComparison(secondNode->name, "DefList")) {
+        if (secondNode->kind == AST_DefList) {
             IR_DEBUG(IR_DEBUG_VERBOSE, "处理复合语句中的局部变量定义\n");
             ir_translate_def_list(secondNode);
             
             // DefList后面应该是StmtList
-            if (thirdNode && stringComparison(thirdNode->name, "StmtList")) {
+            if (thirdNode && thirdNode->kind == AST_StmtList) {
                 IR_DEBUG(IR_DEBUG_VERBOSE, "处理复合语句中的语句列表\n");
                 ir_translate_stmt_list(thirdNode);
             } else if (thirdNode) {
                 IR_DEBUG(IR_DEBUG_ERROR, "复合语句结构异常: DefList后应为StmtList，实际为%s\n", 
-                         thirdNode ? thirdNode->name : "NULL");
+                         thirdNode ? ast_name(thirdNode) : "NULL");
             }
         }
         // 第二个节点是StmtList (没有局部变量定义的情况)
-        else if (stringComparison(secondNode->name, "StmtList")) {
+        else if (secondNode->kind == AST_StmtList) {
             IR_DEBUG(IR_DEBUG_VERBOSE, "处理复合语句中的语句列表(无局部变量)\n");
             ir_translate_stmt_list(secondNode);
         } 
         else {
             IR_DEBUG(IR_DEBUG_ERROR, "复合语句结构异常: 预期DefList或StmtList，实际为%s\n", 
-                     secondNode->name);
+                     ast_name(secondNode));
         }
     } else {
         IR_DEBUG(IR_DEBUG_VERBOSE, "复合语句为空块\n");
@@ -568,11 +573,10 @@ void ir_translate_stmt(ASTNode *root)
     }
     
     // 根据语句类型进行处理
-    const char *stmtType = firstNode->name;
-    IR_DEBUG(IR_DEBUG_VERBOSE, "语句类型：%s\n", stmtType);
+    IR_DEBUG(IR_DEBUG_VERBOSE, "语句类型：%s\n", ast_name(firstNode));
     
     // 表达式语句: Stmt -> Exp SEMI
-    if (stringComparison(stmtType, "Exp")) {
+    if (root->production == PROD_Stmt_Exp) {
         IR_DEBUG(IR_DEBUG_VERBOSE, "处理表达式语句\n");
         Operand expResult = ir_translate_exp(firstNode);
         if (!expResult) {
@@ -580,12 +584,16 @@ void ir_translate_stmt(ASTNode *root)
         }
     }
     // 复合语句: Stmt -> CompSt
-    else if (stringComparison(stmtType, "CompSt")) {
+    else if (root->production == PROD_Stmt_CompSt) {
         IR_DEBUG(IR_DEBUG_VERBOSE, "处理复合语句\n");
+        HashTableNode blockScope = reenterScope(firstNode);
         ir_translate_comp_st(firstNode);
+        if (blockScope) {
+            popCurrentScope();
+        }
     }
     // 返回语句: Stmt -> RETURN Exp SEMI
-    else if (stringComparison(stmtType, "RETURN")) {
+    else if (root->production == PROD_Stmt_Return) {
         IR_DEBUG(IR_DEBUG_VERBOSE, "处理返回语句\n");
         
         // 获取返回表达式
@@ -606,7 +614,7 @@ void ir_translate_stmt(ASTNode *root)
         ir_generate_code(RETURN_InterCode, returnValue);
     }
     // while循环: Stmt -> WHILE LP Exp RP Stmt
-    else if (stringComparison(stmtType, "WHILE")) {
+    else if (root->production == PROD_Stmt_While) {
         IR_DEBUG(IR_DEBUG_VERBOSE, "处理while循环\n");
         
         // 获取循环条件表达式和循环体
@@ -643,7 +651,7 @@ void ir_translate_stmt(ASTNode *root)
         ir_generate_code(LABEL_InterCode, endLabel);
     }
     // if和if-else语句
-    else if (stringComparison(stmtType, "IF")) {
+    else if (root->production == PROD_Stmt_If || root->production == PROD_Stmt_IfElse) {
         // 获取条件表达式和第一个分支主体
         ASTNode *condExp = getChild(root, 2);
         ASTNode *thenStmt = getChild(root, 4);
@@ -700,7 +708,7 @@ void ir_translate_stmt(ASTNode *root)
             ir_generate_code(LABEL_InterCode, endLabel);
         }
     } else {
-        IR_DEBUG(IR_DEBUG_ERROR, "未知语句类型: %s\n", stmtType);
+        IR_DEBUG(IR_DEBUG_ERROR, "未知语句类型: %s\n", ast_name(firstNode));
     }
 }
 
@@ -902,77 +910,45 @@ Operand ir_translate_exp(ASTNode *root)
         return NULL;
     }
     
-    // 基于第一个子节点的类型进行分发
-    const char *firstChildName = firstChild->name;
-    
-    // 第一个子节点是Exp的情况
-    if (stringComparison(firstChildName, "Exp")) {
-        ASTNode *operatorNode = getChild(root, 1);
-        if (!operatorNode) {
-            IR_DEBUG(IR_DEBUG_ERROR, "表达式缺少操作符\n");
-            return NULL;
-        }
-        
-        const char *opName = operatorNode->name;
-        IR_DEBUG(IR_DEBUG_VERBOSE, "处理二元表达式, 操作符: %s\n", opName);
-        
-        // 根据操作符类型分发到不同的处理函数
-        if (stringComparison(opName, "ASSIGNOP")) {
+    // 按产生式分发到不同的处理函数
+    switch (root->production) {
+        case PROD_Exp_Assign:
             return ir_translate_assign_exp(root);
-        } 
-        else if (stringComparison(opName, "AND") || 
-                 stringComparison(opName, "OR") || 
-                 stringComparison(opName, "RELOP")) {
+        case PROD_Exp_And:
+        case PROD_Exp_Or:
+        case PROD_Exp_Relop:
             return ir_translate_logical_exp(root);
-        } 
-        else if (stringComparison(opName, "PLUS") || 
-                 stringComparison(opName, "MINUS") || 
-                 stringComparison(opName, "STAR") || 
-                 stringComparison(opName, "DIV")) {
+        case PROD_Exp_Plus:
+        case PROD_Exp_Minus:
+        case PROD_Exp_Star:
+        case PROD_Exp_Div:
             return ir_translate_arithmetic_exp(root);
-        } 
-        else if (stringComparison(opName, "LB")) {
+        case PROD_Exp_Index:
             return ir_translate_array_access(root);
-        } 
-        else if (stringComparison(opName, "DOT")) {
+        case PROD_Exp_Field:
             return ir_translate_field_access(root);
-        } 
-        else {
-            IR_DEBUG(IR_DEBUG_ERROR, "未知的操作符类型: %s\n", opName);
-            return NULL;
-        }
-    }
-    // 括号表达式
-    else if (stringComparison(firstChildName, "LP")) {
-        return ir_translate_paren_exp(root);
-    }
-    // 负号表达式
-    else if (stringComparison(firstChildName, "MINUS")) {
-        return ir_translate_negative_exp(root);
-    }
-    // 非表达式
-    else if (stringComparison(firstChildName, "NOT")) {
-        return ir_translate_not_exp(root);
-    }
-    // 标识符相关表达式
-    else if (stringComparison(firstChildName, "ID")) {
-        ASTNode *secondChild = getChild(root, 1);
-        
-        // 区分变量引用和函数调用
-        if (secondChild && stringComparison(secondChild->name, "LP")) {
+        // 括号表达式
+        case PROD_Exp_Paren:
+            return ir_translate_paren_exp(root);
+        // 负号表达式
+        case PROD_Exp_Neg:
+            return ir_translate_negative_exp(root);
+        // 非表达式
+        case PROD_Exp_Not:
+            return ir_translate_not_exp(root);
+        // 函数调用和变量引用
+        case PROD_Exp_Call:
+        case PROD_Exp_CallNoArgs:
             return ir_translate_call_exp(root);
-        } else {
+        case PROD_Exp_ID:
             return ir_translate_id_exp(root);
-        }
-    }
-    // 常量表达式
-    else if (stringComparison(firstChildName, "INT") || 
-             stringComparison(firstChildName, "FLOAT")) {
-        return ir_translate_constant_exp(root);
-    }
-    else {
-        IR_DEBUG(IR_DEBUG_ERROR, "未知的表达式类型: %s\n", firstChildName);
-        return NULL;
+        // 常量表达式
+        case PROD_Exp_INT:
+        case PROD_Exp_FLOAT:
+            return ir_translate_constant_exp(root);
+        default:
+            IR_DEBUG(IR_DEBUG_ERROR, "未知的表达式类型: %s\n", ast_name(firstChild));
+            return NULL;
     }
 }
 
@@ -1007,7 +983,8 @@ Operand ir_translate_assign_exp(ASTNode *root)
     
     // 检查是否是数组间赋值
     int isArrayAssign = 0;
-    if (leftOperand->varName && rightOperand->varName) {
+    if (leftOperand->kind == VARIABLE_OP && leftOperand->varName &&
+        rightOperand->kind == VARIABLE_OP && rightOperand->varName) {
         SymbolTableNode leftSymbol = findSymbolInScope(leftOperand->varName, __INT_MAX__);
         SymbolTableNode rightSymbol = findSymbolInScope(rightOperand->varName, __INT_MAX__);
         
@@ -1168,20 +1145,20 @@ Operand ir_translate_arithmetic_exp(ASTNode *root)
         return NULL;
     }
     
-    const char *opName = operatorNode->name;
+    const char *opName = ast_name(operatorNode);
     int operationType;
     
     // 确定操作类型
-    if (stringComparison(opName, "PLUS")) {
+    if (operatorNode->kind == AST_PLUS) {
         operationType = ADD_InterCode;
         IR_DEBUG(IR_DEBUG_VERBOSE, "加法运算\n");
-    } else if (stringComparison(opName, "MINUS")) {
+    } else if (operatorNode->kind == AST_MINUS) {
         operationType = SUB_InterCode;
         IR_DEBUG(IR_DEBUG_VERBOSE, "减法运算\n");
-    } else if (stringComparison(opName, "STAR")) {
+    } else if (operatorNode->kind == AST_STAR) {
         operationType = MUL_InterCode;
         IR_DEBUG(IR_DEBUG_VERBOSE, "乘法运算\n");
-    } else if (stringComparison(opName, "DIV")) {
+    } else if (operatorNode->kind == AST_DIV) {
         operationType = DIV_InterCode;
         IR_DEBUG(IR_DEBUG_VERBOSE, "除法运算\n");
     } else {
@@ -1253,7 +1230,7 @@ Operand ir_translate_array_access(ASTNode *root)
     
     // 获取数组维度信息
     int depth = arrayCopy->depth;
-    SymbolTableNode arraySymbol = findSymbolInScope(arrayCopy->varName, __INT_MAX__);
+    SymbolTableNode arraySymbol = arrayCopy->varName ? findSymbolInScope(arrayCopy->varName, __INT_MAX__) : NULL;
     
     if (!arraySymbol) {
         IR_DEBUG(IR_DEBUG_ERROR, "在符号表中找不到数组: %s\n", arrayCopy->varName);
@@ -1363,13 +1340,13 @@ Operand ir_translate_field_access(ASTNode *root)
         return NULL;
     }
     
-    if (!stringComparison(fieldNode->name, "ID")) {
+    if (fieldNode->kind != AST_ID) {
         IR_DEBUG(IR_DEBUG_ERROR, "字段节点不是ID类型\n");
         return NULL;
     }
     
     // 获取字段名
-    const char *fieldName = fieldNode->value;
+    const char *fieldName = ast_value(fieldNode);
     IR_DEBUG(IR_DEBUG_VERBOSE, "访问结构体字段: %s\n", fieldName);
     
     // 翻译结构体表达式
@@ -1541,13 +1518,13 @@ Operand ir_translate_id_exp(ASTNode *root)
     
     // 获取标识符节点
     ASTNode *idNode = getChild(root, 0);
-    if (!idNode || !stringComparison(idNode->name, "ID")) {
+    if (!idNode || idNode->kind != AST_ID) {
         IR_DEBUG(IR_DEBUG_ERROR, "变量引用表达式中缺少ID节点\n");
         return NULL;
     }
     
     // 获取变量名
-    const char *varName = idNode->value;
+    const char *varName = ast_value(idNode);
     IR_DEBUG(IR_DEBUG_VERBOSE, "处理变量 %s 的引用\n", varName);
     
     // 在符号表中查找变量
@@ -1608,20 +1585,20 @@ Operand ir_translate_call_exp(ASTNode *root)
         return NULL;
     }
     
-    if (!stringComparison(idNode->name, "ID")) {
+    if (idNode->kind != AST_ID) {
         IR_DEBUG(IR_DEBUG_ERROR, "函数名不是ID类型\n");
         return NULL;
     }
     
     // 获取函数名
-    const char *funcName = idNode->value;
+    const char *funcName = ast_value(idNode);
     IR_DEBUG(IR_DEBUG_VERBOSE, "调用函数: %s\n", funcName);
     
     // 创建结果临时变量
     Operand resultOperand = ir_create_operand(TEMP_OP, VAL);
     
     // 处理内置函数 write
-    if (stringComparison(funcName, "write") && argsNode && stringComparison(argsNode->name, "Args")) {
+    if (stringComparison(funcName, "write") && argsNode && argsNode->kind == AST_Args) {
         IR_DEBUG(IR_DEBUG_VERBOSE, "处理内置函数 write\n");
         
         // 获取write的参数
@@ -1631,7 +1608,7 @@ Operand ir_translate_call_exp(ASTNode *root)
             return NULL;
         }
         
-        if (stringComparison(writeArgExpr->name, "Exp")) {
+        if (writeArgExpr->kind == AST_Exp) {
             Operand argOperand = ir_translate_exp(writeArgExpr);
             if (argOperand) {
                 ir_generate_code(WRITE_InterCode, argOperand);
@@ -1660,7 +1637,7 @@ Operand ir_translate_call_exp(ASTNode *root)
     Operand functionOperand = ir_create_operand(FUNCTION_OP, VAL, funcName);
     
     // 检查是否有参数
-    if (argsNode && stringComparison(argsNode->name, "Args")) {
+    if (argsNode && argsNode->kind == AST_Args) {
         IR_DEBUG(IR_DEBUG_VERBOSE, "处理函数参数\n");
         
         // 查找函数信息
@@ -1700,17 +1677,17 @@ Operand ir_translate_constant_exp(ASTNode *root)
     }
     
     // 根据常量类型创建不同的操作数
-    if (stringComparison(constNode->name, "INT")) {
-        IR_DEBUG(IR_DEBUG_VERBOSE, "处理整型常量: %s\n", constNode->value);
-        return ir_create_operand(CONSTANT_OP, VAL, My_atoi(constNode->value));
+    if (constNode->kind == AST_INT) {
+        IR_DEBUG(IR_DEBUG_VERBOSE, "处理整型常量: %s\n", ast_value(constNode));
+        return ir_create_operand(CONSTANT_OP, VAL, My_atoi(ast_value(constNode)));
     } 
-    else if (stringComparison(constNode->name, "FLOAT")) {
-        IR_DEBUG(IR_DEBUG_VERBOSE, "处理浮点常量: %s (在中间代码中表示为0)\n", constNode->value);
+    else if (constNode->kind == AST_FLOAT) {
+        IR_DEBUG(IR_DEBUG_VERBOSE, "处理浮点常量: %s (在中间代码中表示为0)\n", ast_value(constNode));
         // 浮点数在中间代码中简化为整数0处理
         return ir_create_operand(CONSTANT_OP, VAL, 0);
     } 
     else {
-        IR_DEBUG(IR_DEBUG_ERROR, "未知的常量类型: %s\n", constNode->name);
+        IR_DEBUG(IR_DEBUG_ERROR, "未知的常量类型: %s\n", ast_name(constNode));
         return NULL;
     }
 }
@@ -1752,7 +1729,7 @@ void ir_translate_args(ASTNode *root, FieldList field)
             
             // Get array name and lookup in symbol table
             char *arrayName = argOperand->varName;
-            SymbolTableNode arraySymbol = findSymbolInScope(arrayName, __INT_MAX__);
+            SymbolTableNode arraySymbol = arrayName ? findSymbolInScope(arrayName, __INT_MAX__) : NULL;
             
             if (arraySymbol) {
                 // Count array dimensions
@@ -1823,92 +1800,55 @@ void ir_translate_cond(ASTNode *root, Operand lableTure, Operand lableFalse)
         return;
     }
     
-    // 处理基本节点类型
-    const char *nodeName = firstNode->name;
-    
-    // 处理括号表达式
-    if (stringComparison((char*)nodeName, "LP")) {
-        ir_translate_cond(operatorNode, lableTure, lableFalse);
-        return;
-    }
-    
-    // 处理NOT表达式 - 反转标签
-    if (stringComparison((char*)nodeName, "NOT")) {
-        ir_translate_cond(operatorNode, lableFalse, lableTure);
-        return;
-    }
-    
-    // 处理INT常量表达式
-    if (stringComparison((char*)nodeName, "INT")) {
-        process_int_constant(firstNode, lableTure, lableFalse);
-        return;
-    }
-    
-    // 处理复合表达式 (Exp OPERATOR Exp)
-    if (stringComparison((char*)nodeName, "Exp")) {
-        // 确保有操作符
-        if (operatorNode == NULL) {
-            IR_DEBUG(IR_DEBUG_ERROR, "表达式缺少操作符\n");
+    // 按产生式分派
+    switch (root->production) {
+        case PROD_Exp_Paren:
+            ir_translate_cond(operatorNode, lableTure, lableFalse);
             return;
-        }
-        
-        const char *opName = operatorNode->name;
-        
-        // 处理逻辑AND
-        if (stringComparison((char*)opName, "AND")) {
+        case PROD_Exp_Not:
+            // NOT表达式 - 反转标签
+            ir_translate_cond(operatorNode, lableFalse, lableTure);
+            return;
+        case PROD_Exp_INT:
+            process_int_constant(firstNode, lableTure, lableFalse);
+            return;
+        case PROD_Exp_And:
             process_logical_and(firstNode, secondNode, lableTure, lableFalse);
             return;
-        }
-        
-        // 处理逻辑OR
-        if (stringComparison((char*)opName, "OR")) {
+        case PROD_Exp_Or:
             process_logical_or(firstNode, secondNode, lableTure, lableFalse);
             return;
-        }
-        
-        // 处理关系运算符
-        if (stringComparison((char*)opName, "RELOP")) {
-            process_relational_op(firstNode, secondNode, operatorNode->value, lableTure, lableFalse);
+        case PROD_Exp_Relop:
+            process_relational_op(firstNode, secondNode, ast_value(operatorNode), lableTure, lableFalse);
             return;
-        }
-        
-        // 处理赋值操作
-        if (stringComparison((char*)opName, "ASSIGNOP")) {
+        case PROD_Exp_Assign:
             process_assignment(firstNode, secondNode, lableTure, lableFalse);
             return;
-        }
-        
-        // 处理算术运算
-        if (is_arithmetic_op(opName)) {
-            process_arithmetic_expr(firstNode, secondNode, opName, lableTure, lableFalse);
+        case PROD_Exp_Plus:
+        case PROD_Exp_Minus:
+        case PROD_Exp_Star:
+        case PROD_Exp_Div:
+            process_arithmetic_expr(firstNode, secondNode, operatorNode, lableTure, lableFalse);
             return;
-        }
-        
-        // 处理数组或结构体访问
-        if (stringComparison((char*)opName, "LB") || stringComparison((char*)opName, "DOT")) {
+        case PROD_Exp_Index:
+        case PROD_Exp_Field:
+            // 数组或结构体访问
             process_complex_expr(root, lableTure, lableFalse);
             return;
-        }
+        default:
+            break;
     }
     
     // 处理其他类型的表达式 (ID, MINUS等)
     process_simple_expr(root, lableTure, lableFalse);
 }
 
-/* 判断是否为算术运算符 */
-static inline int is_arithmetic_op(const char *opName) {
-    return stringComparison((char*)opName, "PLUS") || 
-           stringComparison((char*)opName, "MINUS") || 
-           stringComparison((char*)opName, "STAR") || 
-           stringComparison((char*)opName, "DIV");
-}
-
 /* 处理整数常量表达式 */
 static void process_int_constant(ASTNode *intNode, Operand trueLabel, Operand falseLabel) {
-    IR_DEBUG(IR_DEBUG_VERBOSE, "处理整数常量: %s\n", intNode->value);
+    IR_DEBUG(IR_DEBUG_VERBOSE, "处理整数常量: %s\n", ast_value(intNode));
     
     // 解析整数值
-    int value = My_atoi(intNode->value);
+    int value = My_atoi(ast_value(intNode));
     
     // 根据值和目标标签生成跳转
     if (value && trueLabel) {
@@ -2027,9 +1967,9 @@ static void process_assignment(ASTNode *leftExpr, ASTNode *rightExpr,
 }
 
 /* 处理算术表达式 */
-static void process_arithmetic_expr(ASTNode *leftExpr, ASTNode *rightExpr, const char *opName,
+static void process_arithmetic_expr(ASTNode *leftExpr, ASTNode *rightExpr, ASTNode *opNode,
                                   Operand trueLabel, Operand falseLabel) {
-    IR_DEBUG(IR_DEBUG_VERBOSE, "处理算术表达式: %s\n", opName);
+    IR_DEBUG(IR_DEBUG_VERBOSE, "处理算术表达式: %s\n", ast_name(opNode));
     
     // 获取操作数
     Operand leftOp = ir_translate_exp(leftExpr);
@@ -2037,11 +1977,11 @@ static void process_arithmetic_expr(ASTNode *leftExpr, ASTNode *rightExpr, const
     
     // 确定运算类型
     int opType;
-    if (stringComparison((char*)opName, "PLUS")) {
+    if (opNode->kind == AST_PLUS) {
         opType = ADD_InterCode;
-    } else if (stringComparison((char*)opName, "MINUS")) {
+    } else if (opNode->kind == AST_MINUS) {
         opType = SUB_InterCode;
-    } else if (stringComparison((char*)opName, "STAR")) {
+    } else if (opNode->kind == AST_STAR) {
         opType = MUL_InterCode;
     } else { // DIV
         opType = DIV_InterCode;
@@ -2093,7 +2033,7 @@ static void process_complex_expr(ASTNode *expr, Operand trueLabel, Operand false
 /* 处理简单表达式(ID, MINUS等) */
 static void process_simple_expr(ASTNode *expr, Operand trueLabel, Operand falseLabel) {
     IR_DEBUG(IR_DEBUG_VERBOSE, "处理简单表达式: %s\n", 
-             expr->firstChild ? expr->firstChild->name : "unknown");
+             expr->childCount > 0 ? ast_name(getChild(expr, 0)) : "unknown");
     
     // 计算表达式结果
     Operand result = ir_translate_exp(expr);
@@ -236,9 +236,8 @@ static void process_logical_and(ASTNode *leftExpr, ASTNode *rightExpr, Operand t
 static void process_logical_or(ASTNode *leftExpr, ASTNode *rightExpr, Operand trueLabel, Operand falseLabel);
 static void process_relational_op(ASTNode *leftExpr, ASTNode *rightExpr, char *relOp, Operand trueLabel, Operand falseLabel);
 static void process_assignment(ASTNode *leftExpr, ASTNode *rightExpr, Operand trueLabel, Operand falseLabel);
-static void process_arithmetic_expr(ASTNode *leftExpr, ASTNode *rightExpr, const char *opName, Operand trueLabel, Operand falseLabel);
+static void process_arithmetic_expr(ASTNode *leftExpr, ASTNode *rightExpr, ASTNode *opNode, Operand trueLabel, Operand falseLabel);
 static void process_complex_expr(ASTNode *expr, Operand trueLabel, Operand falseLabel);
 static void process_simple_expr(ASTNode *expr, Operand trueLabel, Operand falseLabel);
-static inline int is_arithmetic_op(const char *opName);
 
 #endif /* INTERMEDIATE_H */
\ No newline at end of file
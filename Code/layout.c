@@ -0,0 +1,223 @@
+#include "layout.h"
+#include "optimize.h"
+
+/* ir_layout_label 基本块开头的标号，没有则补上一个 */
+static Operand ir_layout_label(IRBlock *block)
+{
+    if (block->first->code.kind != LABEL_InterCode) {
+        InterCodes label = ir_insert_code_before(block->first, LABEL_InterCode);
+        label->code.u.singleOP.op = ir_new_label();
+        block->first = label;
+        block->codeCount++;
+    }
+    return block->first->code.u.singleOP.op;
+}
+
+/* ir_layout_set_target 修改 GOTO/IFGOTO 的跳转目标 */
+static void ir_layout_set_target(InterCodes jump, Operand label)
+{
+    if (jump->code.kind == GOTO_InterCode) {
+        jump->code.u.singleOP.op = label;
+    } else {
+        jump->code.u.ifgotoOP.label = label;
+    }
+}
+
+/* ir_layout_forward_target 只有标号和一条 GOTO 的块跳往的块，其余块返回-1 */
+static int ir_layout_forward_target(IRCfg cfg, int b)
+{
+    IRBlock *block = &cfg->blocks[b];
+    bool onlyJump = block->last->code.kind == GOTO_InterCode &&
+                    (block->first == block->last ||
+                     (block->first->next == block->last && block->first->code.kind == LABEL_InterCode));
+    return onlyJump ? ir_cfg_label_block(cfg, ir_get_jump_target(block->last)) : -1;
+}
+
+/* ir_layout_thread_jumps 跳到转发块的跳转改跳最终目标，IF c GOTO L1; GOTO L2; LABEL L1 改为 IF !c GOTO L2 */
+static void ir_layout_thread_jumps(IRCfg cfg)
+{
+    bool changed = false;
+    for (int b = 0; b < cfg->blockCount; b++) {
+        InterCodes last = cfg->blocks[b].last;
+        int target = ir_cfg_label_block(cfg, ir_get_jump_target(last));
+        if (target < 0) {
+            continue;
+        }
+        // 转发块可能连成环，最多走 blockCount 步
+        int final = target;
+        for (int step = 0; step < cfg->blockCount; step++) {
+            int next = ir_layout_forward_target(cfg, final);
+            if (next < 0 || next == final || next == target) {
+                break;
+            }
+            final = next;
+        }
+        if (final != target) {
+            ir_layout_set_target(last, ir_layout_label(&cfg->blocks[final]));
+            changed = true;
+        }
+    }
+
+    for (int b = 0; b + 2 < cfg->blockCount; b++) {
+        IRBlock *block = &cfg->blocks[b];
+        IRBlock *fall = &cfg->blocks[b + 1];
+        InterCodes last = block->last;
+        int over = ir_layout_forward_target(cfg, b + 1);
+        if (last->code.kind != IFGOTO_InterCode || over < 0 || fall->predCount != 1 ||
+            ir_cfg_label_block(cfg, ir_get_jump_target(last)) != b + 2) {
+            continue;
+        }
+        last->code.u.ifgotoOP.relop = ir_invert_relop(last->code.u.ifgotoOP.relop);
+        last->code.u.ifgotoOP.label = fall->last->code.u.singleOP.op;
+        ir_remove_code(fall->last);
+        changed = true;
+        b++;                           // 转发块可能已经删空，跳过它
+    }
+    if (changed) {
+        ir_rebuild_cfg(cfg);
+        ir_cfg_remove_unreachable(cfg);
+    }
+}
+
+/* ir_layout_next 链中接在块 b 后面的块，没有合适的块时返回-1；入口块和必须在最后的块不参与 */
+static int ir_layout_next(IRCfg cfg, int b, bool *placed, int tail)
+{
+    IRBlock *block = &cfg->blocks[b];
+    InterCodes last = block->last;
+    if (last->code.kind == RETURN_InterCode || block->succCount == 0) {
+        return -1;
+    }
+    int fall = last->code.kind == GOTO_InterCode || b + 1 >= cfg->blockCount ? -1 : b + 1;
+    int target = ir_cfg_label_block(cfg, ir_get_jump_target(last));
+    bool takeTarget = target > 0 && target != tail && !placed[target] && cfg->blocks[target].predCount == 1;
+    if (last->code.kind == IFGOTO_InterCode) {
+        // 条件跳转的目标只在更深的循环中（如回边上的复制块）或顺序后继已放置时才接在后面
+        takeTarget = takeTarget && (fall < 0 || placed[fall] || fall == tail ||
+                                    ir_cfg_loop_depth(cfg, target) > ir_cfg_loop_depth(cfg, fall));
+    }
+    if (takeTarget) {
+        return target;
+    }
+    return fall > 0 && fall != tail && !placed[fall] ? fall : -1;
+}
+
+/* ir_layout_fix_jumps 按新顺序补上跳转：顺序后继不再紧随其后时加 GOTO，条件跳转的目标紧随其后时反转条件 */
+static void ir_layout_fix_jumps(IRCfg cfg, int *order, int count)
+{
+    for (int i = 0; i < count; i++) {
+        int b = order[i];
+        int next = i + 1 < count ? order[i + 1] : -1;
+        IRBlock *block = &cfg->blocks[b];
+        InterCodes last = block->last;
+        if (last->code.kind == GOTO_InterCode || last->code.kind == RETURN_InterCode || b + 1 >= cfg->blockCount) {
+            continue;
+        }
+        int fall = b + 1;
+        if (fall == next) {
+            continue;
+        }
+        if (last->code.kind == IFGOTO_InterCode && ir_cfg_label_block(cfg, ir_get_jump_target(last)) == next) {
+            last->code.u.ifgotoOP.relop = ir_invert_relop(last->code.u.ifgotoOP.relop);
+            last->code.u.ifgotoOP.label = ir_layout_label(&cfg->blocks[fall]);
+            continue;
+        }
+        InterCodes jump = ir_insert_code_before(last->next, GOTO_InterCode);
+        jump->code.u.singleOP.op = ir_layout_label(&cfg->blocks[fall]);
+        block->last = jump;
+        block->codeCount++;
+    }
+}
+
+/* ir_layout_relink 按新顺序重新连接各块的代码 */
+static void ir_layout_relink(IRCfg cfg, int *order, int count)
+{
+    InterCodes end = cfg->blocks[cfg->blockCount - 1].last->next;
+    InterCodes prev = cfg->funcHead;
+    for (int i = 0; i < count; i++) {
+        IRBlock *block = &cfg->blocks[order[i]];
+        prev->next = block->first;
+        block->first->prev = prev;
+        prev = block->last;
+    }
+    prev->next = end;
+    end->prev = prev;
+    if (end == interCodeListHead) {
+        interCodeListTail = prev;
+    }
+}
+
+/* ir_layout_remove_jumps 删除跳到紧随其后的标号的跳转，以及没有跳转指向的标号 */
+static int ir_layout_remove_jumps(IRCfg cfg)
+{
+    int removed = 0;
+    bool *used = (bool *)calloc(labelNo, sizeof(bool));
+    for (InterCodes code = cfg->funcHead->next; code != interCodeListHead && code->code.kind != FUNC_InterCode;) {
+        InterCodes next = code->next;
+        int target = ir_get_jump_target(code);
+        if (target >= 0) {
+            bool toNext = false;
+            for (InterCodes label = next; label != interCodeListHead && label->code.kind == LABEL_InterCode;
+                 label = label->next) {
+                toNext = toNext || ir_get_label_no(label) == target;
+            }
+            if (toNext) {
+                ir_remove_code(code);
+                removed++;
+            } else {
+                used[target] = true;
+            }
+        }
+        code = next;
+    }
+    for (InterCodes code = cfg->funcHead->next; code != interCodeListHead && code->code.kind != FUNC_InterCode;) {
+        InterCodes next = code->next;
+        int label = ir_get_label_no(code);
+        if (label >= 0 && !used[label]) {
+            ir_remove_code(code);
+        }
+        code = next;
+    }
+    free(used);
+    return removed;
+}
+
+int ir_layout_blocks(IRCfg cfg)
+{
+    if (cfg->blockCount == 0) {
+        return 0;
+    }
+    ir_layout_thread_jumps(cfg);
+
+    // 最后一块顺序执行到函数末尾时必须留在最后
+    int tail = -1;
+    InterCodes lastCode = cfg->blocks[cfg->blockCount - 1].last;
+    if (lastCode->code.kind != GOTO_InterCode && lastCode->code.kind != RETURN_InterCode) {
+        tail = cfg->blockCount - 1;
+    }
+
+    int *order = (int *)malloc(cfg->blockCount * sizeof(int));
+    bool *placed = (bool *)calloc(cfg->blockCount, sizeof(bool));
+    int count = 0;
+    for (int start = 0; start < cfg->blockCount; start++) {
+        if (placed[start] || (start == tail && start != 0)) {
+            continue;
+        }
+        for (int b = start; b >= 0; b = ir_layout_next(cfg, b, placed, tail)) {
+            placed[b] = true;
+            order[count++] = b;
+        }
+    }
+    if (tail > 0) {
+        order[count++] = tail;
+    }
+
+    ir_layout_fix_jumps(cfg, order, count);
+    ir_layout_relink(cfg, order, count);
+    int removed = ir_layout_remove_jumps(cfg);
+    IR_DEBUG(IR_DEBUG_INFO, "基本块布局: 删除%d条跳转\n", removed);
+
+    free(order);
+    free(placed);
+    ir_rebuild_cfg(cfg);
+    return removed;
+}
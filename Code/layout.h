@@ -0,0 +1,19 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include "cfg.h"
+
+/* 基本块布局模块：消去SSA之后重新排列基本块，让常走的路径顺序执行，并删除多余的跳转 */
+
+/**
+ * @brief 基本块布局
+ *        跳到只有一条 GOTO 的块的跳转直接改跳最终目标；IF c GOTO L1; GOTO L2; LABEL L1 改为 IF !c GOTO L2。
+ *        从入口开始把块串成链：顺序执行的后继优先接在后面，只有一个前驱的 GOTO 目标也接在后面，
+ *        条件跳转的目标只有一个前驱且循环更深时接在后面并反转条件；链断开时按原顺序取下一个未放置的块。
+ *        最后补上必要的 GOTO，删除跳到下一条代码的 GOTO/IFGOTO 和没有跳转指向的标号。
+ * @param cfg 消去SSA之后的函数控制流图，返回时已重新构建
+ * @return 删除的跳转条数
+ */
+int ir_layout_blocks(IRCfg cfg);
+
+#endif
@@ -0,0 +1,207 @@
+#include "licm.h"
+
+static IRValueTable values = NULL;    // defBlock 在外提后改为前置块
+
+/* ir_licm_in_loop 基本块是否属于循环（含内层循环） */
+static bool ir_licm_in_loop(IRCfg cfg, int block, int loop)
+{
+    for (int l = cfg->blocks[block].loop; l >= 0; l = cfg->loops[l].parent) {
+        if (l == loop) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ir_licm_outside_pred 循环头唯一的循环外可达前驱，没有或不止一个时返回-1 */
+static int ir_licm_outside_pred(IRCfg cfg, int loop)
+{
+    IRBlock *header = &cfg->blocks[cfg->loops[loop].header];
+    int outside = -1;
+    for (int i = 0; i < header->predCount; i++) {
+        int p = header->preds[i];
+        if (cfg->blocks[p].rpo < 0 || ir_licm_in_loop(cfg, p, loop)) {
+            continue;
+        }
+        if (outside >= 0) {
+            return -1;
+        }
+        outside = p;
+    }
+    return outside;
+}
+
+/* ir_licm_split_entries 循环外前驱以条件跳转结束、顺序执行进入循环头时，在两者之间插入一个空块作为前置块；
+ * 新块的块号紧接在前驱之后，循环头前驱的相对顺序不变，φ函数的参数仍然对应 */
+static void ir_licm_split_entries(IRCfg cfg)
+{
+    bool split = false;
+    for (int l = 0; l < cfg->loopCount; l++) {
+        int header = cfg->loops[l].header;
+        int p = ir_licm_outside_pred(cfg, l);
+        if (p < 0 || p != header - 1 || cfg->blocks[p].succCount != 2 ||
+            cfg->blocks[p].succ[0] != header || cfg->blocks[p].succ[1] == header) {
+            continue;
+        }
+        InterCodes label = ir_insert_code_before(cfg->blocks[header].first, LABEL_InterCode);
+        label->code.u.singleOP.op = ir_new_label();
+        split = true;
+    }
+    if (split) {
+        ir_rebuild_cfg(cfg);
+    }
+}
+
+/* ir_licm_writes_memory 循环中是否有存储、调用或对内存中变量的定值 */
+static bool ir_licm_writes_memory(IRCfg cfg, int loop)
+{
+    IRLoop *info = &cfg->loops[loop];
+    for (int i = 0; i < info->blockCount; i++) {
+        IR_FOR_EACH_BLOCK_CODE(&cfg->blocks[info->blocks[i]], code) {
+            switch (code->code.kind) {
+                case TO_ADDR_InterCode:
+                case CALL_InterCode:
+                    return true;
+                case ASSIGN_InterCode:
+                    if (code->code.u.doubleOP.left->kind == TEMP_OP && code->code.u.doubleOP.left->type == ADDRESS) {
+                        return true;
+                    }
+                    break;
+                case READ_InterCode:
+                    if (code->code.u.singleOP.op->type == ADDRESS) {
+                        return true;
+                    }
+                    break;
+                default:
+                    break;
+            }
+            int v = ir_value_index(values, ir_get_def_operand(code));
+            if (v >= 0 && values->inMemory[v]) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/* ir_licm_always_executes 每次进入循环时块是否一定执行：它支配循环中所有可能离开循环的块 */
+static bool ir_licm_always_executes(IRCfg cfg, int block, int loop)
+{
+    IRLoop *info = &cfg->loops[loop];
+    for (int i = 0; i < info->blockCount; i++) {
+        IRBlock *exiting = &cfg->blocks[info->blocks[i]];
+        bool leaves = exiting->succCount == 0;
+        for (int s = 0; s < exiting->succCount; s++) {
+            leaves = leaves || !ir_licm_in_loop(cfg, exiting->succ[s], loop);
+        }
+        if (leaves && !ir_cfg_dominates(cfg, block, info->blocks[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ir_licm_can_hoist 代码能否移出循环：结果是SSA值，读取的值都在循环中不变，推测执行不会出错或读到旧值 */
+static bool ir_licm_can_hoist(IRCfg cfg, InterCodes code, int block, int loop, bool writesMemory)
+{
+    switch (code->code.kind) {
+        case ASSIGN_InterCode:
+            if (code->code.u.doubleOP.left->kind == TEMP_OP && code->code.u.doubleOP.left->type == ADDRESS) {
+                return false;
+            }
+            break;
+        case ADD_InterCode:
+        case SUB_InterCode:
+        case MUL_InterCode:
+        case DIV_InterCode:
+        case GET_ADDR_InterCode:
+        case GET_CONTENT_InterCode:
+            break;
+        default:
+            return false;
+    }
+    int d = ir_value_index(values, ir_get_def_operand(code));
+    if (d < 0 || values->defCount[d] != 1 || values->inMemory[d]) {
+        return false;
+    }
+
+    bool load = code->code.kind == GET_CONTENT_InterCode;
+    Operand *slots[3];
+    int slotCount = ir_get_use_operands(code, slots);
+    for (int i = 0; i < slotCount; i++) {
+        Operand op = *slots[i];
+        int v = ir_value_index(values, op);
+        if (v < 0 || (op->kind == VARIABLE_OP && op->type == ADDRESS)) {
+            continue;                  // 常量和 &v 都是不变的
+        }
+        if (op->type == ADDRESS || values->inMemory[v]) {
+            load = true;
+        }
+        if (!values->inMemory[v] && (values->defCount[v] > 1 ||
+                                     (values->defCount[v] == 1 && ir_licm_in_loop(cfg, values->defBlock[v], loop)))) {
+            return false;
+        }
+    }
+    if (load && writesMemory) {
+        return false;
+    }
+    Operand divisor = code->code.u.tripleOP.op2;
+    bool mayTrap = code->code.kind == DIV_InterCode && !(divisor->kind == CONSTANT_OP && divisor->value != 0);
+    return !(load || mayTrap) || ir_licm_always_executes(cfg, block, loop);
+}
+
+/* ir_licm_hoist_loop 按逆后序扫描循环中的块，把不变的代码依次移到前置块末尾 */
+static int ir_licm_hoist_loop(IRCfg cfg, int loop)
+{
+    int preheader = ir_licm_outside_pred(cfg, loop);
+    if (preheader < 0 || cfg->blocks[preheader].succCount != 1) {
+        return 0;
+    }
+    InterCodes last = cfg->blocks[preheader].last;
+    InterCodes position = last->code.kind == GOTO_InterCode ? last : last->next;
+    bool writesMemory = ir_licm_writes_memory(cfg, loop);
+
+    int hoisted = 0;
+    for (int i = 0; i < cfg->reachableCount; i++) {
+        int b = cfg->rpoOrder[i];
+        if (!ir_licm_in_loop(cfg, b, loop)) {
+            continue;
+        }
+        IRBlock *block = &cfg->blocks[b];
+        InterCodes stop = block->last->next;
+        for (InterCodes code = block->first; code != stop;) {
+            InterCodes next = code->next;
+            if (ir_licm_can_hoist(cfg, code, b, loop, writesMemory)) {
+                ir_move_code_before(code, position);
+                values->defBlock[ir_value_index(values, ir_get_def_operand(code))] = preheader;
+                hoisted++;
+            }
+            code = next;
+        }
+    }
+    if (hoisted > 0) {
+        ir_rebuild_cfg(cfg);
+    }
+    return hoisted;
+}
+
+int ir_hoist_loop_invariants(IRCfg cfg)
+{
+    if (cfg->loopCount == 0) {
+        return 0;
+    }
+    ir_licm_split_entries(cfg);
+
+    values = ir_build_value_table(cfg, false);
+
+    // 内层循环排在外层之后，倒序处理使外提到内层前置块的代码还能继续外提
+    int hoisted = 0;
+    for (int l = cfg->loopCount - 1; l >= 0; l--) {
+        hoisted += ir_licm_hoist_loop(cfg, l);
+    }
+    IR_DEBUG(IR_DEBUG_INFO, "循环不变代码外提: 外提%d条代码\n", hoisted);
+
+    ir_free_value_table(values);
+    values = NULL;
+    return hoisted;
+}
@@ -0,0 +1,19 @@
+#ifndef LICM_H
+#define LICM_H
+
+#include "ssa.h"
+
+/* 循环不变代码外提模块：在SSA形式上把循环中结果不变的计算移到循环前置块 */
+
+/**
+ * @brief 循环不变代码外提
+ *        操作数都是常量、在循环外定值或已被外提的加减乘除、取地址和复制移到循环前置块，内层循环先处理，
+ *        外提到内层前置块的代码还能继续移出外层循环。
+ *        内存读取要求循环中没有存储和调用；读取和除数不是非零常量的除法还要求所在块在每次进入循环时都会执行。
+ *        循环头只有一个来自循环外的前驱：前驱只有这一个后继时直接作为前置块，前驱顺序执行进入循环头时在两者之间插入新块。
+ * @param cfg SSA形式的函数控制流图，返回时已重新构建
+ * @return 外提的代码条数
+ */
+int ir_hoist_loop_invariants(IRCfg cfg);
+
+#endif
@@ -2,16 +2,35 @@
 #include "semantic.h"
 #include "intermediate.h"
 #include "mips.h"
+#include "regalloc.h"
+#include "peephole.h"
+#include "optimize.h"
 extern int yylineno;
 ASTNode* ast_root;
 int errorLexFlag;
 int errorSyntaxFlag;
+int errorSemanticFlag;
 extern int yyparse(void);
 extern void yyrestart(FILE*);
 
 int main(int argc, char** argv) {
 	//printf("main\n");
 	if (argc <= 1) return 1;
+	// 可选参数 --regalloc=color|linear|none 选择寄存器分配方式
+	// --peephole=all|none|规则名,规则名 选择启用的窥孔优化规则
+	// 先检查参数，参数有误时不打开也不创建任何文件
+	for (int i = 3; i < argc; i++) {
+		bool known = false;
+		if (strncmp(argv[i], "--regalloc=", 11) == 0) {
+			known = setMipsRegAllocMode(argv[i] + 11);
+		} else if (strncmp(argv[i], "--peephole=", 11) == 0) {
+			known = setMipsPeepholeRules(argv[i] + 11);
+		}
+		if (!known) {
+			fprintf(stderr, "unknown option: %s\n", argv[i]);
+			return 1;
+		}
+	}
 	FILE *file1 = fopen(argv[1], "r");
 	if (!file1)
 	{
@@ -26,9 +45,11 @@ int main(int argc, char** argv) {
 		perror(argv[2]);
 		return 1;
 	}
+
 	ast_root = NULL;
 	errorLexFlag = 0;     // 词法错误标志
 	errorSyntaxFlag = 0;  // 语法错误标志
+	errorSemanticFlag = 0;  // 语义错误标志
 	yylineno = 1;         // 初始化行号
 	//printf("start\n");
 	yyrestart(file1);
@@ -59,12 +80,20 @@ int main(int argc, char** argv) {
 		}
 		printf("===== 符号表状态结束 =====\n\n");
 		
-		// 进行中间代码生成
-		printf("中间代码生成\n");
-		ir_translate_program(ast_root, file2);
-		generateMipsCode(file2);
+		// 有语义错误时操作数可能没有编号，不再生成代码
+		if (errorSemanticFlag == 0) {
+			// 进行中间代码生成
+			printf("中间代码生成\n");
+			ir_translate_program(ast_root, file2);
+			// 中间代码优化
+			ir_optimize_program();
+			generateMipsCode(file2);
+		}
 		fclose(file2);
 	}
+	// 操作数中的变量名和函数名指向语法树的字符串，最后才释放
+	ast_release();
+	intern_release();
 	
 	return 0;
 }
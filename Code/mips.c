@@ -1,7 +1,8 @@
 #include "mips.h"
-#define MIPS_PRELUDE ".data\n_prompt: .asciiz \"\"\n_ret: .asciiz \"\\n\"\n.globl main\n.text\n" \
-                "read:\n\tli $v0, 4\n\tla $a0, _prompt\n\tsyscall\n\tli $v0, 5\n\tsyscall\n\tjr $ra\n\n"     \
-                "write:\n\tli $v0, 1\n\tsyscall\n\tli $v0, 4\n\tla $a0, _ret\n\tsyscall\n\tmove $v0, $0\n\tjr $ra\n\n"
+#include "regalloc.h"
+#include "peephole.h"
+#include <limits.h>
+#define MIPS_PRELUDE ".data\n_ret: .asciiz \"\\n\"\n.globl main\n.text\n\n"
 // #define PRECODE ".data\n_prompt: .asciiz \"Enter an integer:\"\n_ret: .asciiz \"\\n\"\n.globl main\n.text\n" \
 //                 "read:\n\tli $v0, 4\n\tla $a0, _prompt\n\tsyscall\n\tli $v0, 5\n\tsyscall\n\tjr $ra\n\n"     \
 //                 "write:\n\tli $v0, 1\n\tsyscall\n\tli $v0, 4\n\tla $a0, _ret\n\tsyscall\n\tmove $v0, $0\n\tjr $ra\n\n"
@@ -11,6 +12,14 @@ char *mipsRegNames[32] = {"$zero", "$at", "$v0", "$v1", "$a0", "$a1", "$a2", "$a
 
 int currentStackOffset = 0;
 MipsRegisterAllocation varAllocationList = NULL;
+static int savedRegOffsets[32];                 // Frame slots of saved $s registers
+static bool currentFrameless = false;           // Leaf function without $fp/$ra saves or stack slots
+
+// Frame slots of the current function indexed by var_no (variables and temps are numbered separately)
+static MipsRegisterAllocation *varSlotTable = NULL;
+static MipsRegisterAllocation *tempSlotTable = NULL;
+static int varSlotTableSize = 0;
+static int tempSlotTableSize = 0;
 
 /* Control flow related code generation */
 
@@ -18,29 +27,114 @@ MipsRegisterAllocation varAllocationList = NULL;
 typedef struct {
     const char* relop;
     const char* mipsInstr;
+    const char* zeroInstr;              // Branch comparing against $zero
+    const char* swapped;                // Operator with the operands exchanged
 } RelOpMapping;
 
 static const RelOpMapping RELOP_MAP[] = {
-    {"==", "beq"},
-    {"!=", "bne"},
-    {">", "bgt"},
-    {"<", "blt"},
-    {">=", "bge"},
-    {"<=", "ble"},
-    {NULL, NULL}
+    {"==", "beq", "beqz", "=="},
+    {"!=", "bne", "bnez", "!="},
+    {">", "bgt", "bgtz", "<"},
+    {"<", "blt", "bltz", ">"},
+    {">=", "bge", "bgez", "<="},
+    {"<=", "ble", "blez", ">="},
+    {NULL, NULL, NULL, NULL}
 };
 
+#define MIPS_IMMEDIATE_MIN (-32768)
+#define MIPS_IMMEDIATE_MAX 32767
+
 /* Register management constants */
 #define TEMP_REG_START 8
 #define TEMP_REG_END 15
 #define MAX_NAME_LENGTH 32
 
-/* Helper function to create variable name for temporary variables */
-static void createTempVarName(int varNo, char* buffer, size_t bufferSize) {
-    if (buffer && bufferSize > 0) {
-        char numStr[16];
-        ita(varNo, numStr);
-        snprintf(buffer, bufferSize, "t%s", numStr);
+/* Slot table entry for an operand, growing the table if create is set */
+static MipsRegisterAllocation *getMipsSlotEntry(Operand op, bool create)
+{
+    if (!op || (op->kind != VARIABLE_OP && op->kind != TEMP_OP) || op->var_no < 0) {
+        return NULL;
+    }
+
+    MipsRegisterAllocation **table = op->kind == VARIABLE_OP ? &varSlotTable : &tempSlotTable;
+    int *size = op->kind == VARIABLE_OP ? &varSlotTableSize : &tempSlotTableSize;
+    if (op->var_no >= *size) {
+        if (!create) {
+            return NULL;
+        }
+        int newSize = *size ? *size : 64;
+        while (newSize <= op->var_no) {
+            newSize *= 2;
+        }
+        *table = (MipsRegisterAllocation *)realloc(*table, newSize * sizeof(MipsRegisterAllocation));
+        memset(*table + *size, 0, (newSize - *size) * sizeof(MipsRegisterAllocation));
+        *size = newSize;
+    }
+    return &(*table)[op->var_no];
+}
+
+/* Record a frame slot for an operand, replacing any earlier one */
+static MipsRegisterAllocation addMipsVarAllocation(Operand op, int regNum, int stackOffset)
+{
+    MipsRegisterAllocation *entry = getMipsSlotEntry(op, true);
+    if (!entry) {
+        MIPS_DEBUG_PRINT("Error: Cannot allocate a slot for operand type: %d", op ? op->kind : -1);
+        return NULL;
+    }
+
+    MipsRegisterAllocation newAlloc = (MipsRegisterAllocation)malloc(sizeof(MipsRegisterAllocation_));
+    if (!newAlloc) {
+        MIPS_DEBUG_PRINT("Error: Memory allocation failed");
+        return NULL;
+    }
+    newAlloc->kind = op->kind;
+    newAlloc->varNo = op->var_no;
+    newAlloc->regNum = regNum;
+    newAlloc->stackOffset = stackOffset;
+    newAlloc->next = varAllocationList;
+    varAllocationList = newAlloc;
+    *entry = newAlloc;
+    return newAlloc;
+}
+
+/* Add a string to the data section of the emitter (identical strings share one label) and return its index */
+static int addMipsString(MipsEmitter emitter, const char *text)
+{
+    for (int i = 0; i < emitter->stringCount; i++) {
+        if (strcmp(emitter->stringText.data + emitter->strings[i], text) == 0) {
+            return i;
+        }
+    }
+    if (emitter->stringCount == emitter->stringCapacity) {
+        emitter->stringCapacity = emitter->stringCapacity ? emitter->stringCapacity * 2 : 16;
+        emitter->strings = (int *)realloc(emitter->strings, emitter->stringCapacity * sizeof(int));
+    }
+    emitter->strings[emitter->stringCount] = (int)emitter->stringText.size;
+    text_append(&emitter->stringText, text, strlen(text) + 1);
+    return emitter->stringCount++;
+}
+
+/* Print the strings collected by writes after the code */
+static void emitMipsStrings(MipsEmitter emitter)
+{
+    if (emitter->stringCount > 0) {
+        emitMipsText(emitter, "\n.data\n");
+    }
+    char line[2 * MIPS_MAX_WRITE_STRING + 64];
+    for (int i = 0; i < emitter->stringCount; i++) {
+        int length = snprintf(line, sizeof(line), "_str%d: .asciiz \"", i);
+        for (const char *c = emitter->stringText.data + emitter->strings[i]; *c; c++) {
+            if (*c == '\n') {
+                line[length++] = '\\';
+                line[length++] = 'n';
+            } else {
+                line[length++] = *c;
+            }
+        }
+        line[length++] = '"';
+        line[length++] = '\n';
+        line[length] = '\0';
+        emitMipsText(emitter, line);
     }
 }
 
@@ -60,7 +154,8 @@ void generateMipsCode(FILE *file) {
     
     // Initialize registers and write prelude
     initMipsRegisters();
-    fprintf(file, MIPS_PRELUDE);
+    MipsEmitter emitter = newMipsEmitter(file);
+    emitMipsText(emitter, MIPS_PRELUDE);
     
     // Process all intermediate codes
     InterCodes curInterCodes = interCodeListHead->next;
@@ -70,17 +165,17 @@ void generateMipsCode(FILE *file) {
         switch (curInterCodes->code.kind) {
             case LABEL_InterCode: {
                 int labelNo = curInterCodes->code.u.singleOP.op->var_no;
-                fprintf(file, "label%d:\n", labelNo);
+                emitMipsLabel(emitter, "label", labelNo);
                 MIPS_DEBUG_PRINT("Generated label%d", labelNo);
                 break;
             }
             
             case FUNC_InterCode:
-                generateMipsFunction(curInterCodes, file);
+                generateMipsFunction(curInterCodes, emitter);
                 break;
                 
             case ASSIGN_InterCode:
-                generateMipsAssignment(curInterCodes, file);
+                generateMipsAssignment(curInterCodes, emitter);
                 break;
                 
             case ADD_InterCode:
@@ -89,45 +184,52 @@ void generateMipsCode(FILE *file) {
             case DIV_InterCode: {
                 // Group arithmetic operations
                 switch (curInterCodes->code.kind) {
-                    case ADD_InterCode: generateMipsAdd(curInterCodes, file); break;
-                    case SUB_InterCode: generateMipsSub(curInterCodes, file); break;
-                    case MUL_InterCode: generateMipsMul(curInterCodes, file); break;
-                    case DIV_InterCode: generateMipsDiv(curInterCodes, file); break;
+                    case ADD_InterCode: generateMipsAdd(curInterCodes, emitter); break;
+                    case SUB_InterCode: generateMipsSub(curInterCodes, emitter); break;
+                    case MUL_InterCode: generateMipsMul(curInterCodes, emitter); break;
+                    case DIV_InterCode: generateMipsDiv(curInterCodes, emitter); break;
                 }
                 break;
             }
                 
             case GOTO_InterCode:
-                generateMipsGoto(curInterCodes, file);
+                generateMipsGoto(curInterCodes, emitter);
                 break;
                 
             case IFGOTO_InterCode:
-                generateMipsIfGoto(curInterCodes, file);
+                generateMipsIfGoto(curInterCodes, emitter);
                 break;
                 
             case RETURN_InterCode:
-                generateMipsReturn(curInterCodes, file);
+                generateMipsReturn(curInterCodes, emitter);
                 break;
                 
             case ARG_InterCode: {
-                generateMipsArg(curInterCodes, file);
+                generateMipsArg(curInterCodes, emitter);
                 // Skip to after CALL instruction
                 while (curInterCodes && curInterCodes->code.kind != CALL_InterCode) {
                     curInterCodes = curInterCodes->next;
                 }
                 if (!curInterCodes) {
                     MIPS_DEBUG_PRINT("Error: ARG without matching CALL");
+                    freeMipsEmitter(emitter);
                     return;
                 }
                 break;
             }
+
+            case CALL_InterCode:
+                // A call without arguments has no ARG in front of it
+                generateMipsArg(curInterCodes, emitter);
+                break;
                 
             case READ_InterCode:
-                generateMipsRead(curInterCodes, file);
+                generateMipsRead(curInterCodes, emitter);
                 break;
                 
             case WRITE_InterCode:
-                generateMipsWrite(curInterCodes, file);
+                // Consecutive writes are generated together, continue after the last one
+                curInterCodes = generateMipsWrite(curInterCodes, emitter);
                 break;
                 
             default:
@@ -138,6 +240,9 @@ void generateMipsCode(FILE *file) {
         
         curInterCodes = curInterCodes->next;
     }
+    flushMipsInstrs(emitter);
+    emitMipsStrings(emitter);
+    writeMipsOutput(emitter);
     
     MIPS_DEBUG_PRINT("MIPS code generation completed");
 }
@@ -162,76 +267,136 @@ void initMipsRegisters()
     MIPS_DEBUG_PRINT("All registers initialized");
 }
 
-/* Find and allocate a suitable register for an operand */
-int allocateMipsRegister(Operand op, FILE *file)
+/* Claim a free scratch register for a spilled value or constant */
+static int allocateMipsScratchRegister(void)
 {
-    if (!op || !file) {
-        MIPS_DEBUG_PRINT("Error: Invalid parameters in allocateMipsRegister");
+    for (int i = SCRATCH_REG_START; i <= SCRATCH_REG_END; i++) {
+        if (!mipsRegisters[i].isOccupied) {
+            mipsRegisters[i].isOccupied = 1;
+            mipsRegisters[i].varAlloc = NULL;
+            return i;
+        }
+    }
+
+    MIPS_DEBUG_PRINT("Error: No free scratch register available");
+    return SCRATCH_REG_START;
+}
+
+/* Release all scratch registers */
+void freeMipsScratchRegisters(void)
+{
+    for (int i = SCRATCH_REG_START; i <= SCRATCH_REG_END; i++) {
+        mipsRegisters[i].isOccupied = 0;
+        mipsRegisters[i].varAlloc = NULL;
+    }
+}
+
+/* Stack offset of an operand that is not kept in a register */
+static int getMipsStackOffset(Operand op)
+{
+    MipsRegisterAllocation varAlloc = getMipsVarAllocation(op);
+    if (!varAlloc) {
+        MIPS_DEBUG_PRINT("Error: No stack slot for operand type: %d", op->kind);
         return 0;
     }
+    return varAlloc->stackOffset;
+}
 
-    MIPS_DEBUG_PRINT("Allocating register for operand type: %d", op->kind);
+/* Load the value of an operand into the given register */
+void loadMipsOperandToRegister(Operand op, int regIndex, MipsEmitter emitter)
+{
+    const char *regName = mipsRegisters[regIndex].regName;
 
-    // Handle constant operands
     if (op->kind == CONSTANT_OP) {
-        MIPS_DEBUG_PRINT("Handling constant value: %d", op->value);
-        
-        for (int i = TEMP_REG_START; i <= TEMP_REG_END; i++) {
-            if (!mipsRegisters[i].isOccupied) {
-                mipsRegisters[i].isOccupied = 1;
-                mipsRegisters[i].varAlloc = NULL;
-                fprintf(file, "\tli %s, %d\n", mipsRegisters[i].regName, op->value);
-                
-                MIPS_DEBUG_PRINT("Allocated register %s for constant %d", 
-                    mipsRegisters[i].regName, op->value);
-                return i;
-            }
+        emitMipsInstr(emitter, "li", "ri", regName, op->value);
+    }
+    else if (op->kind == VARIABLE_OP && op->type == ADDRESS) {
+        // Handle address-of operation
+        emitMipsInstr(emitter, "addi", "rri", regName, "$fp", getMipsStackOffset(op));
+    }
+    else if (op->kind == TEMP_OP && op->type == ADDRESS) {
+        // Handle pointer dereference
+        int pointerReg = getMipsAssignedRegister(op);
+        if (pointerReg < 0) {
+            emitMipsInstr(emitter, "lw", "rm", regName, getMipsStackOffset(op), "$fp");
+            pointerReg = regIndex;
         }
-        
-        MIPS_DEBUG_PRINT("Error: No free register available for constant");
+        emitMipsInstr(emitter, "lw", "rm", regName, 0, mipsRegisters[pointerReg].regName);
+    }
+    else {
+        int valueReg = getMipsAssignedRegister(op);
+        if (valueReg < 0) {
+            emitMipsInstr(emitter, "lw", "rm", regName, getMipsStackOffset(op), "$fp");
+        }
+        else if (valueReg != regIndex) {
+            emitMipsInstr(emitter, "move", "rr", regName, mipsRegisters[valueReg].regName);
+        }
+    }
+}
+
+/* Find the register holding an operand's value, loading it into a scratch register if needed */
+int allocateMipsRegister(Operand op, MipsEmitter emitter)
+{
+    if (!op || !emitter) {
+        MIPS_DEBUG_PRINT("Error: Invalid parameters in allocateMipsRegister");
         return 0;
     }
 
-    // Handle variables and temporaries
-    for (int i = TEMP_REG_START; i <= TEMP_REG_END; i++) {
-        if (!mipsRegisters[i].isOccupied) {
-            mipsRegisters[i].isOccupied = 1;
-            
-            // Get variable allocation information
-            MipsRegisterAllocation varAlloc = getMipsVarAllocation(op);
-            if (!varAlloc) {
-                MIPS_DEBUG_PRINT("Error: Failed to get variable allocation");
-                mipsRegisters[i].isOccupied = 0;
-                return 0;
-            }
-            
-            varAlloc->regNum = i;
-            mipsRegisters[i].varAlloc = varAlloc;
-            
-            // Generate appropriate load instruction based on operand type
-            if (op->kind == TEMP_OP && op->type == ADDRESS) {
-                // Handle pointer dereference
-                MIPS_DEBUG_PRINT("Loading pointer value at offset %d", varAlloc->stackOffset);
-                fprintf(file, "\tlw %s, %d($fp)\n", mipsRegisters[i].regName, varAlloc->stackOffset);
-                fprintf(file, "\tlw %s, 0(%s)\n", mipsRegisters[i].regName, mipsRegisters[i].regName);
-            }
-            else if (op->kind == VARIABLE_OP && op->type == ADDRESS) {
-                // Handle address-of operation
-                MIPS_DEBUG_PRINT("Computing address at offset %d", varAlloc->stackOffset);
-                fprintf(file, "\taddi %s, $fp, %d\n", mipsRegisters[i].regName, varAlloc->stackOffset);
-            }
-            else {
-                // Handle regular variable load
-                MIPS_DEBUG_PRINT("Loading value from offset %d", varAlloc->stackOffset);
-                fprintf(file, "\tlw %s, %d($fp)\n", mipsRegisters[i].regName, varAlloc->stackOffset);
-            }
-            
-            return i;
+    if ((op->kind == VARIABLE_OP || op->kind == TEMP_OP) && op->type == VAL) {
+        int regIndex = getMipsAssignedRegister(op);
+        if (regIndex >= 0) {
+            return regIndex;
         }
     }
-    
-    MIPS_DEBUG_PRINT("Error: No free register available");
-    return 0;
+
+    // Zero is always available in $zero
+    if (op->kind == CONSTANT_OP && op->value == 0) {
+        return 0;
+    }
+
+    int scratchIndex = allocateMipsScratchRegister();
+    loadMipsOperandToRegister(op, scratchIndex, emitter);
+    MIPS_DEBUG_PRINT("Loaded operand type %d into %s", op->kind, mipsRegisters[scratchIndex].regName);
+    return scratchIndex;
+}
+
+/* Register holding the pointer of a *t operand */
+static int allocateMipsAddressRegister(Operand op, MipsEmitter emitter)
+{
+    int regIndex = getMipsAssignedRegister(op);
+    if (regIndex >= 0) {
+        return regIndex;
+    }
+
+    regIndex = allocateMipsScratchRegister();
+    emitMipsInstr(emitter, "lw", "rm", mipsRegisters[regIndex].regName, getMipsStackOffset(op), "$fp");
+    return regIndex;
+}
+
+/* Register that receives the value of a result operand */
+int allocateMipsResultRegister(Operand op)
+{
+    int regIndex = getMipsAssignedRegister(op);
+    if (regIndex >= 0) {
+        return regIndex;
+    }
+
+    // Spilled result: compute into a scratch register and store it afterwards
+    regIndex = allocateMipsScratchRegister();
+    mipsRegisters[regIndex].varAlloc = getMipsVarAllocation(op);
+    return regIndex;
+}
+
+/* Move a value that arrived in a fixed register ($v0) into its destination */
+static void storeMipsOperandFromRegister(Operand op, int regIndex, MipsEmitter emitter)
+{
+    int destReg = getMipsAssignedRegister(op);
+    if (destReg < 0) {
+        emitMipsInstr(emitter, "sw", "rm", mipsRegisters[regIndex].regName, getMipsStackOffset(op), "$fp");
+    }
+    else if (destReg != regIndex) {
+        emitMipsInstr(emitter, "move", "rr", mipsRegisters[destReg].regName, mipsRegisters[regIndex].regName);
+    }
 }
 
 /* Get variable allocation information */
@@ -242,59 +407,26 @@ MipsRegisterAllocation getMipsVarAllocation(Operand op)
         return NULL;
     }
 
-    MIPS_DEBUG_PRINT("Looking up allocation for operand type: %d", op->kind);
-    
-    MipsRegisterAllocation curAlloc = varAllocationList;
-    while (curAlloc) {
-        if (op->kind == VARIABLE_OP) {
-            if (strcmp(curAlloc->name, op->varName) == 0) {
-                MIPS_DEBUG_PRINT("Found allocation for variable %s", op->varName);
-                return curAlloc;
-            }
-        }
-        else if (op->kind == TEMP_OP) {
-            char tempName[MAX_NAME_LENGTH];
-            createTempVarName(op->var_no, tempName, sizeof(tempName));
-            
-            if (strcmp(curAlloc->name, tempName) == 0) {
-                MIPS_DEBUG_PRINT("Found allocation for temporary %s", tempName);
-                return curAlloc;
-            }
-        }
-        curAlloc = curAlloc->next;
-    }
-    
-    MIPS_DEBUG_PRINT("No allocation found for operand");
-    return NULL;
+    MipsRegisterAllocation *entry = getMipsSlotEntry(op, false);
+    return entry ? *entry : NULL;
 }
 
 /* Store register value back to stack */
-void storeMipsRegisterToStack(int regIndex, FILE *file)
+void storeMipsRegisterToStack(int regIndex, MipsEmitter emitter)
 {
-    if (regIndex < TEMP_REG_START || regIndex > TEMP_REG_END || !file) {
+    if (regIndex < 0 || regIndex >= 32 || !emitter) {
         MIPS_DEBUG_PRINT("Error: Invalid parameters in storeMipsRegisterToStack");
         return;
     }
 
-    if (!mipsRegisters[regIndex].varAlloc) {
-        MIPS_DEBUG_PRINT("Error: No allocation information for register %s", 
-            mipsRegisters[regIndex].regName);
-        return;
+    // Only scratch registers standing in for a spilled value need a store
+    if (mipsRegisters[regIndex].varAlloc) {
+        int offset = mipsRegisters[regIndex].varAlloc->stackOffset;
+        emitMipsInstr(emitter, "sw", "rm", mipsRegisters[regIndex].regName, offset, "$fp");
+        MIPS_DEBUG_PRINT("Stored register %s back to stack", mipsRegisters[regIndex].regName);
     }
 
-    MIPS_DEBUG_PRINT("Storing register %s back to stack", mipsRegisters[regIndex].regName);
-    
-    // Store value back to stack
-    int offset = mipsRegisters[regIndex].varAlloc->stackOffset;
-    fprintf(file, "\tsw %s, %d($fp)\n", mipsRegisters[regIndex].regName, offset);
-    
-    // Free all temporary registers
-    for (int i = TEMP_REG_START; i <= TEMP_REG_END; i++) {
-        if (mipsRegisters[i].isOccupied) {
-            mipsRegisters[i].isOccupied = 0;
-            MIPS_DEBUG_PRINT("Freed register %s", mipsRegisters[i].regName);
-        }
-    }
+    freeMipsScratchRegisters();
 }
 
 /* Create new variable allocation */
@@ -310,77 +442,95 @@ void createMipsVarAllocation(Operand op)
         return;
     }
 
-    MIPS_DEBUG_PRINT("Creating allocation for operand type: %d", op->kind);
-    
+    if (getMipsAssignedRegister(op) >= 0) {
+        MIPS_DEBUG_PRINT("Skipping allocation for register-resident value");
+        return;
+    }
+
     // Check if allocation already exists
-    MipsRegisterAllocation tempAlloc = getMipsVarAllocation(op);
-    if (tempAlloc) {
+    if (getMipsVarAllocation(op)) {
         MIPS_DEBUG_PRINT("Allocation already exists");
         return;
     }
 
     // Create new allocation
     currentStackOffset += 4;
-    MipsRegisterAllocation newAlloc = (MipsRegisterAllocation)malloc(sizeof(MipsRegisterAllocation_));
-    if (!newAlloc) {
-        MIPS_DEBUG_PRINT("Error: Memory allocation failed");
-        return;
+    MipsRegisterAllocation newAlloc = addMipsVarAllocation(op, -1, -currentStackOffset);
+    if (newAlloc) {
+        MIPS_DEBUG_PRINT("Allocation created for %s %d at offset %d",
+            op->kind == VARIABLE_OP ? "variable" : "temporary", op->var_no, newAlloc->stackOffset);
     }
+}
 
-    // Initialize allocation
-    if (op->kind == VARIABLE_OP) {
-        strncpy(newAlloc->name, op->varName, MAX_NAME_LENGTH - 1);
-        newAlloc->name[MAX_NAME_LENGTH - 1] = '\0';
-        MIPS_DEBUG_PRINT("Created allocation for variable %s", op->varName);
-    }
-    else if (op->kind == TEMP_OP) {
-        createTempVarName(op->var_no, newAlloc->name, MAX_NAME_LENGTH);
-        MIPS_DEBUG_PRINT("Created allocation for temporary %s", newAlloc->name);
+/* Drop the previous function's allocations */
+void clearMipsVarAllocations(void)
+{
+    while (varAllocationList) {
+        MipsRegisterAllocation next = varAllocationList->next;
+        if (varAllocationList->kind == VARIABLE_OP) {
+            varSlotTable[varAllocationList->varNo] = NULL;
+        } else {
+            tempSlotTable[varAllocationList->varNo] = NULL;
+        }
+        free(varAllocationList);
+        varAllocationList = next;
     }
-
-    newAlloc->stackOffset = -currentStackOffset;
-    newAlloc->next = varAllocationList;
-    varAllocationList = newAlloc;
-    
-    MIPS_DEBUG_PRINT("Allocation created at offset %d", newAlloc->stackOffset);
 }
 
 /* Function prologue and epilogue generation */
-static void generateFunctionPrologue(const char* funcName, FILE* file) {
+static void generateFunctionPrologue(const char* funcName, MipsEmitter emitter) {
     MIPS_DEBUG_PRINT("Generating prologue for function: %s", funcName);
     
     // Function label
-    fprintf(file, "%s:\n", funcName);
+    emitMipsLabel(emitter, funcName, -1);
+    if (currentFrameless) {
+        MIPS_DEBUG_PRINT("Leaf function %s needs no frame", funcName);
+        return;
+    }
     
     // Save frame pointer and return address
-    fprintf(file, "\taddi $sp, $sp, -8\n");
-    fprintf(file, "\tsw $fp, 0($sp)\n");
-    fprintf(file, "\tsw $ra, 4($sp)\n");
+    emitMipsInstr(emitter, "addi", "rri", "$sp", "$sp", -8);
+    emitMipsInstr(emitter, "sw", "rm", "$fp", 0, "$sp");
+    emitMipsInstr(emitter, "sw", "rm", "$ra", 4, "$sp");
     
     // Set up new frame pointer
-    fprintf(file, "\tmove $fp, $sp\n");
+    emitMipsInstr(emitter, "move", "rr", "$fp", "$sp");
     
     MIPS_DEBUG_PRINT("Function prologue completed");
 }
 
+/* Functions without CALL never overwrite $ra, READ and WRITE are inline syscalls */
+static bool isMipsLeafFunction(InterCodes funcInterCodes)
+{
+    for (InterCodes cur = funcInterCodes->next; cur != interCodeListHead && cur->code.kind != FUNC_InterCode; cur = cur->next) {
+        if (cur->code.kind == CALL_InterCode) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /* Parameter and local variable allocation */
-static void allocateParameters(InterCodes* curInterCodes, int* paramCount, FILE* file) {
+static void allocateParameters(InterCodes* curInterCodes, int* paramCount, MipsEmitter emitter) {
     MIPS_DEBUG_PRINT("Allocating parameters");
     
     while ((*curInterCodes)->code.kind == PARAM_InterCode) {
-        MipsRegisterAllocation param = (MipsRegisterAllocation)malloc(sizeof(MipsRegisterAllocation_));
+        // Register parameters get a local slot only if they are spilled (see allocateLocalVars)
+        if (*paramCount < ARG_REG_COUNT) {
+            (*paramCount)++;
+            *curInterCodes = (*curInterCodes)->next;
+            continue;
+        }
+
+        Operand paramOp = (*curInterCodes)->code.u.singleOP.op;
+        MipsRegisterAllocation param = addMipsVarAllocation(paramOp, getMipsAssignedRegister(paramOp),
+            8 + (*paramCount - ARG_REG_COUNT) * 4);
         if (!param) {
-            MIPS_DEBUG_PRINT("Error: Memory allocation failed for parameter");
             return;
         }
         
-        strcpy(param->name, (*curInterCodes)->code.u.singleOP.op->varName);
-        param->stackOffset = 8 + (*paramCount) * 4;
-        param->next = varAllocationList;
-        varAllocationList = param;
-        
         MIPS_DEBUG_PRINT("Allocated parameter %s at offset %d", 
-            param->name, param->stackOffset);
+            paramOp->varName, param->stackOffset);
         
         (*paramCount)++;
         *curInterCodes = (*curInterCodes)->next;
@@ -409,17 +559,13 @@ static void allocateLocalVars(InterCodes curInterCodes) {
                 
             case DEC_InterCode: {
                 currentStackOffset += curInterCodes->code.u.doubleOP.right->value;
-                MipsRegisterAllocation array = (MipsRegisterAllocation)malloc(sizeof(MipsRegisterAllocation_));
+                Operand arrayOp = curInterCodes->code.u.doubleOP.left;
+                MipsRegisterAllocation array = addMipsVarAllocation(arrayOp, -1, (-1) * currentStackOffset);
                 if (!array) {
-                    MIPS_DEBUG_PRINT("Error: Memory allocation failed for array");
                     return;
                 }
-                strcpy(array->name, curInterCodes->code.u.doubleOP.left->varName);
-                array->stackOffset = (-1) * currentStackOffset;
-                array->next = varAllocationList;
-                varAllocationList = array;
                 MIPS_DEBUG_PRINT("Allocated array %s at offset %d", 
-                    array->name, array->stackOffset);
+                    arrayOp->varName, array->stackOffset);
                 break;
             }
                 
@@ -432,6 +578,7 @@ static void allocateLocalVars(InterCodes curInterCodes) {
                 createMipsVarAllocation(curInterCodes->code.u.doubleOP.left);
                 break;
                 
+            case RETURN_InterCode:
             case ARG_InterCode:
             case WRITE_InterCode:
             case READ_InterCode:
@@ -442,59 +589,170 @@ static void allocateLocalVars(InterCodes curInterCodes) {
     }
 }
 
+/* Copy registers as one parallel assignment: dests[i] := srcs[i] (or 0(srcs[i]) when derefs[i]) */
+static void emitMipsParallelMoves(int *dests, int *srcs, bool *derefs, int count, MipsEmitter emitter)
+{
+    bool done[ARG_REG_COUNT] = {false};
+    int remaining = count;
+
+    for (int i = 0; i < count; i++) {
+        if (!derefs[i] && dests[i] == srcs[i]) {
+            done[i] = true;
+            remaining--;
+        }
+    }
+
+    while (remaining > 0) {
+        // A copy is ready once no other pending copy still reads its destination
+        int ready = -1;
+        for (int i = 0; i < count && ready < 0; i++) {
+            if (done[i]) {
+                continue;
+            }
+            ready = i;
+            for (int j = 0; j < count; j++) {
+                if (j != i && !done[j] && srcs[j] == dests[i]) {
+                    ready = -1;
+                    break;
+                }
+            }
+        }
+
+        if (ready < 0) {
+            // Only cycles are left: park one destination in a scratch register to break one
+            int i = 0;
+            while (done[i]) {
+                i++;
+            }
+            emitMipsInstr(emitter, "move", "rr",
+                mipsRegisters[SCRATCH_REG_END].regName, mipsRegisters[dests[i]].regName);
+            for (int j = 0; j < count; j++) {
+                if (!done[j] && srcs[j] == dests[i]) {
+                    srcs[j] = SCRATCH_REG_END;
+                }
+            }
+            continue;
+        }
+
+        if (derefs[ready]) {
+            emitMipsInstr(emitter, "lw", "rm",
+                mipsRegisters[dests[ready]].regName, 0, mipsRegisters[srcs[ready]].regName);
+        } else {
+            emitMipsInstr(emitter, "move", "rr",
+                mipsRegisters[dests[ready]].regName, mipsRegisters[srcs[ready]].regName);
+        }
+        done[ready] = true;
+        remaining--;
+    }
+}
+
+/* Move incoming parameters from $a0-$a3 and the caller's stack to their allocated homes */
+static void moveMipsParameters(InterCodes curInterCodes, MipsEmitter emitter) {
+    int dests[ARG_REG_COUNT], srcs[ARG_REG_COUNT];
+    bool derefs[ARG_REG_COUNT];
+    int moveCount = 0;
+    int paramCount = 0;
+
+    // Spill register parameters first, the copies below may overwrite $a0-$a3
+    for (InterCodes cur = curInterCodes; cur->code.kind == PARAM_InterCode && paramCount < ARG_REG_COUNT; cur = cur->next) {
+        Operand param = cur->code.u.singleOP.op;
+        int argReg = ARG_REG_START + paramCount++;
+        int regIndex = getMipsAssignedRegister(param);
+        if (regIndex >= 0) {
+            dests[moveCount] = regIndex;
+            srcs[moveCount] = argReg;
+            derefs[moveCount] = false;
+            moveCount++;
+        }
+        else if (getMipsVarAllocation(param)) {
+            emitMipsInstr(emitter, "sw", "rm", mipsRegisters[argReg].regName, getMipsStackOffset(param), "$fp");
+        }
+    }
+    emitMipsParallelMoves(dests, srcs, derefs, moveCount, emitter);
+
+    // Stack parameters that were coloured into registers
+    paramCount = 0;
+    for (InterCodes cur = curInterCodes; cur->code.kind == PARAM_InterCode; cur = cur->next) {
+        int regIndex = getMipsAssignedRegister(cur->code.u.singleOP.op);
+        if (paramCount >= ARG_REG_COUNT && regIndex >= 0) {
+            emitMipsInstr(emitter, "lw", "rm",
+                mipsRegisters[regIndex].regName, 8 + (paramCount - ARG_REG_COUNT) * 4, "$fp");
+            MIPS_DEBUG_PRINT("Loaded parameter %d into %s", paramCount, mipsRegisters[regIndex].regName);
+        }
+        paramCount++;
+    }
+}
+
 /* Function definition code generation */
-void generateMipsFunction(InterCodes curInterCodes, FILE *file)
+void generateMipsFunction(InterCodes curInterCodes, MipsEmitter emitter)
 {
     const char* funcName = curInterCodes->code.u.singleOP.op->funcName;
     MIPS_DEBUG_PRINT("Generating code for function: %s", funcName);
     
-    // Generate function prologue
-    generateFunctionPrologue(funcName, file);
-    
+    // The previous function is complete: optimise and print its instructions
+    flushMipsInstrs(emitter);
+
+    // Colour the function's values before laying out its frame
+    clearMipsVarAllocations();
+    allocateMipsFunctionRegisters(curInterCodes);
+
     // Initialize stack frame
     currentStackOffset = 0;
     int paramCount = 0;
     
     // Process parameters
     InterCodes tmpInterCodes = curInterCodes->next;
-    allocateParameters(&tmpInterCodes, &paramCount, file);
+    allocateParameters(&tmpInterCodes, &paramCount, emitter);
     
-    // Allocate local variables
+    // Allocate stack slots for values that did not get a register
     allocateLocalVars(tmpInterCodes);
+
+    // Reserve save slots for the callee-saved registers this function uses
+    for (int i = SAVED_REG_START; i <= SAVED_REG_END; i++) {
+        if (isMipsSavedRegisterUsed(i)) {
+            currentStackOffset += 4;
+            savedRegOffsets[i] = -currentStackOffset;
+        }
+    }
+
+    // A leaf keeps $ra intact; with every value in a register it never touches $fp or $sp either
+    currentFrameless = currentStackOffset == 0 && paramCount <= ARG_REG_COUNT && isMipsLeafFunction(curInterCodes);
+
+    // Generate function prologue
+    generateFunctionPrologue(funcName, emitter);
     
     // Adjust stack pointer for local variables
     if (currentStackOffset > 0) {
-        fprintf(file, "\taddi $sp, $sp, %d\n", (-1) * currentStackOffset);
+        emitMipsInstr(emitter, "addi", "rri", "$sp", "$sp", (-1) * currentStackOffset);
         MIPS_DEBUG_PRINT("Adjusted stack pointer by %d bytes", (-1) * currentStackOffset);
     }
-    
-    // Free temporary registers
-    for (int i = TEMP_REG_START; i <= TEMP_REG_END; i++) {
-        if (mipsRegisters[i].isOccupied) {
-            mipsRegisters[i].isOccupied = 0;
-            MIPS_DEBUG_PRINT("Freed temporary register %s", mipsRegisters[i].regName);
+
+    for (int i = SAVED_REG_START; i <= SAVED_REG_END; i++) {
+        if (isMipsSavedRegisterUsed(i)) {
+            emitMipsInstr(emitter, "sw", "rm", mipsRegisters[i].regName, savedRegOffsets[i], "$fp");
         }
     }
+    moveMipsParameters(curInterCodes->next, emitter);
+    
+    freeMipsScratchRegisters();
 }
 
 /* Common arithmetic operation generation */
-static void generateMipsArithmeticOp(InterCodes curInterCodes, FILE *file, const char* opcode) {
+static void generateMipsArithmeticOp(InterCodes curInterCodes, MipsEmitter emitter, const char* opcode) {
     MIPS_DEBUG_PRINT("Generating %s operation", opcode);
     
-    // Allocate registers for operands and result
-    int resultIndex = allocateMipsRegister(curInterCodes->code.u.tripleOP.result, file);
-    int op1Index = allocateMipsRegister(curInterCodes->code.u.tripleOP.op1, file);
-    int op2Index = allocateMipsRegister(curInterCodes->code.u.tripleOP.op2, file);
+    // Load operands, then pick the result register (scratch registers may be reused)
+    int op1Index = allocateMipsRegister(curInterCodes->code.u.tripleOP.op1, emitter);
+    int op2Index = allocateMipsRegister(curInterCodes->code.u.tripleOP.op2, emitter);
+    freeMipsScratchRegisters();
+    int resultIndex = allocateMipsResultRegister(curInterCodes->code.u.tripleOP.result);
     
     // Generate arithmetic instruction
-    fprintf(file, "\t%s %s, %s, %s\n",
-        opcode,
-        mipsRegisters[resultIndex].regName,
-        mipsRegisters[op1Index].regName,
-        mipsRegisters[op2Index].regName);
+    emitMipsInstr(emitter, opcode, "rrr",
+        mipsRegisters[resultIndex].regName, mipsRegisters[op1Index].regName, mipsRegisters[op2Index].regName);
     
-    // Store result back to memory
-    storeMipsRegisterToStack(resultIndex, file);
+    // Store result back to memory if it was spilled
+    storeMipsRegisterToStack(resultIndex, emitter);
     
     MIPS_DEBUG_PRINT("%s operation completed: %s = %s %s %s",
         opcode,
@@ -505,270 +763,668 @@ static void generateMipsArithmeticOp(InterCodes curInterCodes, FILE *file, const
 }
 
 /* Assignment code generation */
-void generateMipsAssignment(InterCodes curInterCodes, FILE *file)
+void generateMipsAssignment(InterCodes curInterCodes, MipsEmitter emitter)
 {
     MIPS_DEBUG_PRINT("Generating assignment operation");
     
     Operand leftOp = curInterCodes->code.u.doubleOP.left;
     Operand rightOp = curInterCodes->code.u.doubleOP.right;
     
-    int rightIndex = allocateMipsRegister(rightOp, file);
-    int leftIndex = TEMP_REG_START;
-    
     if (leftOp->kind == TEMP_OP && leftOp->type == ADDRESS) {
         // Handle pointer assignment (*x = y)
         MIPS_DEBUG_PRINT("Handling pointer assignment");
         
-        MipsRegisterAllocation leftVarAlloc = getMipsVarAllocation(leftOp);
-        
-        // Find a free register
-        for (int i = TEMP_REG_START; i <= TEMP_REG_END; i++) {
-            if (!mipsRegisters[i].isOccupied) {
-                leftIndex = i;
-                break;
-            }
-        }
-        
-        mipsRegisters[leftIndex].isOccupied = 1;
-        
-        // Load address and store value
-        fprintf(file, "\tlw %s, %d($fp)\n", 
-            mipsRegisters[leftIndex].regName, 
-            leftVarAlloc->stackOffset);
-        fprintf(file, "\tsw %s, 0(%s)\n", 
-            mipsRegisters[rightIndex].regName, 
-            mipsRegisters[leftIndex].regName);
-            
-        // Free registers
-        mipsRegisters[leftIndex].isOccupied = 0;
-        mipsRegisters[rightIndex].isOccupied = 0;
+        int rightIndex = allocateMipsRegister(rightOp, emitter);
+        int leftIndex = allocateMipsAddressRegister(leftOp, emitter);
+        emitMipsInstr(emitter, "sw", "rm", mipsRegisters[rightIndex].regName, 0, mipsRegisters[leftIndex].regName);
+        freeMipsScratchRegisters();
         
         MIPS_DEBUG_PRINT("Pointer assignment completed");
     }
+    else if (getMipsAssignedRegister(leftOp) >= 0) {
+        // Handle register assignment (x = y), load y straight into x
+        MIPS_DEBUG_PRINT("Handling register assignment");
+        
+        loadMipsOperandToRegister(rightOp, getMipsAssignedRegister(leftOp), emitter);
+    }
     else {
-        // Handle regular assignment (x = y)
-        MIPS_DEBUG_PRINT("Handling regular assignment");
+        // Handle assignment to a stack slot
+        MIPS_DEBUG_PRINT("Handling stack assignment");
         
-        leftIndex = allocateMipsRegister(leftOp, file);
-        fprintf(file, "\tmove %s, %s\n", 
-            mipsRegisters[leftIndex].regName, 
-            mipsRegisters[rightIndex].regName);
-        storeMipsRegisterToStack(leftIndex, file);
+        int rightIndex = allocateMipsRegister(rightOp, emitter);
+        emitMipsInstr(emitter, "sw", "rm", mipsRegisters[rightIndex].regName, getMipsStackOffset(leftOp), "$fp");
+        freeMipsScratchRegisters();
         
-        MIPS_DEBUG_PRINT("Regular assignment completed");
+        MIPS_DEBUG_PRINT("Stack assignment completed");
+    }
+}
+
+/* Whether a value fits the signed 16-bit immediate field */
+static bool isMipsImmediate(long long value)
+{
+    return value >= MIPS_IMMEDIATE_MIN && value <= MIPS_IMMEDIATE_MAX;
+}
+
+/* log2 of a positive power of two, -1 for anything else */
+static int getMipsPowerOfTwo(int value)
+{
+    if (value <= 0 || (value & (value - 1)) != 0) {
+        return -1;
+    }
+    return __builtin_ctz(value);
+}
+
+/* result := value, for operations whose operands are both constants */
+static void generateMipsConstantResult(Operand result, int value, MipsEmitter emitter)
+{
+    int resultIndex = allocateMipsResultRegister(result);
+    emitMipsInstr(emitter, "li", "ri", mipsRegisters[resultIndex].regName, value);
+    storeMipsRegisterToStack(resultIndex, emitter);
+}
+
+/* result := source, for operations with an identity constant operand */
+static void generateMipsCopy(Operand result, Operand source, MipsEmitter emitter)
+{
+    int srcIndex = allocateMipsRegister(source, emitter);
+    freeMipsScratchRegisters();
+    int resultIndex = allocateMipsResultRegister(result);
+    if (resultIndex != srcIndex) {
+        emitMipsInstr(emitter, "move", "rr", mipsRegisters[resultIndex].regName, mipsRegisters[srcIndex].regName);
+    }
+    storeMipsRegisterToStack(resultIndex, emitter);
+}
+
+/* result := source <opcode> immediate */
+static void generateMipsImmediateOp(Operand result, const char *opcode, Operand source, int immediate, MipsEmitter emitter)
+{
+    int srcIndex = allocateMipsRegister(source, emitter);
+    freeMipsScratchRegisters();
+    int resultIndex = allocateMipsResultRegister(result);
+    emitMipsInstr(emitter, opcode, "rri",
+        mipsRegisters[resultIndex].regName, mipsRegisters[srcIndex].regName, immediate);
+    storeMipsRegisterToStack(resultIndex, emitter);
+}
+
+// Multiplication by a constant as result := (source << shiftA) <opcode> (source << shiftB),
+// a shift of 0 reads source itself and shiftA of -1 reads $zero
+typedef struct {
+    int shiftA;
+    int shiftB;
+    const char *opcode;
+} MipsMulSequence;
+
+#define MIPS_MUL_SEQUENCE_MAX 3         // Longer sequences are no cheaper than li + mul
+
+/* Find the shortest shift/add/sub sequence multiplying by value */
+static bool findMipsMulSequence(int value, MipsMulSequence *seq)
+{
+    unsigned int target = (unsigned int)value;
+    int bestLength = MIPS_MUL_SEQUENCE_MAX + 1;
+    for (int a = -1; a < 32; a++) {
+        for (int b = 0; b < 32; b++) {
+            if (a == b) {
+                continue;
+            }
+            unsigned int lhs = a < 0 ? 0 : 1u << a;
+            unsigned int rhs = 1u << b;
+            int length = 1 + (a > 0) + (b > 0);
+            if (length >= bestLength) {
+                continue;
+            }
+            if (a >= 0 && lhs + rhs == target) {
+                seq->opcode = "addu";
+            } else if (lhs - rhs == target) {
+                seq->opcode = "subu";
+            } else {
+                continue;
+            }
+            seq->shiftA = a;
+            seq->shiftB = b;
+            bestLength = length;
+        }
+    }
+    return bestLength <= MIPS_MUL_SEQUENCE_MAX;
+}
+
+/* result := source * constant using the sequence found by findMipsMulSequence */
+static void generateMipsMulSequence(Operand result, Operand source, const MipsMulSequence *seq, MipsEmitter emitter)
+{
+    int srcIndex = allocateMipsRegister(source, emitter);
+    freeMipsScratchRegisters();
+    int resultIndex = allocateMipsResultRegister(result);
+
+    // Source and result never use $v1, so it holds the first shifted term
+    const char *src = mipsRegisters[srcIndex].regName;
+    const char *dest = mipsRegisters[resultIndex].regName;
+    const char *tmp = mipsRegisters[SCRATCH_REG_END].regName;
+    const char *lhs = seq->shiftA < 0 ? mipsRegisters[0].regName : src;
+    const char *rhs = src;
+    if (seq->shiftA > 0 && seq->shiftB > 0) {
+        // The result register may be the source, so it is written last
+        emitMipsInstr(emitter, "sll", "rri", tmp, src, seq->shiftB);
+        emitMipsInstr(emitter, "sll", "rri", dest, src, seq->shiftA);
+        lhs = dest;
+        rhs = tmp;
+    } else if (seq->shiftA > 0) {
+        emitMipsInstr(emitter, "sll", "rri", tmp, src, seq->shiftA);
+        lhs = tmp;
+    } else if (seq->shiftB > 0) {
+        emitMipsInstr(emitter, "sll", "rri", tmp, src, seq->shiftB);
+        rhs = tmp;
+    }
+    emitMipsInstr(emitter, seq->opcode, "rrr", dest, lhs, rhs);
+    storeMipsRegisterToStack(resultIndex, emitter);
+}
+
+/* Magic multiplier and shift for signed division by divisor (Hacker's Delight 10-1), |divisor| >= 2 */
+static void getMipsDivisionMagic(int divisor, int *magic, int *shift)
+{
+    const unsigned int two31 = 0x80000000u;
+    unsigned int absDivisor = divisor < 0 ? 0u - (unsigned int)divisor : (unsigned int)divisor;
+    unsigned int t = two31 + ((unsigned int)divisor >> 31);
+    unsigned int absNc = t - 1 - t % absDivisor;
+    unsigned int q1 = two31 / absNc, r1 = two31 - q1 * absNc;
+    unsigned int q2 = two31 / absDivisor, r2 = two31 - q2 * absDivisor;
+    unsigned int delta;
+    int p = 31;
+    do {
+        p++;
+        q1 *= 2;
+        r1 *= 2;
+        if (r1 >= absNc) {
+            q1++;
+            r1 -= absNc;
+        }
+        q2 *= 2;
+        r2 *= 2;
+        if (r2 >= absDivisor) {
+            q2++;
+            r2 -= absDivisor;
+        }
+        delta = absDivisor - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+
+    unsigned int m = q2 + 1;
+    *magic = (int)(divisor < 0 ? 0u - m : m);
+    *shift = p - 32;
+}
+
+/* result := source / divisor rounding toward zero, divisor is neither 0, 1 nor INT_MIN */
+static void generateMipsDivByConstant(Operand result, Operand source, int divisor, MipsEmitter emitter)
+{
+    int srcIndex = allocateMipsRegister(source, emitter);
+    freeMipsScratchRegisters();
+    int resultIndex = allocateMipsResultRegister(result);
+
+    // As for multiplication $v1 is free, the result register is only written once source is dead
+    const char *src = mipsRegisters[srcIndex].regName;
+    const char *dest = mipsRegisters[resultIndex].regName;
+    const char *tmp = mipsRegisters[SCRATCH_REG_END].regName;
+    const char *zero = mipsRegisters[0].regName;
+    int shift = getMipsPowerOfTwo(divisor < 0 ? -divisor : divisor);
+
+    if (shift == 0) {
+        // x / -1
+        emitMipsInstr(emitter, "subu", "rrr", dest, zero, src);
+    }
+    else if (shift > 0) {
+        // Add 2^k - 1 to negative dividends so that the arithmetic shift rounds toward zero
+        if (shift == 1) {
+            emitMipsInstr(emitter, "srl", "rri", tmp, src, 31);
+        } else {
+            emitMipsInstr(emitter, "sra", "rri", tmp, src, shift - 1);
+            emitMipsInstr(emitter, "srl", "rri", tmp, tmp, 32 - shift);
+        }
+        emitMipsInstr(emitter, "addu", "rrr", tmp, src, tmp);
+        emitMipsInstr(emitter, "sra", "rri", dest, tmp, shift);
+        if (divisor < 0) {
+            emitMipsInstr(emitter, "subu", "rrr", dest, zero, dest);
+        }
     }
+    else {
+        // High word of source * magic, corrected and shifted, plus one for negative quotients
+        int magic, magicShift;
+        getMipsDivisionMagic(divisor, &magic, &magicShift);
+        emitMipsInstr(emitter, "li", "ri", tmp, magic);
+        emitMipsInstr(emitter, "mult", "rr", src, tmp);
+        emitMipsInstr(emitter, "mfhi", "r", tmp);
+        if (divisor > 0 && magic < 0) {
+            emitMipsInstr(emitter, "addu", "rrr", tmp, tmp, src);
+        } else if (divisor < 0 && magic > 0) {
+            emitMipsInstr(emitter, "subu", "rrr", tmp, tmp, src);
+        }
+        if (magicShift > 0) {
+            emitMipsInstr(emitter, "sra", "rri", tmp, tmp, magicShift);
+        }
+        emitMipsInstr(emitter, "srl", "rri", dest, tmp, 31);
+        emitMipsInstr(emitter, "addu", "rrr", dest, tmp, dest);
+    }
+    storeMipsRegisterToStack(resultIndex, emitter);
 }
 
 /* Arithmetic operations code generation */
-void generateMipsAdd(InterCodes curInterCodes, FILE *file) {
-    generateMipsArithmeticOp(curInterCodes, file, "add");
+void generateMipsAdd(InterCodes curInterCodes, MipsEmitter emitter) {
+    Operand result = curInterCodes->code.u.tripleOP.result;
+    Operand op1 = curInterCodes->code.u.tripleOP.op1;
+    Operand op2 = curInterCodes->code.u.tripleOP.op2;
+
+    if (op1->kind == CONSTANT_OP && op2->kind == CONSTANT_OP) {
+        generateMipsConstantResult(result, (int)((unsigned)op1->value + (unsigned)op2->value), emitter);
+        return;
+    }
+    // Addition commutes: keep the constant on the right
+    if (op1->kind == CONSTANT_OP) {
+        Operand tmp = op1;
+        op1 = op2;
+        op2 = tmp;
+    }
+    if (op2->kind == CONSTANT_OP && op2->value == 0) {
+        generateMipsCopy(result, op1, emitter);
+    }
+    else if (op2->kind == CONSTANT_OP && isMipsImmediate(op2->value)) {
+        generateMipsImmediateOp(result, "addi", op1, op2->value, emitter);
+    }
+    else {
+        generateMipsArithmeticOp(curInterCodes, emitter, "add");
+    }
 }
 
-void generateMipsSub(InterCodes curInterCodes, FILE *file) {
-    generateMipsArithmeticOp(curInterCodes, file, "sub");
+void generateMipsSub(InterCodes curInterCodes, MipsEmitter emitter) {
+    Operand result = curInterCodes->code.u.tripleOP.result;
+    Operand op1 = curInterCodes->code.u.tripleOP.op1;
+    Operand op2 = curInterCodes->code.u.tripleOP.op2;
+
+    if (op1->kind == CONSTANT_OP && op2->kind == CONSTANT_OP) {
+        generateMipsConstantResult(result, (int)((unsigned)op1->value - (unsigned)op2->value), emitter);
+    }
+    else if (op2->kind == CONSTANT_OP && op2->value == 0) {
+        generateMipsCopy(result, op1, emitter);
+    }
+    else if (op2->kind == CONSTANT_OP && isMipsImmediate(-(long long)op2->value)) {
+        generateMipsImmediateOp(result, "addi", op1, -op2->value, emitter);
+    }
+    else {
+        // 0 - x reads $zero directly
+        generateMipsArithmeticOp(curInterCodes, emitter, "sub");
+    }
 }
 
-void generateMipsMul(InterCodes curInterCodes, FILE *file) {
-    generateMipsArithmeticOp(curInterCodes, file, "mul");
+void generateMipsMul(InterCodes curInterCodes, MipsEmitter emitter) {
+    Operand result = curInterCodes->code.u.tripleOP.result;
+    Operand op1 = curInterCodes->code.u.tripleOP.op1;
+    Operand op2 = curInterCodes->code.u.tripleOP.op2;
+
+    if (op1->kind == CONSTANT_OP && op2->kind == CONSTANT_OP) {
+        generateMipsConstantResult(result, (int)((unsigned)op1->value * (unsigned)op2->value), emitter);
+        return;
+    }
+    if (op1->kind == CONSTANT_OP) {
+        Operand tmp = op1;
+        op1 = op2;
+        op2 = tmp;
+    }
+    int shift = op2->kind == CONSTANT_OP ? getMipsPowerOfTwo(op2->value) : -1;
+    MipsMulSequence seq;
+    if (op2->kind == CONSTANT_OP && op2->value == 0) {
+        generateMipsConstantResult(result, 0, emitter);
+    }
+    else if (shift == 0) {
+        generateMipsCopy(result, op1, emitter);
+    }
+    else if (shift > 0) {
+        generateMipsImmediateOp(result, "sll", op1, shift, emitter);
+    }
+    else if (op2->kind == CONSTANT_OP && findMipsMulSequence(op2->value, &seq)) {
+        generateMipsMulSequence(result, op1, &seq, emitter);
+    }
+    else {
+        generateMipsArithmeticOp(curInterCodes, emitter, "mul");
+    }
 }
 
-void generateMipsDiv(InterCodes curInterCodes, FILE *file) {
-    generateMipsArithmeticOp(curInterCodes, file, "div");
+void generateMipsDiv(InterCodes curInterCodes, MipsEmitter emitter) {
+    Operand result = curInterCodes->code.u.tripleOP.result;
+    Operand op1 = curInterCodes->code.u.tripleOP.op1;
+    Operand op2 = curInterCodes->code.u.tripleOP.op2;
+
+    // Division by zero and INT_MIN / -1 are left to run time
+    if (op1->kind == CONSTANT_OP && op2->kind == CONSTANT_OP && op2->value != 0 &&
+        !(op1->value == INT_MIN && op2->value == -1)) {
+        generateMipsConstantResult(result, op1->value / op2->value, emitter);
+    }
+    else if (op2->kind == CONSTANT_OP && op2->value == 1) {
+        generateMipsCopy(result, op1, emitter);
+    }
+    else if (op1->kind != CONSTANT_OP && op2->kind == CONSTANT_OP &&
+             op2->value != 0 && op2->value != INT_MIN) {
+        generateMipsDivByConstant(result, op1, op2->value, emitter);
+    }
+    else {
+        generateMipsArithmeticOp(curInterCodes, emitter, "div");
+    }
 }
 
 /* Generate unconditional jump */
-void generateMipsGoto(InterCodes curInterCodes, FILE *file)
+void generateMipsGoto(InterCodes curInterCodes, MipsEmitter emitter)
 {
     MIPS_DEBUG_PRINT("Generating unconditional jump to label%d", 
         curInterCodes->code.u.singleOP.op->var_no);
     
-    fprintf(file, "\tj label%d\n", curInterCodes->code.u.singleOP.op->var_no);
+    emitMipsInstr(emitter, "j", "l", "label", curInterCodes->code.u.singleOP.op->var_no);
+}
+
+/* Evaluate a comparison between two constants */
+static bool evaluateMipsRelop(int left, const char *relop, int right)
+{
+    if (strcmp(relop, "==") == 0) return left == right;
+    if (strcmp(relop, "!=") == 0) return left != right;
+    if (strcmp(relop, ">") == 0) return left > right;
+    if (strcmp(relop, "<") == 0) return left < right;
+    if (strcmp(relop, ">=") == 0) return left >= right;
+    return left <= right;
 }
 
 /* Generate conditional branch based on comparison */
-void generateMipsIfGoto(InterCodes curInterCodes, FILE *file)
+void generateMipsIfGoto(InterCodes curInterCodes, MipsEmitter emitter)
 {
     MIPS_DEBUG_PRINT("Generating conditional branch");
     
-    // Load operands into registers
-    int op1Index = allocateMipsRegister(curInterCodes->code.u.ifgotoOP.op1, file);
-    int op2Index = allocateMipsRegister(curInterCodes->code.u.ifgotoOP.op2, file);
-    
+    Operand op1 = curInterCodes->code.u.ifgotoOP.op1;
+    Operand op2 = curInterCodes->code.u.ifgotoOP.op2;
     const char* relop = curInterCodes->code.u.ifgotoOP.relop;
     int labelNo = curInterCodes->code.u.ifgotoOP.label->var_no;
-    
-    MIPS_DEBUG_PRINT("Condition: %s %s %s, jumping to label%d",
-        mipsRegisters[op1Index].regName,
-        relop,
-        mipsRegisters[op2Index].regName,
-        labelNo);
 
     // Find the corresponding MIPS branch instruction
     const RelOpMapping* mapping = RELOP_MAP;
-    while (mapping->relop != NULL) {
-        if (strcmp(relop, mapping->relop) == 0) {
-            fprintf(file, "\t%s %s, %s, label%d\n",
-                mapping->mipsInstr,
-                mipsRegisters[op1Index].regName,
-                mipsRegisters[op2Index].regName,
-                labelNo);
-            break;
-        }
+    while (mapping->relop != NULL && strcmp(relop, mapping->relop) != 0) {
         mapping++;
     }
-
     if (mapping->relop == NULL) {
         MIPS_DEBUG_PRINT("Error: Unknown relational operator: %s", relop);
+        return;
     }
 
-    // Free registers
-    mipsRegisters[op1Index].isOccupied = 0;
-    mipsRegisters[op2Index].isOccupied = 0;
+    if (op1->kind == CONSTANT_OP && op2->kind == CONSTANT_OP) {
+        // Decided at compile time: an unconditional jump or nothing
+        if (evaluateMipsRelop(op1->value, relop, op2->value)) {
+            emitMipsInstr(emitter, "j", "l", "label", labelNo);
+        }
+        return;
+    }
+
+    // Keep a constant operand on the right
+    if (op1->kind == CONSTANT_OP) {
+        Operand tmp = op1;
+        op1 = op2;
+        op2 = tmp;
+        const char *swapped = mapping->swapped;
+        mapping = RELOP_MAP;
+        while (strcmp(mapping->relop, swapped) != 0) {
+            mapping++;
+        }
+    }
+
+    int op1Index = allocateMipsRegister(op1, emitter);
+    if (op2->kind == CONSTANT_OP && op2->value == 0) {
+        // Compare against zero with the branch-on-sign family
+        emitMipsInstr(emitter, mapping->zeroInstr, "rl", mipsRegisters[op1Index].regName, "label", labelNo);
+        freeMipsScratchRegisters();
+        return;
+    }
+
+    if (op2->kind == CONSTANT_OP && mapping->relop[0] != '=' && mapping->relop[0] != '!') {
+        // x < k and x >= k test slti x, k; x <= k and x > k test slti x, k + 1
+        bool inclusive = strcmp(mapping->relop, "<=") == 0 || strcmp(mapping->relop, ">") == 0;
+        long long bound = (long long)op2->value + (inclusive ? 1 : 0);
+        if (isMipsImmediate(bound)) {
+            bool whenLess = strcmp(mapping->relop, "<") == 0 || strcmp(mapping->relop, "<=") == 0;
+            int flagIndex = allocateMipsScratchRegister();
+            emitMipsInstr(emitter, "slti", "rri",
+                mipsRegisters[flagIndex].regName, mipsRegisters[op1Index].regName, (int)bound);
+            emitMipsInstr(emitter, whenLess ? "bnez" : "beqz", "rl",
+                mipsRegisters[flagIndex].regName, "label", labelNo);
+            freeMipsScratchRegisters();
+            return;
+        }
+    }
+
+    int op2Index = allocateMipsRegister(op2, emitter);
     
-    MIPS_DEBUG_PRINT("Released registers %s and %s",
+    MIPS_DEBUG_PRINT("Condition: %s %s %s, jumping to label%d",
         mipsRegisters[op1Index].regName,
-        mipsRegisters[op2Index].regName);
+        mapping->relop,
+        mipsRegisters[op2Index].regName,
+        labelNo);
+
+    emitMipsInstr(emitter, mapping->mipsInstr, "rrl",
+        mipsRegisters[op1Index].regName, mipsRegisters[op2Index].regName, "label", labelNo);
+
+    // Free registers
+    freeMipsScratchRegisters();
+}
+
+/* Restore callee-saved registers, $ra, $fp and $sp of the current frame */
+static void generateFunctionEpilogue(MipsEmitter emitter)
+{
+    if (currentFrameless) {
+        return;
+    }
+
+    for (int i = SAVED_REG_START; i <= SAVED_REG_END; i++) {
+        if (isMipsSavedRegisterUsed(i)) {
+            emitMipsInstr(emitter, "lw", "rm", mipsRegisters[i].regName, savedRegOffsets[i], "$fp");
+        }
+    }
+
+    emitMipsInstr(emitter, "lw", "rm", "$ra", 4, "$fp");
+    emitMipsInstr(emitter, "addi", "rri", "$sp", "$fp", 8);
+    emitMipsInstr(emitter, "lw", "rm", "$fp", 0, "$fp");
+}
+
+/* x := CALL f directly followed by RETURN x, with every argument in $a0-$a3: the callee can reuse this frame */
+static bool isMipsTailCall(InterCodes callInterCodes)
+{
+    if (callInterCodes->code.kind != CALL_InterCode || callInterCodes->next->code.kind != RETURN_InterCode) {
+        return false;
+    }
+    Operand result = callInterCodes->code.u.doubleOP.left;
+    Operand returned = callInterCodes->next->code.u.singleOP.op;
+    if (result->kind != returned->kind || result->var_no != returned->var_no ||
+        result->type != VAL || returned->type != VAL) {
+        return false;
+    }
+    int argCount = 0;
+    for (InterCodes arg = callInterCodes->prev; arg->code.kind == ARG_InterCode; arg = arg->prev) {
+        argCount++;
+    }
+    return argCount <= ARG_REG_COUNT;
 }
 
 /* Generate function return code */
-void generateMipsReturn(InterCodes curInterCodes, FILE *file)
+void generateMipsReturn(InterCodes curInterCodes, MipsEmitter emitter)
 {
     MIPS_DEBUG_PRINT("Generating return statement");
 
-    // Restore return address and frame pointer
-    fprintf(file, "\tlw $ra, 4($fp)\n");
-    fprintf(file, "\taddi $sp, $fp, 8\n");
-    
-    // Load return value into $v0
-    int returnValueReg = allocateMipsRegister(curInterCodes->code.u.singleOP.op, file);
-    MIPS_DEBUG_PRINT("Return value loaded into %s", mipsRegisters[returnValueReg].regName);
-    
-    // Restore frame pointer and set return value
-    fprintf(file, "\tlw $fp, 0($fp)\n");
-    fprintf(file, "\tmove $v0, %s\n", mipsRegisters[returnValueReg].regName);
+    // A tail call already left through the callee, nothing jumps to this RETURN
+    if (isMipsTailCall(curInterCodes->prev)) {
+        return;
+    }
+
+    // Load return value into $v0 before any register is restored
+    loadMipsOperandToRegister(curInterCodes->code.u.singleOP.op, 2, emitter);
+
+    generateFunctionEpilogue(emitter);
     
     // Return from function
-    fprintf(file, "\tjr $ra\n");
+    emitMipsInstr(emitter, "jr", "r", "$ra");
     
-    // Free all temporary registers
-    for (int i = TEMP_REG_START; i <= TEMP_REG_END; i++) {
-        if (mipsRegisters[i].isOccupied) {
-            mipsRegisters[i].isOccupied = 0;
-            MIPS_DEBUG_PRINT("Freed temporary register %s", mipsRegisters[i].regName);
-        }
-    }
+    freeMipsScratchRegisters();
     
     MIPS_DEBUG_PRINT("Function return completed");
 }
 
 /* Helper functions for stack operations */
-void pushMipsStack(FILE *file, const char* reg) {
-    fprintf(file, "\taddi $sp, $sp, -4\n");
-    fprintf(file, "\tsw %s, 0($sp)\n", reg);
+void pushMipsStack(MipsEmitter emitter, const char* reg) {
+    emitMipsInstr(emitter, "addi", "rri", "$sp", "$sp", -4);
+    emitMipsInstr(emitter, "sw", "rm", reg, 0, "$sp");
     MIPS_DEBUG_PRINT("Push %s to stack", reg);
 }
 
-void popMipsStack(FILE *file, const char* reg) {
-    fprintf(file, "\tlw %s, 0($sp)\n", reg);
-    fprintf(file, "\taddi $sp, $sp, 4\n");
+void popMipsStack(MipsEmitter emitter, const char* reg) {
+    emitMipsInstr(emitter, "lw", "rm", reg, 0, "$sp");
+    emitMipsInstr(emitter, "addi", "rri", "$sp", "$sp", 4);
     MIPS_DEBUG_PRINT("Pop %s from stack", reg);
 }
 
 /* Function call related code generation */
-void generateMipsArg(InterCodes curInterCodes, FILE *file)
+void generateMipsArg(InterCodes curInterCodes, MipsEmitter emitter)
 {
     MIPS_DEBUG_PRINT("Generating code for function arguments");
     
+    // ARG codes list the arguments from last to first
     int argCount = 0;
-    // Handle argument pushing
-    while (curInterCodes && curInterCodes->code.kind == ARG_InterCode)
-    {
+    InterCodes callInterCodes = curInterCodes;
+    while (callInterCodes && callInterCodes->code.kind == ARG_InterCode) {
         argCount++;
-        MIPS_DEBUG_PRINT("Processing argument %d", argCount);
-        
-        // Get register for argument
-        int argReg = allocateMipsRegister(curInterCodes->code.u.singleOP.op, file);
-        pushMipsStack(file, mipsRegisters[argReg].regName);
-        
-        // Free the register
-        mipsRegisters[argReg].isOccupied = 0;
-        curInterCodes = curInterCodes->next;
+        callInterCodes = callInterCodes->next;
     }
 
-    // Now curInterCodes points to the CALL instruction
-    if (!curInterCodes || curInterCodes->code.kind != CALL_InterCode) {
+    // Now callInterCodes points to the CALL instruction
+    if (!callInterCodes || callInterCodes->code.kind != CALL_InterCode) {
         MIPS_DEBUG_PRINT("Error: Expected CALL instruction after ARG");
         return;
     }
 
+    Operand *args = (Operand *)malloc(argCount * sizeof(Operand));
+    for (int i = argCount - 1; i >= 0; i--) {
+        args[i] = curInterCodes->code.u.singleOP.op;
+        curInterCodes = curInterCodes->next;
+    }
+
+    // Arguments beyond the fourth go to the stack with a single $sp adjustment
+    int stackBytes = argCount > ARG_REG_COUNT ? (argCount - ARG_REG_COUNT) * 4 : 0;
+    if (stackBytes > 0) {
+        emitMipsInstr(emitter, "addi", "rri", "$sp", "$sp", -stackBytes);
+        for (int i = ARG_REG_COUNT; i < argCount; i++) {
+            int argReg = allocateMipsRegister(args[i], emitter);
+            emitMipsInstr(emitter, "sw", "rm", mipsRegisters[argReg].regName, (i - ARG_REG_COUNT) * 4, "$sp");
+            freeMipsScratchRegisters();
+        }
+    }
+
+    // Register-resident arguments are copied in parallel since they may already sit in $a0-$a3
+    int dests[ARG_REG_COUNT], srcs[ARG_REG_COUNT];
+    bool derefs[ARG_REG_COUNT];
+    bool copied[ARG_REG_COUNT] = {false};
+    int moveCount = 0;
+    for (int i = 0; i < argCount && i < ARG_REG_COUNT; i++) {
+        int srcReg = getMipsAssignedRegister(args[i]);
+        if (srcReg >= 0) {
+            dests[moveCount] = ARG_REG_START + i;
+            srcs[moveCount] = srcReg;
+            derefs[moveCount] = args[i]->type == ADDRESS;
+            moveCount++;
+            copied[i] = true;
+        }
+    }
+    emitMipsParallelMoves(dests, srcs, derefs, moveCount, emitter);
+
+    // Constants, addresses and stack values do not read any argument register
+    for (int i = 0; i < argCount && i < ARG_REG_COUNT; i++) {
+        if (!copied[i]) {
+            loadMipsOperandToRegister(args[i], ARG_REG_START + i, emitter);
+        }
+    }
+    free(args);
+
     // Get function call information
-    Operand resultOp = curInterCodes->code.u.doubleOP.left;   // Return value destination
-    Operand funcOp = curInterCodes->code.u.doubleOP.right;    // Function name
+    Operand resultOp = callInterCodes->code.u.doubleOP.left;   // Return value destination
+    Operand funcOp = callInterCodes->code.u.doubleOP.right;    // Function name
+
+    // Tail call: pop this frame and jump, the callee returns straight to our caller
+    if (isMipsTailCall(callInterCodes)) {
+        MIPS_DEBUG_PRINT("Tail calling function: %s", funcOp->funcName);
+        generateFunctionEpilogue(emitter);
+        emitMipsInstr(emitter, "j", "r", funcOp->funcName);
+        return;
+    }
 
     // Call the function
     MIPS_DEBUG_PRINT("Calling function: %s", funcOp->funcName);
-    fprintf(file, "\tjal %s\n", funcOp->funcName);
+    emitMipsInstr(emitter, "jal", "r", funcOp->funcName);
 
     // Restore stack pointer
-    if (argCount > 0) {
-        fprintf(file, "\taddi $sp, $sp, %d\n", argCount * 4);
-        MIPS_DEBUG_PRINT("Restored stack pointer, removed %d arguments", argCount);
+    if (stackBytes > 0) {
+        emitMipsInstr(emitter, "addi", "rri", "$sp", "$sp", stackBytes);
+        MIPS_DEBUG_PRINT("Restored stack pointer, removed %d stack arguments", argCount - ARG_REG_COUNT);
     }
 
     // Store return value
-    int resultReg = allocateMipsRegister(resultOp, file);
-    fprintf(file, "\tmove %s, $v0\n", mipsRegisters[resultReg].regName);
-    storeMipsRegisterToStack(resultReg, file);
-    MIPS_DEBUG_PRINT("Stored return value in %s", mipsRegisters[resultReg].regName);
+    storeMipsOperandFromRegister(resultOp, 2, emitter);
+    MIPS_DEBUG_PRINT("Stored return value of %s", funcOp->funcName);
 }
 
 /* I/O related code generation */
-void generateMipsRead(InterCodes curInterCodes, FILE *file)
+
+/* Print string syscall, the newline alone uses _ret from the prelude */
+static void emitMipsPrintString(const char *text, MipsEmitter emitter)
+{
+    if (!text[0]) {
+        return;
+    }
+    emitMipsInstr(emitter, "li", "ri", "$v0", 4);
+    if (strcmp(text, "\n") == 0) {
+        emitMipsInstr(emitter, "la", "rr", "$a0", "_ret");
+    } else {
+        emitMipsInstr(emitter, "la", "rl", "$a0", "_str", addMipsString(emitter, text));
+    }
+    emitMipsInstr(emitter, "syscall", "");
+}
+
+void generateMipsRead(InterCodes curInterCodes, MipsEmitter emitter)
 {
     MIPS_DEBUG_PRINT("Generating code for read operation");
 
-    // Save return address
-    pushMipsStack(file, "$ra");
-    
-    // Call read function
-    fprintf(file, "\tjal read\n");
-    MIPS_DEBUG_PRINT("Called read function");
-    
-    // Restore return address
-    popMipsStack(file, "$ra");
+    // The prompt is empty, only the read_int syscall is needed
+    emitMipsInstr(emitter, "li", "ri", "$v0", 5);
+    emitMipsInstr(emitter, "syscall", "");
 
     // Store result
-    int resultReg = allocateMipsRegister(curInterCodes->code.u.singleOP.op, file);
-    fprintf(file, "\tmove %s, $v0\n", mipsRegisters[resultReg].regName);
-    storeMipsRegisterToStack(resultReg, file);
+    storeMipsOperandFromRegister(curInterCodes->code.u.singleOP.op, 2, emitter);
     
-    MIPS_DEBUG_PRINT("Stored read result in %s", mipsRegisters[resultReg].regName);
+    MIPS_DEBUG_PRINT("Stored read result");
 }
 
-void generateMipsWrite(InterCodes curInterCodes, FILE *file)
+InterCodes generateMipsWrite(InterCodes curInterCodes, MipsEmitter emitter)
 {
     MIPS_DEBUG_PRINT("Generating code for write operation");
 
-    // Load value to print
-    int valueReg = allocateMipsRegister(curInterCodes->code.u.singleOP.op, file);
-    fprintf(file, "\tmove $a0, %s\n", mipsRegisters[valueReg].regName);
-    MIPS_DEBUG_PRINT("Loaded value to print from %s", mipsRegisters[valueReg].regName);
+    // Constants and newlines of consecutive writes are collected into one print string syscall
+    char pending[MIPS_MAX_WRITE_STRING + 16];
+    int length = 0;
+    InterCodes last = curInterCodes;
+    for (InterCodes cur = curInterCodes; cur != interCodeListHead && cur->code.kind == WRITE_InterCode; cur = cur->next) {
+        Operand op = cur->code.u.singleOP.op;
+        last = cur;
+        if (op->kind == CONSTANT_OP) {
+            length += snprintf(pending + length, sizeof(pending) - length, "%d\n", op->value);
+        } else {
+            pending[length] = '\0';
+            emitMipsPrintString(pending, emitter);
 
-    // Save return address
-    pushMipsStack(file, "$ra");
-    
-    // Call write function
-    fprintf(file, "\tjal write\n");
-    MIPS_DEBUG_PRINT("Called write function");
-    
-    // Restore return address
-    popMipsStack(file, "$ra");
-
-    // Free all temporary registers
-    for (int i = TEMP_REG_START; i <= TEMP_REG_END; i++) {
-        if (mipsRegisters[i].isOccupied) {
-            mipsRegisters[i].isOccupied = 0;
-            MIPS_DEBUG_PRINT("Freed temporary register %s", mipsRegisters[i].regName);
+            loadMipsOperandToRegister(op, 4, emitter);
+            MIPS_DEBUG_PRINT("Loaded value to print into $a0");
+            emitMipsInstr(emitter, "li", "ri", "$v0", 1);
+            emitMipsInstr(emitter, "syscall", "");
+            freeMipsScratchRegisters();
+            length = snprintf(pending, sizeof(pending), "\n");
+        }
+        if (length >= MIPS_MAX_WRITE_STRING) {
+            break;
         }
     }
-}
\ No newline at end of file
+    pending[length] = '\0';
+    emitMipsPrintString(pending, emitter);
+
+    return last;
+}
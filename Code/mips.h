@@ -14,13 +14,18 @@
 // Register management constants
 #define TEMP_REG_START 8
 #define TEMP_REG_END 15
+#define SCRATCH_REG_START 2             // $v0/$v1 hold spilled values and constants
+#define SCRATCH_REG_END 3
 #define MAX_NAME_LENGTH 32
+#define MIPS_MAX_WRITE_STRING 256       // Longest string a run of constant writes is coalesced into
 
 // External declarations
 extern InterCodes interCodeListHead;
+extern char *mipsRegNames[32];
 
 // Type definitions
 typedef struct MipsRegisterAllocation_ *MipsRegisterAllocation;
+typedef struct MipsEmitter_ *MipsEmitter;
 
 // Register structure definition
 typedef struct MipsRegister {
@@ -31,45 +36,51 @@ typedef struct MipsRegister {
 
 // Variable allocation structure definition
 typedef struct MipsRegisterAllocation_ {
-    char name[MAX_NAME_LENGTH];         // Variable name
-    int regNum;                         // Register number
+    int kind;                           // VARIABLE_OP or TEMP_OP
+    int varNo;                          // Operand var_no, index into the slot tables
+    int regNum;                         // Register number, -1 if the value lives on the stack
     int stackOffset;                    // Stack frame offset
-    MipsRegisterAllocation next;        // Next allocation in list
+    MipsRegisterAllocation next;        // Next allocation of the current function
 } MipsRegisterAllocation_;
 
 // Register management functions
 void initMipsRegisters(void);
-int allocateMipsRegister(Operand op, FILE *file);
-void storeMipsRegisterToStack(int regIndex, FILE *file);
+int allocateMipsRegister(Operand op, MipsEmitter emitter);
+int allocateMipsResultRegister(Operand op);
+void loadMipsOperandToRegister(Operand op, int regIndex, MipsEmitter emitter);
+void storeMipsRegisterToStack(int regIndex, MipsEmitter emitter);
+void freeMipsScratchRegisters(void);
 MipsRegisterAllocation getMipsVarAllocation(Operand op);
 void createMipsVarAllocation(Operand op);
+void clearMipsVarAllocations(void);
 
 // Stack operation helpers
-void pushMipsStack(FILE *file, const char* reg);
-void popMipsStack(FILE *file, const char* reg);
+void pushMipsStack(MipsEmitter emitter, const char* reg);
+void popMipsStack(MipsEmitter emitter, const char* reg);
 
 // Main code generation function
 void generateMipsCode(FILE *file);
 
 // Instruction-specific code generation functions
-void generateMipsFunction(InterCodes curInterCodes, FILE *file);
-void generateMipsAssignment(InterCodes curInterCodes, FILE *file);
-void generateMipsArithmetic(char *opType, InterCodes curInterCodes, FILE *file);
-void generateMipsAdd(InterCodes curInterCodes, FILE *file);
-void generateMipsSub(InterCodes curInterCodes, FILE *file);
-void generateMipsMul(InterCodes curInterCodes, FILE *file);
-void generateMipsDiv(InterCodes curInterCodes, FILE *file);
+void generateMipsFunction(InterCodes curInterCodes, MipsEmitter emitter);
+void generateMipsAssignment(InterCodes curInterCodes, MipsEmitter emitter);
+void generateMipsArithmetic(char *opType, InterCodes curInterCodes, MipsEmitter emitter);
+void generateMipsAdd(InterCodes curInterCodes, MipsEmitter emitter);
+void generateMipsSub(InterCodes curInterCodes, MipsEmitter emitter);
+void generateMipsMul(InterCodes curInterCodes, MipsEmitter emitter);
+void generateMipsDiv(InterCodes curInterCodes, MipsEmitter emitter);
 
 // Control flow code generation
-void generateMipsGoto(InterCodes curInterCodes, FILE *file);
-void generateMipsIfGoto(InterCodes curInterCodes, FILE *file);
-void generateMipsReturn(InterCodes curInterCodes, FILE *file);
+void generateMipsGoto(InterCodes curInterCodes, MipsEmitter emitter);
+void generateMipsIfGoto(InterCodes curInterCodes, MipsEmitter emitter);
+void generateMipsReturn(InterCodes curInterCodes, MipsEmitter emitter);
 
 // Function call related code generation
-void generateMipsArg(InterCodes curInterCodes, FILE *file);
+void generateMipsArg(InterCodes curInterCodes, MipsEmitter emitter);
 
 // I/O related code generation
-void generateMipsRead(InterCodes curInterCodes, FILE *file);
-void generateMipsWrite(InterCodes curInterCodes, FILE *file);
+void generateMipsRead(InterCodes curInterCodes, MipsEmitter emitter);
+// Generates the run of consecutive WRITE codes starting here and returns the last one
+InterCodes generateMipsWrite(InterCodes curInterCodes, MipsEmitter emitter);
 
 #endif // __OBJECT_CODE_H__
\ No newline at end of file
@@ -0,0 +1,1071 @@
+#include "optimize.h"
+#include "ssa.h"
+#include "constprop.h"
+#include "gvn.h"
+#include "licm.h"
+#include "layout.h"
+#include "dce.h"
+#include "inliner.h"
+
+/* 每个变量/临时变量在当前函数中的统计信息，变量和临时变量分别按 var_no 编号 */
+typedef struct IRValueInfo {
+    int defs;            // 函数内定值次数
+    int uses;            // 函数内使用次数
+    int loopDefs;        // 当前循环内定值次数
+    bool addrTaken;      // 出现过 &v
+    bool isBiv;          // 当前循环的基本归纳变量
+    bool affine;         // 临时变量当前等于 a * iv + b
+    int iv, a, b;
+} IRValueInfo;
+
+/* 循环中引入的归纳变量 temp = base + a * iv + b */
+typedef struct IRInductionVar {
+    Operand ivOp;        // 基本归纳变量
+    int a, b;
+    Operand base;        // 循环不变的基址，NULL表示没有
+    Operand temp;
+} IRInductionVar;
+
+/* 基本归纳变量的一次自增 iv := iv + step */
+typedef struct IRIncrement {
+    int index;           // 自增代码在 codes 中的下标
+    Operand ivOp;
+    int step;
+} IRIncrement;
+
+/* 可以改写的代码：仿射临时变量的定值，或者 base + 仿射临时变量 的地址计算 */
+typedef struct IRCandidate {
+    int index;
+    bool isAddress;
+    int iv, a, b;
+    Operand base;        // 地址计算的基址
+    Operand offset;      // 地址计算中的仿射临时变量
+} IRCandidate;
+
+/* 当前函数的代码数组，删除的代码置为NULL；改写过的循环重新追加在末尾，原来的位置不再使用 */
+static InterCodes *codes = NULL;
+static int codeCount = 0;
+static int codeCapacity = 0;
+
+/* 标号所在位置以及最后一条跳回该标号的代码位置 */
+static int *labelPos = NULL;
+static int *lastBackEdge = NULL;
+static int *labelJumps = NULL;         // 跳转到标号的代码条数
+static int labelTableSize = 0;
+
+static IRValueInfo *valueInfo[2] = {NULL, NULL};
+static int valueInfoSize[2] = {0, 0};
+
+/* 当前基本块中有效的仿射临时变量 */
+static int *affineTemps = NULL;
+static int affineTempCount = 0;
+
+/* ir_get_value_info 获取变量或临时变量的统计信息，必要时扩充表 */
+static IRValueInfo *ir_get_value_info(Operand op)
+{
+    int table = op->kind == TEMP_OP ? 1 : 0;
+    if (op->var_no >= valueInfoSize[table]) {
+        int newSize = valueInfoSize[table] ? valueInfoSize[table] : 64;
+        while (newSize <= op->var_no) {
+            newSize *= 2;
+        }
+        valueInfo[table] = (IRValueInfo *)realloc(valueInfo[table], newSize * sizeof(IRValueInfo));
+        memset(valueInfo[table] + valueInfoSize[table], 0,
+               (newSize - valueInfoSize[table]) * sizeof(IRValueInfo));
+        valueInfoSize[table] = newSize;
+    }
+    return &valueInfo[table][op->var_no];
+}
+
+/* ir_same_value 两个操作数是否读取同一个变量或临时变量的值 */
+static bool ir_same_value(Operand x, Operand y)
+{
+    return x && y && x->kind == y->kind && (x->kind == VARIABLE_OP || x->kind == TEMP_OP) &&
+           x->type == VAL && y->type == VAL && x->var_no == y->var_no;
+}
+
+static bool ir_is_value(Operand op)
+{
+    return op && (op->kind == VARIABLE_OP || op->kind == TEMP_OP) && op->type == VAL;
+}
+
+Operand ir_get_def_operand(InterCodes code)
+{
+    Operand def = NULL;
+    switch (code->code.kind) {
+        case ASSIGN_InterCode:
+            // *t := y 写的是内存
+            if (!(code->code.u.doubleOP.left->kind == TEMP_OP && code->code.u.doubleOP.left->type == ADDRESS)) {
+                def = code->code.u.doubleOP.left;
+            }
+            break;
+        case GET_ADDR_InterCode:
+        case GET_CONTENT_InterCode:
+        case CALL_InterCode:
+            def = code->code.u.doubleOP.left;
+            break;
+        case ADD_InterCode:
+        case SUB_InterCode:
+        case MUL_InterCode:
+        case DIV_InterCode:
+            def = code->code.u.tripleOP.result;
+            break;
+        case READ_InterCode:
+            if (!(code->code.u.singleOP.op->kind == TEMP_OP && code->code.u.singleOP.op->type == ADDRESS)) {
+                def = code->code.u.singleOP.op;
+            }
+            break;
+        case PARAM_InterCode:
+            def = code->code.u.singleOP.op;
+            break;
+        case PHI_InterCode:
+            def = code->code.u.phiOP.result;
+            break;
+        default:
+            break;
+    }
+    if (def && def->kind != VARIABLE_OP && def->kind != TEMP_OP) {
+        return NULL;
+    }
+    return def;
+}
+
+int ir_get_use_operands(InterCodes code, Operand *uses[3])
+{
+    int count = 0;
+    switch (code->code.kind) {
+        case ASSIGN_InterCode:
+            if (code->code.u.doubleOP.left->kind == TEMP_OP && code->code.u.doubleOP.left->type == ADDRESS) {
+                uses[count++] = &code->code.u.doubleOP.left;
+            }
+            uses[count++] = &code->code.u.doubleOP.right;
+            break;
+        case GET_ADDR_InterCode:
+        case GET_CONTENT_InterCode:
+            uses[count++] = &code->code.u.doubleOP.right;
+            break;
+        case TO_ADDR_InterCode:
+            uses[count++] = &code->code.u.doubleOP.left;
+            uses[count++] = &code->code.u.doubleOP.right;
+            break;
+        case ADD_InterCode:
+        case SUB_InterCode:
+        case MUL_InterCode:
+        case DIV_InterCode:
+            uses[count++] = &code->code.u.tripleOP.op1;
+            uses[count++] = &code->code.u.tripleOP.op2;
+            break;
+        case IFGOTO_InterCode:
+            uses[count++] = &code->code.u.ifgotoOP.op1;
+            uses[count++] = &code->code.u.ifgotoOP.op2;
+            break;
+        case RETURN_InterCode:
+        case ARG_InterCode:
+        case WRITE_InterCode:
+            uses[count++] = &code->code.u.singleOP.op;
+            break;
+        case READ_InterCode:
+            // READ *t 读取指针t
+            if (code->code.u.singleOP.op->kind == TEMP_OP && code->code.u.singleOP.op->type == ADDRESS) {
+                uses[count++] = &code->code.u.singleOP.op;
+            }
+            break;
+        default:
+            break;
+    }
+
+    // 只保留变量和临时变量
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        Operand op = *uses[i];
+        if (op && (op->kind == VARIABLE_OP || op->kind == TEMP_OP)) {
+            uses[kept++] = uses[i];
+        }
+    }
+    return kept;
+}
+
+InterCodes ir_insert_code_before(InterCodes position, int kind)
+{
+    InterCodes code = (InterCodes)malloc(sizeof(struct InterCodes_));
+    if (!code) {
+        IR_DEBUG(IR_DEBUG_ERROR, "内存分配失败，无法插入中间代码\n");
+        return NULL;
+    }
+    memset(code, 0, sizeof(struct InterCodes_));
+    code->code.kind = kind;
+    code->prev = position->prev;
+    code->next = position;
+    position->prev->next = code;
+    position->prev = code;
+    if (position == interCodeListHead) {
+        interCodeListTail = code;
+    }
+    return code;
+}
+
+InterCodes ir_copy_code_before(InterCodes code, InterCodes position)
+{
+    InterCodes copy = ir_insert_code_before(position, code->code.kind);
+    copy->code = code->code;
+    switch (code->code.kind) {
+        case ASSIGN_InterCode:
+        case GET_ADDR_InterCode:
+        case GET_CONTENT_InterCode:
+        case TO_ADDR_InterCode:
+        case CALL_InterCode:
+        case DEC_InterCode:
+            copy->code.u.doubleOP.left = ir_duplicate_operand(code->code.u.doubleOP.left);
+            copy->code.u.doubleOP.right = ir_duplicate_operand(code->code.u.doubleOP.right);
+            break;
+        case ADD_InterCode:
+        case SUB_InterCode:
+        case MUL_InterCode:
+        case DIV_InterCode:
+            copy->code.u.tripleOP.result = ir_duplicate_operand(code->code.u.tripleOP.result);
+            copy->code.u.tripleOP.op1 = ir_duplicate_operand(code->code.u.tripleOP.op1);
+            copy->code.u.tripleOP.op2 = ir_duplicate_operand(code->code.u.tripleOP.op2);
+            break;
+        case IFGOTO_InterCode:
+            copy->code.u.ifgotoOP.op1 = ir_duplicate_operand(code->code.u.ifgotoOP.op1);
+            copy->code.u.ifgotoOP.op2 = ir_duplicate_operand(code->code.u.ifgotoOP.op2);
+            copy->code.u.ifgotoOP.label = ir_duplicate_operand(code->code.u.ifgotoOP.label);
+            break;
+        default:
+            copy->code.u.singleOP.op = ir_duplicate_operand(code->code.u.singleOP.op);
+            break;
+    }
+    return copy;
+}
+
+void ir_move_code_before(InterCodes code, InterCodes position)
+{
+    if (code == position || code->next == position) {
+        return;
+    }
+    code->prev->next = code->next;
+    code->next->prev = code->prev;
+    if (code == interCodeListTail) {
+        interCodeListTail = code->prev;
+    }
+    code->prev = position->prev;
+    code->next = position;
+    position->prev->next = code;
+    position->prev = code;
+    if (position == interCodeListHead) {
+        interCodeListTail = code;
+    }
+}
+
+void ir_remove_code(InterCodes code)
+{
+    code->prev->next = code->next;
+    code->next->prev = code->prev;
+    if (code == interCodeListTail) {
+        interCodeListTail = code->prev;
+    }
+    free(code);
+}
+
+Operand ir_new_temp(void)
+{
+    Operand temp = ir_create_operand(TEMP_OP, VAL);
+    temp->value = 0;
+    temp->varName = NULL;
+    temp->funcName = NULL;
+    temp->depth = 0;
+    return temp;
+}
+
+Operand ir_new_label(void)
+{
+    Operand label = ir_create_operand(LABEL_OP, VAL);
+    label->value = 0;
+    label->varName = NULL;
+    label->funcName = NULL;
+    label->depth = 0;
+    return label;
+}
+
+/* ir_ensure_label_tables 保证标号表能容纳目前所有的标号 */
+static void ir_ensure_label_tables(void)
+{
+    if (labelNo <= labelTableSize) {
+        return;
+    }
+    labelPos = (int *)realloc(labelPos, labelNo * sizeof(int));
+    lastBackEdge = (int *)realloc(lastBackEdge, labelNo * sizeof(int));
+    labelJumps = (int *)realloc(labelJumps, labelNo * sizeof(int));
+    for (int i = labelTableSize; i < labelNo; i++) {
+        labelPos[i] = -1;
+        lastBackEdge[i] = -1;
+        labelJumps[i] = 0;
+    }
+    labelTableSize = labelNo;
+}
+
+/* ir_append_code 把代码追加到代码数组末尾，返回它的下标 */
+static int ir_append_code(InterCodes code)
+{
+    if (codeCount == codeCapacity) {
+        codeCapacity = codeCapacity ? codeCapacity * 2 : 256;
+        codes = (InterCodes *)realloc(codes, codeCapacity * sizeof(InterCodes));
+    }
+    codes[codeCount] = code;
+    return codeCount++;
+}
+
+/* ir_count_code 把代码中的定值和使用计入（sign 为1）或移出（sign 为-1）统计 */
+static void ir_count_code(InterCodes code, int sign)
+{
+    Operand *uses[3];
+    int useCount = ir_get_use_operands(code, uses);
+    for (int k = 0; k < useCount; k++) {
+        Operand op = *uses[k];
+        if (op->kind != VARIABLE_OP && op->kind != TEMP_OP) {
+            continue;
+        }
+        IRValueInfo *info = ir_get_value_info(op);
+        info->uses += sign;
+        if (sign > 0 && op->kind == VARIABLE_OP && op->type == ADDRESS) {
+            info->addrTaken = true;
+        }
+    }
+    Operand def = ir_get_def_operand(code);
+    if (def) {
+        ir_get_value_info(def)->defs += sign;
+    }
+}
+
+/* ir_scan_function 收集函数的代码数组，统计每个值的定值、使用次数以及标号和回边位置 */
+static void ir_scan_function(InterCodes funcHead)
+{
+    ir_ensure_label_tables();
+    codeCount = 0;
+    for (InterCodes cur = funcHead->next; cur != interCodeListHead && cur->code.kind != FUNC_InterCode;
+         cur = cur->next) {
+        ir_append_code(cur);
+
+        // 先清空本函数用到的表项
+        Operand *uses[3];
+        int useCount = ir_get_use_operands(cur, uses);
+        for (int k = 0; k < useCount; k++) {
+            memset(ir_get_value_info(*uses[k]), 0, sizeof(IRValueInfo));
+        }
+        Operand def = ir_get_def_operand(cur);
+        if (def) {
+            memset(ir_get_value_info(def), 0, sizeof(IRValueInfo));
+        }
+        int label = ir_get_label_no(cur);
+        if (label >= 0) {
+            labelPos[label] = -1;
+            lastBackEdge[label] = -1;
+            labelJumps[label] = 0;
+        }
+    }
+
+    for (int i = 0; i < codeCount; i++) {
+        ir_count_code(codes[i], 1);
+
+        int label = ir_get_label_no(codes[i]);
+        if (label >= 0) {
+            labelPos[label] = i;
+        }
+        int target = ir_get_jump_target(codes[i]);
+        if (target >= 0) {
+            labelJumps[target]++;
+            if (labelPos[target] >= 0 && labelPos[target] < i) {
+                lastBackEdge[target] = i;
+            }
+        }
+    }
+}
+
+/*
+ * ir_rescan_loop 循环改写后，把 before 之后直到 last 的代码（含新插入的初始化代码）重新追加到代码数组末尾，
+ * 并更新其中标号和回边的位置；定值和使用次数已在改写时同步更新。之后处理的循环要么是这段代码中的内层循环，
+ * 要么与它不相交，它们的下标都仍然有效，因此不必重新扫描整个函数
+ */
+static void ir_rescan_loop(InterCodes before, InterCodes last)
+{
+    int start = codeCount;
+    for (InterCodes cur = before->next;; cur = cur->next) {
+        int i = ir_append_code(cur);
+        int label = ir_get_label_no(cur);
+        if (label >= 0) {
+            labelPos[label] = i;
+            lastBackEdge[label] = -1;
+        }
+        int target = ir_get_jump_target(cur);
+        if (target >= 0 && labelPos[target] >= start && labelPos[target] < i) {
+            lastBackEdge[target] = i;
+        }
+        if (cur == last) {
+            break;
+        }
+    }
+}
+
+/* ir_remove_scanned_code 删除代码数组中的一条代码 */
+static void ir_remove_scanned_code(int index)
+{
+    ir_remove_code(codes[index]);
+    codes[index] = NULL;
+}
+
+/* ir_match_step code 是否为 x := var + #k / var - #k，是则返回步长 */
+static bool ir_match_step(InterCodes code, Operand var, int *step)
+{
+    Operand op1 = code->code.u.tripleOP.op1;
+    Operand op2 = code->code.u.tripleOP.op2;
+    if (code->code.kind == ADD_InterCode) {
+        if (ir_same_value(op1, var) && op2->kind == CONSTANT_OP) {
+            *step = op2->value;
+            return true;
+        }
+        if (op1->kind == CONSTANT_OP && ir_same_value(op2, var)) {
+            *step = op1->value;
+            return true;
+        }
+    }
+    else if (code->code.kind == SUB_InterCode && ir_same_value(op1, var) && op2->kind == CONSTANT_OP) {
+        *step = (int)(0u - (unsigned int)op2->value);
+        return true;
+    }
+    return false;
+}
+
+/* ir_match_increment codes[index] 是否为变量的自增：v := v + #k，或 t := v + #k; v := t */
+static bool ir_match_increment(int index, int header, Operand var, int *step)
+{
+    InterCodes code = codes[index];
+    if (code->code.kind == ADD_InterCode || code->code.kind == SUB_InterCode) {
+        return ir_match_step(code, var, step);
+    }
+    if (code->code.kind != ASSIGN_InterCode || index - 1 <= header || !codes[index - 1]) {
+        return false;
+    }
+
+    Operand temp = code->code.u.doubleOP.right;
+    InterCodes prev = codes[index - 1];
+    if (temp->kind != TEMP_OP || temp->type != VAL ||
+        (prev->code.kind != ADD_InterCode && prev->code.kind != SUB_InterCode) ||
+        !ir_same_value(prev->code.u.tripleOP.result, temp)) {
+        return false;
+    }
+    IRValueInfo *info = ir_get_value_info(temp);
+    return info->defs == 1 && info->uses == 1 && ir_match_step(prev, var, step);
+}
+
+/* ir_get_affine 操作数当前是否可以表示为 a * iv + b */
+static bool ir_get_affine(Operand op, int *iv, int *a, int *b)
+{
+    if (!ir_is_value(op)) {
+        return false;
+    }
+    IRValueInfo *info = ir_get_value_info(op);
+    if (op->kind == VARIABLE_OP && info->isBiv) {
+        *iv = op->var_no;
+        *a = 1;
+        *b = 0;
+        return true;
+    }
+    if (op->kind == TEMP_OP && info->affine) {
+        *iv = info->iv;
+        *a = info->a;
+        *b = info->b;
+        return true;
+    }
+    return false;
+}
+
+/* ir_clear_affine 使基本块内记录的仿射关系失效，iv 为-1时全部失效 */
+static void ir_clear_affine(int iv)
+{
+    int kept = 0;
+    for (int i = 0; i < affineTempCount; i++) {
+        IRValueInfo *info = &valueInfo[1][affineTemps[i]];
+        if (iv < 0 || info->iv == iv) {
+            info->affine = false;
+        } else {
+            affineTemps[kept++] = affineTemps[i];
+        }
+    }
+    affineTempCount = kept;
+}
+
+/* ir_is_loop_invariant 操作数在循环内是否不变 */
+static bool ir_is_loop_invariant(Operand op)
+{
+    if (op->kind == VARIABLE_OP && op->type == ADDRESS) {
+        return true;
+    }
+    return ir_is_value(op) && ir_get_value_info(op)->loopDefs == 0;
+}
+
+/* ir_match_affine_def 计算 ADD/SUB/MUL 的结果是否为仿射表达式 */
+static bool ir_match_affine_def(InterCodes code, int *iv, int *a, int *b)
+{
+    Operand op1 = code->code.u.tripleOP.op1;
+    Operand op2 = code->code.u.tripleOP.op2;
+    int va, vb;
+    unsigned int c;
+    bool constRight;
+    if (ir_get_affine(op1, iv, &va, &vb) && op2->kind == CONSTANT_OP) {
+        c = (unsigned int)op2->value;
+        constRight = true;
+    } else if (op1->kind == CONSTANT_OP && ir_get_affine(op2, iv, &va, &vb)) {
+        c = (unsigned int)op1->value;
+        constRight = false;
+    } else {
+        return false;
+    }
+
+    // 按无符号数计算，溢出时与原代码一样回绕
+    switch (code->code.kind) {
+        case ADD_InterCode:
+            *a = va;
+            *b = (int)((unsigned int)vb + c);
+            break;
+        case SUB_InterCode:
+            *a = constRight ? va : (int)(0u - (unsigned int)va);
+            *b = constRight ? (int)((unsigned int)vb - c) : (int)(c - (unsigned int)vb);
+            break;
+        case MUL_InterCode:
+            *a = (int)((unsigned int)va * c);
+            *b = (int)((unsigned int)vb * c);
+            break;
+        default:
+            return false;
+    }
+    return *a != 0;
+}
+
+/* ir_find_induction_var 查找或创建归纳变量 base + a * iv + b，数量已满时返回-1 */
+static int ir_find_induction_var(IRInductionVar *vars, int *varCount, IRIncrement *incs, int incCount,
+                                 int iv, int a, int b, Operand base)
+{
+    for (int i = 0; i < *varCount; i++) {
+        IRInductionVar *var = &vars[i];
+        if (var->ivOp->var_no != iv || var->a != a || var->b != b) {
+            continue;
+        }
+        if ((!var->base && !base) || (var->base && base && var->base->kind == base->kind &&
+                                      var->base->type == base->type && var->base->var_no == base->var_no)) {
+            return i;
+        }
+    }
+    if (*varCount == IR_MAX_LOOP_INDUCTION_VARS) {
+        return -1;
+    }
+
+    IRInductionVar *var = &vars[*varCount];
+    var->ivOp = NULL;
+    for (int i = 0; i < incCount; i++) {
+        if (incs[i].ivOp->var_no == iv) {
+            var->ivOp = incs[i].ivOp;
+            break;
+        }
+    }
+    var->a = a;
+    var->b = b;
+    var->base = base;
+    var->temp = ir_new_temp();
+    return (*varCount)++;
+}
+
+/* ir_rewrite_as_copy 把 codes[index] 改写为 result := temp，同时更新使用次数 */
+static void ir_rewrite_as_copy(int index, Operand result, Operand temp)
+{
+    InterCodes code = codes[index];
+    ir_count_code(code, -1);
+    code->code.kind = ASSIGN_InterCode;
+    code->code.u.doubleOP.left = result;
+    code->code.u.doubleOP.right = ir_duplicate_operand(temp);
+    ir_count_code(code, 1);
+}
+
+/*
+ * ir_propagate_copy 把 y := temp 之后同一基本块内对 y 的读取直接替换为 temp，
+ * 直到 temp 随归纳变量更新为止；y 的读取全部被替换时删除这条复制
+ */
+static void ir_propagate_copy(int index, IRInductionVar *var)
+{
+    Operand copied = codes[index]->code.u.doubleOP.left;
+    IRValueInfo *info = ir_get_value_info(copied);
+    for (int i = index + 1; i < codeCount; i++) {
+        InterCodes code = codes[i];
+        if (!code) {
+            continue;
+        }
+        if (code->code.kind == LABEL_InterCode) {
+            break;
+        }
+
+        Operand *uses[3];
+        int useCount = ir_get_use_operands(code, uses);
+        for (int k = 0; k < useCount; k++) {
+            Operand op = *uses[k];
+            if (op->kind == TEMP_OP && op->var_no == copied->var_no) {
+                Operand replacement = ir_duplicate_operand(var->temp);
+                replacement->type = op->type;
+                *uses[k] = replacement;
+                info->uses--;
+                ir_get_value_info(var->temp)->uses++;
+            }
+        }
+
+        Operand def = ir_get_def_operand(code);
+        if (ir_get_jump_target(code) >= 0 || code->code.kind == RETURN_InterCode ||
+            (def && def->kind == VARIABLE_OP && def->var_no == var->ivOp->var_no)) {
+            break;
+        }
+    }
+
+    if (info->uses == 0) {
+        ir_count_code(codes[index], -1);
+        ir_remove_scanned_code(index);
+    }
+}
+
+/* ir_emit_induction_var_init 在循环头之前初始化 temp = base + a * iv + b */
+static void ir_emit_induction_var_init(InterCodes header, IRInductionVar *var)
+{
+    Operand current = ir_duplicate_operand(var->ivOp);
+    current->type = VAL;
+    InterCodes code;
+    if (var->a != 1) {
+        code = ir_insert_code_before(header, MUL_InterCode);
+        code->code.u.tripleOP.result = ir_duplicate_operand(var->temp);
+        code->code.u.tripleOP.op1 = current;
+        code->code.u.tripleOP.op2 = ir_create_operand(CONSTANT_OP, VAL, var->a);
+        ir_count_code(code, 1);
+        current = var->temp;
+    }
+    if (var->b != 0) {
+        code = ir_insert_code_before(header, ADD_InterCode);
+        code->code.u.tripleOP.result = ir_duplicate_operand(var->temp);
+        code->code.u.tripleOP.op1 = ir_duplicate_operand(current);
+        code->code.u.tripleOP.op2 = ir_create_operand(CONSTANT_OP, VAL, var->b);
+        ir_count_code(code, 1);
+        current = var->temp;
+    }
+    if (var->base) {
+        code = ir_insert_code_before(header, ADD_InterCode);
+        code->code.u.tripleOP.result = ir_duplicate_operand(var->temp);
+        code->code.u.tripleOP.op1 = ir_duplicate_operand(var->base);
+        code->code.u.tripleOP.op2 = ir_duplicate_operand(current);
+        ir_count_code(code, 1);
+        current = var->temp;
+    }
+    if (current != var->temp) {
+        code = ir_insert_code_before(header, ASSIGN_InterCode);
+        code->code.u.doubleOP.left = ir_duplicate_operand(var->temp);
+        code->code.u.doubleOP.right = current;
+        ir_count_code(code, 1);
+    }
+}
+
+/* ir_collect_candidates 顺序扫描循环体，找出仿射临时变量的定值和以它为偏移的地址计算 */
+static int ir_collect_candidates(int header, int backEdge, IRCandidate *cands)
+{
+    int candCount = 0;
+    affineTempCount = 0;
+    for (int i = header + 1; i <= backEdge; i++) {
+        InterCodes code = codes[i];
+        if (code->code.kind == LABEL_InterCode) {
+            ir_clear_affine(-1);
+            continue;
+        }
+
+        int kind = code->code.kind;
+        Operand result = kind == ADD_InterCode || kind == SUB_InterCode || kind == MUL_InterCode ?
+                         code->code.u.tripleOP.result : NULL;
+        if (result && result->kind == TEMP_OP && result->type == VAL && ir_get_value_info(result)->defs == 1) {
+            IRCandidate *cand = &cands[candCount];
+            cand->index = i;
+            cand->base = NULL;
+            cand->offset = NULL;
+            if (ir_match_affine_def(code, &cand->iv, &cand->a, &cand->b)) {
+                IRValueInfo *info = ir_get_value_info(result);
+                info->affine = true;
+                info->iv = cand->iv;
+                info->a = cand->a;
+                info->b = cand->b;
+                affineTemps[affineTempCount++] = result->var_no;
+                cand->isAddress = false;
+                candCount++;
+            }
+            else if (kind == ADD_InterCode) {
+                // base + 仿射临时变量，基址在循环内不变
+                Operand op1 = code->code.u.tripleOP.op1;
+                Operand op2 = code->code.u.tripleOP.op2;
+                bool offsetRight = op2->kind == TEMP_OP && ir_get_value_info(op2)->affine;
+                Operand offset = offsetRight ? op2 : op1;
+                Operand base = offsetRight ? op1 : op2;
+                if (offset->kind == TEMP_OP && ir_get_affine(offset, &cand->iv, &cand->a, &cand->b) &&
+                    base->kind != CONSTANT_OP && ir_is_loop_invariant(base)) {
+                    cand->isAddress = true;
+                    cand->base = base;
+                    cand->offset = offset;
+                    candCount++;
+                }
+            }
+        }
+
+        Operand def = ir_get_def_operand(code);
+        if (def && def->kind == VARIABLE_OP && ir_get_value_info(def)->isBiv) {
+            ir_clear_affine(def->var_no);
+        }
+        if (ir_get_jump_target(code) >= 0 || kind == RETURN_InterCode) {
+            ir_clear_affine(-1);
+        }
+    }
+    ir_clear_affine(-1);
+    return candCount;
+}
+
+/* ir_reduce_loop 对 [header, backEdge] 范围内的循环做强度削弱，返回是否改动了代码 */
+static bool ir_reduce_loop(int header, int backEdge)
+{
+    // 只处理从循环头顺序进入的循环：跳到循环内标号的代码都在循环内，循环外的跳转不能进入循环
+    int outsideJumps = 0;
+    for (int i = header; i <= backEdge; i++) {
+        int label = ir_get_label_no(codes[i]);
+        if (label >= 0) {
+            outsideJumps += labelJumps[label];
+        }
+        int target = ir_get_jump_target(codes[i]);
+        if (target >= 0 && labelPos[target] >= header && labelPos[target] <= backEdge) {
+            outsideJumps--;
+        }
+    }
+    if (outsideJumps > 0) {
+        return false;
+    }
+
+    // 统计循环内的定值，循环内只以常量自增的变量是基本归纳变量
+    for (int i = header; i <= backEdge; i++) {
+        Operand *uses[3];
+        int useCount = ir_get_use_operands(codes[i], uses);
+        for (int k = 0; k < useCount; k++) {
+            IRValueInfo *info = ir_get_value_info(*uses[k]);
+            info->loopDefs = 0;
+            info->isBiv = false;
+            info->affine = false;
+        }
+        Operand def = ir_get_def_operand(codes[i]);
+        if (def) {
+            IRValueInfo *info = ir_get_value_info(def);
+            info->loopDefs = 0;
+            info->isBiv = false;
+            info->affine = false;
+        }
+    }
+    for (int i = header; i <= backEdge; i++) {
+        Operand def = ir_get_def_operand(codes[i]);
+        if (def && ir_get_value_info(def)->loopDefs++ == 0) {
+            ir_get_value_info(def)->isBiv = def->kind == VARIABLE_OP && def->type == VAL &&
+                                            !ir_get_value_info(def)->addrTaken;
+        }
+    }
+    int loopLength = backEdge - header + 1;
+    IRIncrement *incs = (IRIncrement *)malloc(loopLength * sizeof(IRIncrement));
+    int incCount = 0;
+    for (int i = header; i <= backEdge; i++) {
+        Operand def = ir_get_def_operand(codes[i]);
+        int step;
+        if (!def || !ir_get_value_info(def)->isBiv) {
+            continue;
+        }
+        if (ir_match_increment(i, header, def, &step)) {
+            incs[incCount].index = i;
+            incs[incCount].ivOp = def;
+            incs[incCount].step = step;
+            incCount++;
+        } else {
+            ir_get_value_info(def)->isBiv = false;
+        }
+    }
+    int kept = 0;
+    for (int i = 0; i < incCount; i++) {
+        if (ir_get_value_info(incs[i].ivOp)->isBiv) {
+            incs[kept++] = incs[i];
+        }
+    }
+    incCount = kept;
+    if (incCount == 0) {
+        free(incs);
+        return false;
+    }
+
+    IRCandidate *cands = (IRCandidate *)malloc(loopLength * sizeof(IRCandidate));
+    affineTemps = (int *)realloc(affineTemps, loopLength * sizeof(int));
+    int candCount = ir_collect_candidates(header, backEdge, cands);
+
+    IRInductionVar vars[IR_MAX_LOOP_INDUCTION_VARS];
+    int varCount = 0;
+    bool changed = false;
+
+    // 地址计算 y := base + t 改写为 y := P，P 随归纳变量一起递增
+    for (int c = 0; c < candCount; c++) {
+        IRCandidate *cand = &cands[c];
+        if (!cand->isAddress) {
+            continue;
+        }
+        int v = ir_find_induction_var(vars, &varCount, incs, incCount, cand->iv, cand->a, cand->b, cand->base);
+        if (v < 0) {
+            continue;
+        }
+        ir_rewrite_as_copy(cand->index, codes[cand->index]->code.u.tripleOP.result, vars[v].temp);
+        ir_propagate_copy(cand->index, &vars[v]);
+    }
+
+    // 逆序处理仿射临时变量：不再使用的删除，仍被使用的乘法改写为归纳变量的复制
+    for (int c = candCount - 1; c >= 0; c--) {
+        IRCandidate *cand = &cands[c];
+        InterCodes code = codes[cand->index];
+        if (cand->isAddress || !code) {
+            continue;
+        }
+        Operand result = code->code.u.tripleOP.result;
+        if (ir_get_value_info(result)->uses == 0) {
+            ir_count_code(code, -1);
+            ir_remove_scanned_code(cand->index);
+            changed = true;
+            continue;
+        }
+
+        // 乘以2的幂只需一条移位指令，不值得再占用一个寄存器
+        unsigned int absA = cand->a < 0 ? 0u - (unsigned int)cand->a : (unsigned int)cand->a;
+        if (code->code.kind != MUL_InterCode || (absA & (absA - 1)) == 0) {
+            continue;
+        }
+        int v = ir_find_induction_var(vars, &varCount, incs, incCount, cand->iv, cand->a, cand->b, NULL);
+        if (v >= 0) {
+            ir_rewrite_as_copy(cand->index, result, vars[v].temp);
+        }
+    }
+
+    // 前置块初始化，并在每次自增之后更新
+    for (int v = 0; v < varCount; v++) {
+        ir_emit_induction_var_init(codes[header], &vars[v]);
+    }
+    for (int i = 0; i < incCount; i++) {
+        InterCodes after = codes[incs[i].index];
+        for (int v = 0; v < varCount; v++) {
+            int delta = (int)((unsigned int)vars[v].a * (unsigned int)incs[i].step);
+            if (vars[v].ivOp->var_no != incs[i].ivOp->var_no || delta == 0) {
+                continue;
+            }
+            InterCodes update = ir_insert_code_before(after->next, ADD_InterCode);
+            update->code.u.tripleOP.result = ir_duplicate_operand(vars[v].temp);
+            update->code.u.tripleOP.op1 = ir_duplicate_operand(vars[v].temp);
+            update->code.u.tripleOP.op2 = ir_create_operand(CONSTANT_OP, VAL, delta);
+            ir_count_code(update, 1);
+            after = update;
+        }
+    }
+
+    IR_DEBUG(IR_DEBUG_INFO, "循环 label%d 引入 %d 个归纳变量\n",
+             codes[header]->code.u.singleOP.op->var_no, varCount);
+    free(incs);
+    free(cands);
+    return changed || varCount > 0;
+}
+
+void ir_reduce_induction_variables(InterCodes funcHead)
+{
+    ir_scan_function(funcHead);
+
+    // 循环头按出现顺序处理，外层循环先于内层循环，内层循环因此能把外层的归纳变量当作基址
+    int *headers = (int *)malloc((codeCount + 1) * sizeof(int));
+    int headerCount = 0;
+    for (int i = 0; i < codeCount; i++) {
+        int label = ir_get_label_no(codes[i]);
+        if (label >= 0 && lastBackEdge[label] > i) {
+            headers[headerCount++] = label;
+        }
+    }
+
+    for (int h = 0; h < headerCount; h++) {
+        int header = labelPos[headers[h]];
+        int backEdge = lastBackEdge[headers[h]];
+        if (header < 0 || backEdge <= header) {
+            continue;
+        }
+        // 初始化代码插在循环头之前，改写后只重新登记这一段代码
+        InterCodes before = codes[header]->prev;
+        if (ir_reduce_loop(header, backEdge)) {
+            ir_rescan_loop(before, codes[backEdge]);
+        }
+    }
+    free(headers);
+}
+
+/* ir_is_loop_test_code 能随循环条件一起复制到循环末尾的代码 */
+static bool ir_is_loop_test_code(InterCodes code)
+{
+    switch (code->code.kind) {
+        case LABEL_InterCode:
+        case FUNC_InterCode:
+        case GOTO_InterCode:
+        case IFGOTO_InterCode:
+        case RETURN_InterCode:
+        case DEC_InterCode:
+        case PARAM_InterCode:
+            return false;
+        default:
+            return true;
+    }
+}
+
+void ir_invert_loops(InterCodes funcHead)
+{
+    ir_scan_function(funcHead);
+
+    // 改写只在循环头的条件跳转之后和回边之前插入代码，codes 中其余循环的位置仍然有效
+    int inverted = 0;
+    for (int header = 0; header < codeCount; header++) {
+        int label = codes[header] ? ir_get_label_no(codes[header]) : -1;
+        int backEdge = label >= 0 ? lastBackEdge[label] : -1;
+        if (backEdge <= header || codes[backEdge]->code.kind != GOTO_InterCode) {
+            continue;
+        }
+        int test = header + 1;
+        while (test < backEdge && test - header <= IR_MAX_LOOP_TEST_CODES && ir_is_loop_test_code(codes[test])) {
+            test++;
+        }
+        if (test >= backEdge || codes[test]->code.kind != IFGOTO_InterCode) {
+            continue;
+        }
+        // 条件跳转离开循环，且回边之后紧接着就是这个出口，改写后循环末尾的条件跳转不成立时直接落入出口
+        int exit = labelPos[ir_get_jump_target(codes[test])];
+        if (exit >= header && exit <= backEdge) {
+            continue;
+        }
+        bool fallsToExit = false;
+        for (int k = backEdge + 1; k < codeCount && codes[k] && codes[k]->code.kind == LABEL_InterCode; k++) {
+            fallsToExit = fallsToExit || k == exit;
+        }
+        if (!fallsToExit) {
+            continue;
+        }
+
+        // LABEL L; 条件; IF c GOTO exit; 循环体; GOTO L  改为
+        // LABEL L; 条件; IF c GOTO exit; LABEL B; 循环体; 条件; IF !c GOTO B
+        Operand bodyLabel = ir_new_label();
+        InterCodes bodyStart = ir_insert_code_before(codes[test]->next, LABEL_InterCode);
+        bodyStart->code.u.singleOP.op = bodyLabel;
+        for (int k = header + 1; k < test; k++) {
+            ir_copy_code_before(codes[k], codes[backEdge]);
+        }
+        InterCodes bottom = ir_copy_code_before(codes[test], codes[backEdge]);
+        bottom->code.u.ifgotoOP.relop = ir_invert_relop(codes[test]->code.u.ifgotoOP.relop);
+        bottom->code.u.ifgotoOP.label = bodyLabel;
+        ir_remove_scanned_code(backEdge);
+        inverted++;
+    }
+    IR_DEBUG(IR_DEBUG_INFO, "循环倒置: 改写%d个循环\n", inverted);
+}
+
+void ir_eliminate_tail_recursion(InterCodes funcHead)
+{
+    char *name = funcHead->code.u.singleOP.op->funcName;
+    InterCodes body = funcHead->next;
+    int paramCount = 0;
+    for (; body != interCodeListHead && body->code.kind == PARAM_InterCode; body = body->next) {
+        paramCount++;
+    }
+    // 数组、结构体和被取地址的变量每层调用各有一份，不能复用
+    for (InterCodes cur = body; cur != interCodeListHead && cur->code.kind != FUNC_InterCode; cur = cur->next) {
+        if (cur->code.kind == DEC_InterCode || cur->code.kind == GET_ADDR_InterCode) {
+            return;
+        }
+    }
+
+    Operand entry = NULL;
+    int eliminated = 0;
+    for (InterCodes cur = body; cur != interCodeListHead && cur->code.kind != FUNC_InterCode;) {
+        InterCodes next = cur->next;
+        Operand result = cur->code.kind == CALL_InterCode ? cur->code.u.doubleOP.left : NULL;
+        if (!result || !name || strcmp(cur->code.u.doubleOP.right->funcName, name) != 0 ||
+            next->code.kind != RETURN_InterCode || !ir_same_value(next->code.u.singleOP.op, result)) {
+            cur = next;
+            continue;
+        }
+        InterCodes arg = cur;
+        int argCount = 0;
+        while (argCount < paramCount && arg->prev->code.kind == ARG_InterCode) {
+            arg = arg->prev;
+            argCount++;
+        }
+        if (argCount != paramCount) {
+            cur = next;
+            continue;
+        }
+        if (!entry) {
+            entry = ir_new_label();
+            InterCodes label = ir_insert_code_before(body, LABEL_InterCode);
+            label->code.u.singleOP.op = entry;
+        }
+
+        // 实参可能读取形参，先全部复制到新的临时变量，再赋给形参；最后一条 ARG 对应第一个 PARAM
+        Operand *temps = (Operand *)malloc(paramCount * sizeof(Operand));
+        arg = cur->prev;
+        for (int k = 0; k < paramCount; k++) {
+            temps[k] = ir_new_temp();
+            InterCodes copy = ir_insert_code_before(cur, ASSIGN_InterCode);
+            copy->code.u.doubleOP.left = temps[k];
+            copy->code.u.doubleOP.right = arg->code.u.singleOP.op;
+            InterCodes prev = arg->prev;
+            ir_remove_code(arg);
+            arg = prev;
+        }
+        InterCodes param = funcHead->next;
+        for (int k = 0; k < paramCount; k++, param = param->next) {
+            InterCodes assign = ir_insert_code_before(cur, ASSIGN_InterCode);
+            assign->code.u.doubleOP.left = ir_duplicate_operand(param->code.u.singleOP.op);
+            assign->code.u.doubleOP.left->type = VAL;
+            assign->code.u.doubleOP.right = ir_duplicate_operand(temps[k]);
+        }
+        free(temps);
+        InterCodes jump = ir_insert_code_before(cur, GOTO_InterCode);
+        jump->code.u.singleOP.op = entry;
+        cur = next->next;
+        ir_remove_code(next);
+        ir_remove_code(jump->next);
+        eliminated++;
+    }
+    IR_DEBUG(IR_DEBUG_INFO, "尾递归消除: 改写%d处调用\n", eliminated);
+}
+
+void ir_optimize_program(void)
+{
+    if (!interCodeListHead || !interCodeListHead->next) {
+        return;
+    }
+
+    for (InterCodes cur = interCodeListHead->next; cur != interCodeListHead; cur = cur->next) {
+        if (cur->code.kind == FUNC_InterCode) {
+            ir_eliminate_tail_recursion(cur);
+        }
+    }
+    ir_inline_functions();
+    for (InterCodes cur = interCodeListHead->next; cur != interCodeListHead; cur = cur->next) {
+        if (cur->code.kind == FUNC_InterCode) {
+            ir_reduce_induction_variables(cur);
+            ir_invert_loops(cur);
+
+            IRCfg cfg = ir_build_cfg(cur);
+            ir_build_ssa(cfg);
+            ir_propagate_constants(cfg);
+            ir_number_values(cfg);
+            ir_hoist_loop_invariants(cfg);
+            ir_eliminate_dead_code(cfg);
+            ir_destroy_ssa(cfg);
+            ir_layout_blocks(cfg);
+            ir_free_cfg(cfg);
+        }
+    }
+}
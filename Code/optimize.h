@@ -0,0 +1,100 @@
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+#include "intermediate.h"
+#include "cfg.h"
+
+/* 中间代码优化模块：在中间代码生成之后、MIPS代码生成之前改写中间代码链表 */
+
+/* 每个循环最多引入的归纳变量个数，避免寄存器压力过大 */
+#define IR_MAX_LOOP_INDUCTION_VARS 8
+
+/* 循环倒置时最多复制的循环条件代码条数，避免代码膨胀 */
+#define IR_MAX_LOOP_TEST_CODES 8
+
+/**
+ * @brief 对整个程序的中间代码运行各优化遍
+ */
+void ir_optimize_program(void);
+
+/**
+ * @brief 归纳变量强度削弱：把循环中 i * #c 以及数组地址 base + i * #c
+ *        改写为在循环前置块中初始化、随 i 的自增一起递增的临时变量
+ * @param funcHead 函数的FUNCTION代码
+ */
+void ir_reduce_induction_variables(InterCodes funcHead);
+
+/**
+ * @brief 循环倒置：把 while 循环改写为先判断一次、再在循环末尾判断是否继续的形式，
+ *        每次迭代少执行一条跳回循环头的 GOTO。循环头的条件计算被复制到循环末尾，
+ *        要求条件在 IR_MAX_LOOP_TEST_CODES 条代码内、以离开循环的 IFGOTO 结束，且回边之后紧接着就是这个出口
+ * @param funcHead 函数的FUNCTION代码
+ */
+void ir_invert_loops(InterCodes funcHead);
+
+/**
+ * @brief 尾递归消除：x := CALL f; RETURN x 中 f 是函数自身时，实参经新的临时变量赋给形参后跳回 PARAM 之后的入口标号，
+ *        递归改为循环，栈的深度不再随递归层数增长；含数组、结构体或取地址的函数不处理
+ * @param funcHead 函数的FUNCTION代码
+ */
+void ir_eliminate_tail_recursion(InterCodes funcHead);
+
+/* 优化遍共用的中间代码工具函数 */
+
+/**
+ * @brief 获取中间代码定值的变量或临时变量
+ * @param code 中间代码
+ * @return 被定值的操作数，没有则返回NULL
+ */
+Operand ir_get_def_operand(InterCodes code);
+
+/**
+ * @brief 获取中间代码读取的操作数位置，可以通过它们直接替换操作数；φ函数的参数不在其中
+ * @param code 中间代码
+ * @param uses 输出被读取操作数的地址，最多3个
+ * @return 被读取操作数的个数
+ */
+int ir_get_use_operands(InterCodes code, Operand *uses[3]);
+
+/**
+ * @brief 在指定代码之前插入一条新的中间代码，各字段由调用者填写
+ * @param position 插入位置
+ * @param kind 中间代码类型
+ * @return 新插入的代码
+ */
+InterCodes ir_insert_code_before(InterCodes position, int kind);
+
+/**
+ * @brief 在指定代码之前插入一条代码的副本，操作数各自复制，可以直接修改副本的操作数
+ * @param code 被复制的代码
+ * @param position 插入位置
+ * @return 新插入的副本
+ */
+InterCodes ir_copy_code_before(InterCodes code, InterCodes position);
+
+/**
+ * @brief 把一条代码从原位置取下，移到指定代码之前
+ * @param code 被移动的代码
+ * @param position 新位置
+ */
+void ir_move_code_before(InterCodes code, InterCodes position);
+
+/**
+ * @brief 从中间代码链表中删除一条代码
+ * @param code 被删除的代码
+ */
+void ir_remove_code(InterCodes code);
+
+/**
+ * @brief 创建一个新的临时变量操作数
+ * @return 新的临时变量
+ */
+Operand ir_new_temp(void);
+
+/**
+ * @brief 创建一个新的标号操作数
+ * @return 新的标号
+ */
+Operand ir_new_label(void);
+
+#endif
@@ -0,0 +1,417 @@
+#include "peephole.h"
+
+#define MIPS_PEEPHOLE_MAX_WINDOW 4
+#define MIPS_IMMEDIATE_MIN (-32768)
+#define MIPS_IMMEDIATE_MAX 32767
+
+#define OPERAND(emitter, instr, k) ((emitter)->operandText.data + (instr)->operands[k])
+
+/* Create an empty emitter writing to file */
+MipsEmitter newMipsEmitter(FILE *file)
+{
+    MipsEmitter emitter = (MipsEmitter)calloc(1, sizeof(MipsEmitter_));
+    emitter->file = file;
+    return emitter;
+}
+
+/* Free the buffers of an emitter */
+void freeMipsEmitter(MipsEmitter emitter)
+{
+    free(emitter->instrs);
+    text_free(&emitter->operandText);
+    text_free(&emitter->outputText);
+    text_free(&emitter->stringText);
+    free(emitter->strings);
+    free(emitter);
+}
+
+/* Start a new operand string and return its offset */
+static int beginMipsOperand(MipsEmitter emitter)
+{
+    return (int)emitter->operandText.size;
+}
+
+/* Terminate the operand string being written */
+static void endMipsOperand(MipsEmitter emitter)
+{
+    text_append_char(&emitter->operandText, '\0');
+}
+
+/* Write an integer operand and return its offset */
+static int addMipsInt(MipsEmitter emitter, long value)
+{
+    int offset = beginMipsOperand(emitter);
+    text_append_int(&emitter->operandText, value);
+    endMipsOperand(emitter);
+    return offset;
+}
+
+/* Append an empty instruction to the buffer */
+static MipsInstr newMipsInstr(MipsEmitter emitter)
+{
+    if (emitter->instrCount == emitter->instrCapacity) {
+        emitter->instrCapacity = emitter->instrCapacity ? emitter->instrCapacity * 2 : 256;
+        emitter->instrs = (MipsInstr_ *)realloc(emitter->instrs, emitter->instrCapacity * sizeof(MipsInstr_));
+    }
+    MipsInstr instr = &emitter->instrs[emitter->instrCount++];
+    instr->isLabel = false;
+    instr->deleted = false;
+    instr->op[0] = '\0';
+    instr->operandCount = 0;
+    return instr;
+}
+
+/* Buffer an instruction, writing each operand described by `operands` straight into the operand text */
+void emitMipsInstr(MipsEmitter emitter, const char *op, const char *operands, ...)
+{
+    MipsInstr instr = newMipsInstr(emitter);
+    strncpy(instr->op, op, sizeof(instr->op) - 1);
+    instr->op[sizeof(instr->op) - 1] = '\0';
+
+    TextBuffer text = &emitter->operandText;
+    va_list args;
+    va_start(args, operands);
+    for (const char *kind = operands; *kind && instr->operandCount < MIPS_MAX_OPERANDS; kind++) {
+        instr->operands[instr->operandCount++] = beginMipsOperand(emitter);
+        switch (*kind) {
+            case 'r':
+                text_append_string(text, va_arg(args, const char *));
+                break;
+            case 'i':
+                text_append_int(text, va_arg(args, int));
+                break;
+            case 'm':
+                text_append_int(text, va_arg(args, int));
+                text_append_char(text, '(');
+                text_append_string(text, va_arg(args, const char *));
+                text_append_char(text, ')');
+                break;
+            case 'l':
+                text_append_string(text, va_arg(args, const char *));
+                text_append_int(text, va_arg(args, int));
+                break;
+            default:
+                MIPS_DEBUG_PRINT("Unknown operand kind '%c' for %s", *kind, op);
+                break;
+        }
+        endMipsOperand(emitter);
+    }
+    va_end(args);
+}
+
+/* Buffer a label definition */
+void emitMipsLabel(MipsEmitter emitter, const char *name, int number)
+{
+    MipsInstr instr = newMipsInstr(emitter);
+    instr->isLabel = true;
+    instr->operandCount = 1;
+    instr->operands[0] = beginMipsOperand(emitter);
+    text_append_string(&emitter->operandText, name);
+    if (number >= 0) {
+        text_append_int(&emitter->operandText, number);
+    }
+    endMipsOperand(emitter);
+}
+
+/* Replace the operands of an instruction */
+static void setMipsInstr(MipsInstr instr, const char *op, int operandCount, const int *operands)
+{
+    strcpy(instr->op, op);
+    instr->operandCount = operandCount;
+    for (int k = 0; k < operandCount; k++) {
+        instr->operands[k] = operands[k];
+    }
+}
+
+/* Whether an instruction is the given (non-label) operation */
+static bool isMipsOp(MipsInstr instr, const char *op)
+{
+    return !instr->isLabel && strcmp(instr->op, op) == 0;
+}
+
+/* Branches, jumps, calls and returns */
+static bool isMipsControlInstr(MipsInstr instr)
+{
+    return !instr->isLabel && (instr->op[0] == 'b' || instr->op[0] == 'j');
+}
+
+/* Whether operand 0 is a destination register */
+static bool writesMipsFirstOperand(MipsInstr instr)
+{
+    return !instr->isLabel && instr->operandCount > 0 && !isMipsControlInstr(instr) &&
+        strcmp(instr->op, "sw") != 0 && strcmp(instr->op, "mult") != 0;
+}
+
+/* Whether a memory operand off(base) uses reg as its base */
+static bool isMipsMemoryBase(const char *operand, const char *reg)
+{
+    const char *open = strchr(operand, '(');
+    if (!open) {
+        return false;
+    }
+    size_t length = strlen(reg);
+    return strncmp(open + 1, reg, length) == 0 && open[1 + length] == ')';
+}
+
+/* Whether an instruction reads register reg */
+static bool readsMipsRegister(MipsEmitter emitter, MipsInstr instr, const char *reg)
+{
+    if (instr->isLabel) {
+        return false;
+    }
+    // syscall takes its service number in $v0 and its argument in $a0
+    if (isMipsOp(instr, "syscall")) {
+        return strcmp(reg, mipsRegNames[2]) == 0 || strcmp(reg, mipsRegNames[4]) == 0;
+    }
+    for (int k = writesMipsFirstOperand(instr) ? 1 : 0; k < instr->operandCount; k++) {
+        if (strcmp(OPERAND(emitter, instr, k), reg) == 0 || isMipsMemoryBase(OPERAND(emitter, instr, k), reg)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Whether reg is one of the scratch registers the code generator reloads for each IR code */
+static bool isMipsScratchRegister(const char *reg)
+{
+    for (int i = SCRATCH_REG_START; i <= SCRATCH_REG_END; i++) {
+        if (strcmp(reg, mipsRegNames[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Whether the scratch register reg is dead after instruction index */
+static bool isMipsScratchDeadAfter(MipsEmitter emitter, int index, const char *reg)
+{
+    for (int i = index + 1; i < emitter->instrCount; i++) {
+        MipsInstr instr = &emitter->instrs[i];
+        if (instr->deleted) {
+            continue;
+        }
+        if (readsMipsRegister(emitter, instr, reg)) {
+            return false;
+        }
+        // $v0 carries the return value to jr, otherwise scratch values never cross control flow
+        if (isMipsOp(instr, "jr")) {
+            return strcmp(reg, mipsRegNames[2]) != 0;
+        }
+        if (instr->isLabel || isMipsControlInstr(instr)) {
+            return true;
+        }
+        if (writesMipsFirstOperand(instr) && strcmp(OPERAND(emitter, instr, 0), reg) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* move $x, $x */
+static bool applyMipsSelfMove(MipsEmitter emitter, int *window)
+{
+    MipsInstr instr = &emitter->instrs[window[0]];
+    if (!isMipsOp(instr, "move") || strcmp(OPERAND(emitter, instr, 0), OPERAND(emitter, instr, 1)) != 0) {
+        return false;
+    }
+    instr->deleted = true;
+    return true;
+}
+
+/* sw $a, M; lw $b, M  =>  sw $a, M; move $b, $a */
+static bool applyMipsStoreLoad(MipsEmitter emitter, int *window)
+{
+    MipsInstr store = &emitter->instrs[window[0]];
+    MipsInstr load = &emitter->instrs[window[1]];
+    if (!isMipsOp(store, "sw") || !isMipsOp(load, "lw") ||
+        strcmp(OPERAND(emitter, store, 1), OPERAND(emitter, load, 1)) != 0) {
+        return false;
+    }
+    if (strcmp(OPERAND(emitter, store, 0), OPERAND(emitter, load, 0)) == 0) {
+        load->deleted = true;
+    } else {
+        int operands[2] = {load->operands[0], store->operands[0]};
+        setMipsInstr(load, "move", 2, operands);
+    }
+    return true;
+}
+
+/* lw $a, M; sw $a, M  =>  lw $a, M (unless $a is the base of M) */
+static bool applyMipsLoadStore(MipsEmitter emitter, int *window)
+{
+    MipsInstr load = &emitter->instrs[window[0]];
+    MipsInstr store = &emitter->instrs[window[1]];
+    if (!isMipsOp(load, "lw") || !isMipsOp(store, "sw") ||
+        strcmp(OPERAND(emitter, load, 0), OPERAND(emitter, store, 0)) != 0 ||
+        strcmp(OPERAND(emitter, load, 1), OPERAND(emitter, store, 1)) != 0 ||
+        isMipsMemoryBase(OPERAND(emitter, load, 1), OPERAND(emitter, load, 0))) {
+        return false;
+    }
+    store->deleted = true;
+    return true;
+}
+
+/* li $v, k; add $d, $s, $v  =>  addi $d, $s, k (also sub with -k) */
+static bool applyMipsConstantOperand(MipsEmitter emitter, int *window)
+{
+    MipsInstr li = &emitter->instrs[window[0]];
+    MipsInstr arith = &emitter->instrs[window[1]];
+    if (!isMipsOp(li, "li") || arith->isLabel || arith->operandCount != 3) {
+        return false;
+    }
+    const char *reg = OPERAND(emitter, li, 0);
+    if (!isMipsScratchRegister(reg)) {
+        return false;
+    }
+
+    long value = strtol(OPERAND(emitter, li, 1), NULL, 10);
+    bool lhs = strcmp(OPERAND(emitter, arith, 1), reg) == 0;
+    bool rhs = strcmp(OPERAND(emitter, arith, 2), reg) == 0;
+    int other;
+    if (strcmp(arith->op, "add") == 0 && lhs != rhs) {
+        other = lhs ? arith->operands[2] : arith->operands[1];
+    } else if (strcmp(arith->op, "sub") == 0 && rhs && !lhs) {
+        other = arith->operands[1];
+        value = -value;
+    } else {
+        return false;
+    }
+    if (value < MIPS_IMMEDIATE_MIN || value > MIPS_IMMEDIATE_MAX) {
+        return false;
+    }
+    if (strcmp(OPERAND(emitter, arith, 0), reg) != 0 && !isMipsScratchDeadAfter(emitter, window[1], reg)) {
+        return false;
+    }
+
+    int operands[3] = {arith->operands[0], other, addMipsInt(emitter, value)};
+    setMipsInstr(arith, "addi", 3, operands);
+    li->deleted = true;
+    return true;
+}
+
+/* j L (or a branch to L) immediately followed by L: */
+static bool applyMipsJumpToNext(MipsEmitter emitter, int *window)
+{
+    MipsInstr jump = &emitter->instrs[window[0]];
+    MipsInstr label = &emitter->instrs[window[1]];
+    if (!label->isLabel || jump->isLabel || jump->operandCount == 0 ||
+        !(jump->op[0] == 'b' || strcmp(jump->op, "j") == 0) ||
+        strcmp(OPERAND(emitter, jump, jump->operandCount - 1), OPERAND(emitter, label, 0)) != 0) {
+        return false;
+    }
+    jump->deleted = true;
+    return true;
+}
+
+static MipsPeepholeRule PEEPHOLE_RULES[] = {
+    {"self-move", 1, true, applyMipsSelfMove},
+    {"store-load", 2, true, applyMipsStoreLoad},
+    {"load-store", 2, true, applyMipsLoadStore},
+    {"constant-operand", 2, true, applyMipsConstantOperand},
+    {"jump-to-next", 2, true, applyMipsJumpToNext},
+    {NULL, 0, false, NULL}
+};
+
+/* Apply every enabled rule at every position once */
+static bool runMipsPeepholePass(MipsEmitter emitter)
+{
+    bool changed = false;
+    int window[MIPS_PEEPHOLE_MAX_WINDOW];
+
+    for (int i = 0; i < emitter->instrCount; i++) {
+        for (MipsPeepholeRule *rule = PEEPHOLE_RULES; rule->name && !emitter->instrs[i].deleted; rule++) {
+            if (!rule->enabled) {
+                continue;
+            }
+            int n = 0;
+            for (int j = i; j < emitter->instrCount && n < rule->window; j++) {
+                if (!emitter->instrs[j].deleted) {
+                    window[n++] = j;
+                }
+            }
+            if (n == rule->window && rule->apply(emitter, window)) {
+                MIPS_DEBUG_PRINT("Peephole rule %s applied at instruction %d", rule->name, i);
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+/* Optimise and print the buffered instructions */
+void flushMipsInstrs(MipsEmitter emitter)
+{
+    for (int pass = 0; pass < MIPS_PEEPHOLE_MAX_PASSES && runMipsPeepholePass(emitter); pass++) {
+    }
+
+    TextBuffer output = &emitter->outputText;
+    for (int i = 0; i < emitter->instrCount; i++) {
+        MipsInstr instr = &emitter->instrs[i];
+        if (instr->deleted) {
+            continue;
+        }
+        if (instr->isLabel) {
+            text_append_string(output, OPERAND(emitter, instr, 0));
+            text_append(output, ":\n", 2);
+            continue;
+        }
+        text_append_char(output, '\t');
+        text_append_string(output, instr->op);
+        for (int k = 0; k < instr->operandCount; k++) {
+            text_append(output, k ? ", " : " ", k ? 2 : 1);
+            text_append_string(output, OPERAND(emitter, instr, k));
+        }
+        text_append_char(output, '\n');
+    }
+    if (output->size >= MIPS_OUTPUT_CHUNK_SIZE) {
+        text_write(output, emitter->file);
+    }
+
+    emitter->instrCount = 0;
+    emitter->operandText.size = 0;
+}
+
+/* Append raw text (directives, data) after the instructions buffered so far */
+void emitMipsText(MipsEmitter emitter, const char *text)
+{
+    if (emitter->instrCount > 0) {
+        flushMipsInstrs(emitter);
+    }
+    text_append_string(&emitter->outputText, text);
+}
+
+/* Flush the buffered instructions, write all remaining text to file and free the emitter */
+void writeMipsOutput(MipsEmitter emitter)
+{
+    flushMipsInstrs(emitter);
+    text_write(&emitter->outputText, emitter->file);
+    freeMipsEmitter(emitter);
+}
+
+/* Enable peephole rules by name ("all", "none" or "rule1,rule2,...") */
+bool setMipsPeepholeRules(const char *spec)
+{
+    bool enableAll = strcmp(spec, "all") == 0;
+    for (MipsPeepholeRule *rule = PEEPHOLE_RULES; rule->name; rule++) {
+        rule->enabled = enableAll;
+    }
+    if (enableAll || strcmp(spec, "none") == 0) {
+        return true;
+    }
+
+    const char *start = spec;
+    while (*start) {
+        const char *end = strchr(start, ',');
+        size_t length = end ? (size_t)(end - start) : strlen(start);
+        MipsPeepholeRule *rule = PEEPHOLE_RULES;
+        while (rule->name && (strlen(rule->name) != length || strncmp(rule->name, start, length) != 0)) {
+            rule++;
+        }
+        if (!rule->name) {
+            return false;
+        }
+        rule->enabled = true;
+        start = end ? end + 1 : start + length;
+    }
+    return true;
+}
@@ -0,0 +1,72 @@
+#ifndef __MIPS_PEEPHOLE_H__
+#define __MIPS_PEEPHOLE_H__
+
+#include "mips.h"
+
+// Instructions are buffered per function, optimised, then printed
+#define MIPS_MAX_OPERANDS 3
+#define MIPS_PEEPHOLE_MAX_PASSES 8      // Rules are re-applied until nothing changes or this many passes ran
+#define MIPS_OUTPUT_CHUNK_SIZE (1 << 20) // Flushed text is written out once this many bytes are pending
+
+// One buffered instruction or label, operands are offsets into the operand text of its emitter
+typedef struct MipsInstr_ {
+    bool isLabel;                       // Label definition, its name is operand 0
+    bool deleted;                       // Removed by the peephole pass
+    char op[8];                         // Mnemonic
+    int operandCount;
+    int operands[MIPS_MAX_OPERANDS];
+} MipsInstr_;
+
+typedef MipsInstr_ *MipsInstr;
+
+// Instruction buffer of one output file: the function being generated, its operand text and the text flushed so far
+typedef struct MipsEmitter_ {
+    FILE *file;                         // Flushed text is written here
+    MipsInstr_ *instrs;
+    int instrCount;
+    int instrCapacity;
+    TextBuffer_ operandText;            // NUL-terminated operand strings, addressed by offset
+    TextBuffer_ outputText;             // Assembly of the functions flushed so far
+    TextBuffer_ stringText;             // NUL-terminated strings printed by constant writes
+    int *strings;                       // Offsets of the data section strings in stringText, by label number
+    int stringCount;
+    int stringCapacity;
+} MipsEmitter_;
+
+// A rule looks at `window` consecutive live instructions and returns true if it changed them
+typedef bool (*MipsPeepholeApply)(MipsEmitter emitter, int *window);
+
+typedef struct MipsPeepholeRule {
+    const char *name;
+    int window;
+    bool enabled;
+    MipsPeepholeApply apply;
+} MipsPeepholeRule;
+
+// Create an empty emitter writing to file
+MipsEmitter newMipsEmitter(FILE *file);
+
+// Buffer an instruction. Each character of `operands` describes one operand and takes its arguments:
+// 'r' a register or symbol name (const char *), 'i' an integer (int),
+// 'm' a memory operand off(base) (int, const char *), 'l' a name followed by a number (const char *, int)
+void emitMipsInstr(MipsEmitter emitter, const char *op, const char *operands, ...);
+
+// Buffer a label definition `name` followed by `number`, or just `name` when number is negative
+void emitMipsLabel(MipsEmitter emitter, const char *name, int number);
+
+// Run the enabled rules over the buffer and append it to the output text, written to file in large chunks
+void flushMipsInstrs(MipsEmitter emitter);
+
+// Append raw text after the buffered instructions
+void emitMipsText(MipsEmitter emitter, const char *text);
+
+// Write everything still pending to file with one fwrite and free the emitter
+void writeMipsOutput(MipsEmitter emitter);
+
+// Free the emitter without writing what is still pending
+void freeMipsEmitter(MipsEmitter emitter);
+
+// Enable rules by name: "all", "none" or a comma-separated list of rule names
+bool setMipsPeepholeRules(const char *spec);
+
+#endif // __MIPS_PEEPHOLE_H__
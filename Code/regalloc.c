@@ -0,0 +1,978 @@
+#include "regalloc.h"
+
+int mipsRegAllocMode = MIPS_REGALLOC_MODE;
+
+// Colour preference order: caller-saved $t and $a registers first, then callee-saved $s registers
+static const int ALLOC_REG_ORDER[ALLOC_REG_COUNT] = {
+    8, 9, 10, 11, 12, 13, 14, 15, 24, 25,
+    4, 5, 6, 7,
+    16, 17, 18, 19, 20, 21, 22, 23
+};
+#define SAVED_REG_COUNT (SAVED_REG_END - SAVED_REG_START + 1)
+
+// Per-value allocation information
+typedef struct MipsValueInfo {
+    int kind;                           // VARIABLE_OP or TEMP_OP
+    int varNo;                          // Operand var_no
+    bool inMemory;                      // Arrays, structures and address-taken variables stay in the frame
+    bool crossesCall;                   // Live across a CALL, only callee-saved registers are safe
+    bool crossesIO;                     // Live across READ/WRITE, which clobber $a0
+    bool used;                          // Read by at least one code
+    int paramIndex;                     // Position among the function's PARAMs, -1 otherwise
+    double spillCost;                   // Defs and uses weighted by loop depth
+    int degree;                         // Number of interfering values
+    int start, end;                     // Live interval in code positions (linear scan)
+    bool startIsDef;                    // Interval begins with a definition
+    int hint;                           // Copy source at the defining move, -1 if none
+    int color;                          // Assigned register number, -1 if spilled
+} MipsValueInfo;
+
+static MipsValueInfo *values = NULL;
+static int valueCount = 0;
+static int valueCapacity = 0;
+
+// Dense var_no -> value index tables, entries are reset between functions
+static int *varValueIndex = NULL;
+static int *tempValueIndex = NULL;
+static int varIndexSize = 0;
+static int tempIndexSize = 0;
+
+static unsigned int usedSavedRegs = 0;
+
+// Per-function analysis state
+static InterCodes *codes = NULL;
+static int codeCount = 0;
+static int *blockStart = NULL;
+static int *blockEnd = NULL;
+static int (*blockSucc)[2] = NULL;
+static int blockCount = 0;
+static int bitsetWords = 0;
+static unsigned int *interference = NULL;
+static int *adjStart = NULL;
+static int *adjList = NULL;
+static int *moveStart = NULL;
+static int *moveList = NULL;
+
+#define BIT_TEST(set, i) (((set)[(i) >> 5] >> ((i) & 31)) & 1u)
+#define BIT_SET(set, i) ((set)[(i) >> 5] |= 1u << ((i) & 31))
+#define BIT_CLEAR(set, i) ((set)[(i) >> 5] &= ~(1u << ((i) & 31)))
+
+/* Grow a var_no index table so that varNo is a valid index */
+static void ensureMipsIndexCapacity(int **table, int *size, int varNo)
+{
+    if (varNo < *size) {
+        return;
+    }
+    int newSize = *size ? *size : 64;
+    while (newSize <= varNo) {
+        newSize *= 2;
+    }
+    *table = (int *)realloc(*table, newSize * sizeof(int));
+    for (int i = *size; i < newSize; i++) {
+        (*table)[i] = -1;
+    }
+    *size = newSize;
+}
+
+/* Find the value index of an operand, optionally creating it */
+static int lookupMipsValue(Operand op, bool create)
+{
+    if (!op || (op->kind != VARIABLE_OP && op->kind != TEMP_OP) || op->var_no < 0) {
+        return -1;
+    }
+
+    int **table = op->kind == VARIABLE_OP ? &varValueIndex : &tempValueIndex;
+    int *size = op->kind == VARIABLE_OP ? &varIndexSize : &tempIndexSize;
+    if (op->var_no >= *size) {
+        if (!create) {
+            return -1;
+        }
+        ensureMipsIndexCapacity(table, size, op->var_no);
+    }
+
+    int index = (*table)[op->var_no];
+    if (index >= 0 || !create) {
+        return index;
+    }
+
+    if (valueCount == valueCapacity) {
+        valueCapacity = valueCapacity ? valueCapacity * 2 : 64;
+        values = (MipsValueInfo *)realloc(values, valueCapacity * sizeof(MipsValueInfo));
+    }
+    index = valueCount++;
+    values[index].kind = op->kind;
+    values[index].varNo = op->var_no;
+    values[index].inMemory = false;
+    values[index].crossesCall = false;
+    values[index].crossesIO = false;
+    values[index].used = false;
+    values[index].paramIndex = -1;
+    values[index].spillCost = 0;
+    values[index].degree = 0;
+    values[index].start = -1;
+    values[index].end = -1;
+    values[index].startIsDef = false;
+    values[index].hint = -1;
+    values[index].color = -1;
+    (*table)[op->var_no] = index;
+    return index;
+}
+
+/* Register a value and mark it memory-resident if its address is taken */
+static void recordMipsOperand(Operand op)
+{
+    int index = lookupMipsValue(op, true);
+    if (index >= 0 && op->kind == VARIABLE_OP && op->type == ADDRESS) {
+        values[index].inMemory = true;
+    }
+}
+
+/* Register candidate read by an operand, -1 for constants and frame-resident values */
+static int getMipsUseCandidate(Operand op)
+{
+    int index = lookupMipsValue(op, false);
+    if (index < 0 || values[index].inMemory) {
+        return -1;
+    }
+    return index;
+}
+
+/* Collect the register candidates defined and used by one intermediate code */
+static int getMipsDefUse(InterCodes code, int uses[3], int *useCount, int *moveSrc)
+{
+    int def = -1;
+    *useCount = 0;
+    *moveSrc = -1;
+
+#define ADD_USE(op) do { int u_ = getMipsUseCandidate(op); if (u_ >= 0) uses[(*useCount)++] = u_; } while (0)
+
+    switch (code->code.kind) {
+        case ASSIGN_InterCode: {
+            Operand left = code->code.u.doubleOP.left;
+            Operand right = code->code.u.doubleOP.right;
+            if (left->kind == TEMP_OP && left->type == ADDRESS) {
+                // *t := y reads both t and y
+                ADD_USE(left);
+            } else {
+                def = getMipsUseCandidate(left);
+                if (right->kind != CONSTANT_OP && right->type == VAL) {
+                    *moveSrc = getMipsUseCandidate(right);
+                }
+            }
+            ADD_USE(right);
+            break;
+        }
+
+        case ADD_InterCode:
+        case SUB_InterCode:
+        case MUL_InterCode:
+        case DIV_InterCode:
+            def = getMipsUseCandidate(code->code.u.tripleOP.result);
+            ADD_USE(code->code.u.tripleOP.op1);
+            ADD_USE(code->code.u.tripleOP.op2);
+            break;
+
+        case IFGOTO_InterCode:
+            ADD_USE(code->code.u.ifgotoOP.op1);
+            ADD_USE(code->code.u.ifgotoOP.op2);
+            break;
+
+        case RETURN_InterCode:
+        case ARG_InterCode:
+        case WRITE_InterCode:
+            ADD_USE(code->code.u.singleOP.op);
+            break;
+
+        case CALL_InterCode:
+            def = getMipsUseCandidate(code->code.u.doubleOP.left);
+            break;
+
+        case PARAM_InterCode:
+        case READ_InterCode:
+            def = getMipsUseCandidate(code->code.u.singleOP.op);
+            break;
+
+        default:
+            break;
+    }
+
+#undef ADD_USE
+    return def;
+}
+
+/* Take the basic blocks from the function's control flow graph and set loop depth per code */
+static void buildMipsBlocks(InterCodes funcInterCodes, int *loopDepth)
+{
+    IRCfg cfg = ir_build_cfg(funcInterCodes);
+
+    // Blocks are laid out in code order, so positions follow from the block sizes
+    blockCount = cfg->blockCount;
+    blockStart = (int *)malloc((blockCount + 1) * sizeof(int));
+    blockEnd = (int *)malloc((blockCount + 1) * sizeof(int));
+    blockSucc = malloc((blockCount + 1) * sizeof(*blockSucc));
+
+    int pos = 0;
+    for (int b = 0; b < blockCount; b++) {
+        blockStart[b] = pos;
+        pos += cfg->blocks[b].codeCount;
+        blockEnd[b] = pos;
+        blockSucc[b][0] = cfg->blocks[b].succ[0];
+        blockSucc[b][1] = cfg->blocks[b].succ[1];
+
+        int depth = ir_cfg_loop_depth(cfg, b);
+        for (int i = blockStart[b]; i < blockEnd[b]; i++) {
+            loopDepth[i] = depth;
+        }
+    }
+
+    ir_free_cfg(cfg);
+}
+
+/* Iterative backward liveness over basic blocks */
+static unsigned int *computeMipsLiveOut(void)
+{
+    unsigned int *useSet = (unsigned int *)calloc((size_t)blockCount * bitsetWords, sizeof(unsigned int));
+    unsigned int *defSet = (unsigned int *)calloc((size_t)blockCount * bitsetWords, sizeof(unsigned int));
+    unsigned int *liveIn = (unsigned int *)calloc((size_t)blockCount * bitsetWords, sizeof(unsigned int));
+    unsigned int *liveOut = (unsigned int *)calloc((size_t)blockCount * bitsetWords, sizeof(unsigned int));
+
+    int uses[3], useCount, moveSrc;
+    for (int b = 0; b < blockCount; b++) {
+        unsigned int *use = useSet + (size_t)b * bitsetWords;
+        unsigned int *def = defSet + (size_t)b * bitsetWords;
+        for (int i = blockStart[b]; i < blockEnd[b]; i++) {
+            int d = getMipsDefUse(codes[i], uses, &useCount, &moveSrc);
+            for (int k = 0; k < useCount; k++) {
+                if (!BIT_TEST(def, uses[k])) {
+                    BIT_SET(use, uses[k]);
+                }
+            }
+            if (d >= 0) {
+                BIT_SET(def, d);
+            }
+        }
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int b = blockCount - 1; b >= 0; b--) {
+            unsigned int *out = liveOut + (size_t)b * bitsetWords;
+            unsigned int *in = liveIn + (size_t)b * bitsetWords;
+            unsigned int *use = useSet + (size_t)b * bitsetWords;
+            unsigned int *def = defSet + (size_t)b * bitsetWords;
+            for (int s = 0; s < 2; s++) {
+                int succ = blockSucc[b][s];
+                if (succ < 0) {
+                    continue;
+                }
+                unsigned int *succIn = liveIn + (size_t)succ * bitsetWords;
+                for (int w = 0; w < bitsetWords; w++) {
+                    out[w] |= succIn[w];
+                }
+            }
+            for (int w = 0; w < bitsetWords; w++) {
+                unsigned int newIn = use[w] | (out[w] & ~def[w]);
+                if (newIn != in[w]) {
+                    in[w] = newIn;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    free(useSet);
+    free(defSet);
+    free(liveIn);
+    return liveOut;
+}
+
+/* Record that two values are live at the same time */
+static void addMipsInterference(int a, int b)
+{
+    if (a == b || BIT_TEST(interference + (size_t)a * bitsetWords, b)) {
+        return;
+    }
+    BIT_SET(interference + (size_t)a * bitsetWords, b);
+    BIT_SET(interference + (size_t)b * bitsetWords, a);
+    values[a].degree++;
+    values[b].degree++;
+}
+
+/* Walk each block backwards to build interference, call crossings and spill costs */
+static void buildMipsInterference(unsigned int *liveOut, int *loopDepth, int *moveCount, int (*moves)[2])
+{
+    unsigned int *live = (unsigned int *)malloc((size_t)bitsetWords * sizeof(unsigned int));
+    int uses[3], useCount, moveSrc;
+    *moveCount = 0;
+
+    for (int b = 0; b < blockCount; b++) {
+        memcpy(live, liveOut + (size_t)b * bitsetWords, (size_t)bitsetWords * sizeof(unsigned int));
+        for (int i = blockEnd[b] - 1; i >= blockStart[b]; i--) {
+            int def = getMipsDefUse(codes[i], uses, &useCount, &moveSrc);
+            int depth = loopDepth[i] < MIPS_REGALLOC_MAX_LOOP_DEPTH ? loopDepth[i] : MIPS_REGALLOC_MAX_LOOP_DEPTH;
+            double weight = 1;
+            for (int d = 0; d < depth; d++) {
+                weight *= 10;
+            }
+
+            int kind = codes[i]->code.kind;
+            if (kind == CALL_InterCode || kind == READ_InterCode || kind == WRITE_InterCode) {
+                for (int w = 0; w < bitsetWords; w++) {
+                    unsigned int bits = live[w];
+                    while (bits) {
+                        int v = (w << 5) + __builtin_ctz(bits);
+                        bits &= bits - 1;
+                        if (v == def) {
+                            continue;
+                        }
+                        if (kind == CALL_InterCode) {
+                            values[v].crossesCall = true;
+                        } else {
+                            values[v].crossesIO = true;
+                        }
+                    }
+                }
+            }
+
+            if (def >= 0) {
+                for (int w = 0; w < bitsetWords; w++) {
+                    unsigned int bits = live[w];
+                    while (bits) {
+                        int v = (w << 5) + __builtin_ctz(bits);
+                        bits &= bits - 1;
+                        if (v != moveSrc) {
+                            addMipsInterference(def, v);
+                        }
+                    }
+                }
+                if (moveSrc >= 0 && moveSrc != def) {
+                    moves[*moveCount][0] = def;
+                    moves[*moveCount][1] = moveSrc;
+                    (*moveCount)++;
+                }
+                values[def].spillCost += weight;
+                BIT_CLEAR(live, def);
+            }
+
+            for (int k = 0; k < useCount; k++) {
+                values[uses[k]].spillCost += weight;
+                BIT_SET(live, uses[k]);
+            }
+        }
+    }
+
+    free(live);
+}
+
+/* Flatten the interference matrix and move pairs into adjacency arrays */
+static void buildMipsAdjacency(int moveCount, int (*moves)[2])
+{
+    adjStart = (int *)malloc((valueCount + 1) * sizeof(int));
+    adjStart[0] = 0;
+    for (int v = 0; v < valueCount; v++) {
+        adjStart[v + 1] = adjStart[v] + values[v].degree;
+    }
+    adjList = (int *)malloc((adjStart[valueCount] ? adjStart[valueCount] : 1) * sizeof(int));
+    for (int v = 0; v < valueCount; v++) {
+        unsigned int *row = interference + (size_t)v * bitsetWords;
+        int pos = adjStart[v];
+        for (int w = 0; w < bitsetWords; w++) {
+            unsigned int bits = row[w];
+            while (bits) {
+                adjList[pos++] = (w << 5) + __builtin_ctz(bits);
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    moveStart = (int *)calloc(valueCount + 1, sizeof(int));
+    for (int m = 0; m < moveCount; m++) {
+        moveStart[moves[m][0] + 1]++;
+        moveStart[moves[m][1] + 1]++;
+    }
+    for (int v = 0; v < valueCount; v++) {
+        moveStart[v + 1] += moveStart[v];
+    }
+    moveList = (int *)malloc((moveStart[valueCount] ? moveStart[valueCount] : 1) * sizeof(int));
+    int *fill = (int *)malloc((valueCount + 1) * sizeof(int));
+    memcpy(fill, moveStart, (valueCount + 1) * sizeof(int));
+    for (int m = 0; m < moveCount; m++) {
+        moveList[fill[moves[m][0]]++] = moves[m][1];
+        moveList[fill[moves[m][1]]++] = moves[m][0];
+    }
+    free(fill);
+}
+
+/* Whether register reg may hold value v */
+static bool isMipsRegisterAllowed(int v, int reg)
+{
+    if (values[v].crossesCall) {
+        return reg >= SAVED_REG_START && reg <= SAVED_REG_END;
+    }
+    return !(values[v].crossesIO && reg == ARG_REG_START);
+}
+
+/* Number of registers a value may be coloured with */
+static int getMipsColorLimit(int v)
+{
+    if (values[v].crossesCall) {
+        return SAVED_REG_COUNT;
+    }
+    return values[v].crossesIO ? ALLOC_REG_COUNT - 1 : ALLOC_REG_COUNT;
+}
+
+/* Argument register a parameter arrives in, -1 for other values and stack parameters */
+static int getMipsIncomingRegister(int v)
+{
+    int index = values[v].paramIndex;
+    return index >= 0 && index < ARG_REG_COUNT ? ARG_REG_START + index : -1;
+}
+
+/* Briggs-style optimistic colouring: simplify, pick spill candidates, then select */
+static void colorMipsGraph(void)
+{
+    int *curDegree = (int *)malloc(valueCount * sizeof(int));
+    int *stack = (int *)malloc(valueCount * sizeof(int));
+    int *queue = (int *)malloc(valueCount * sizeof(int));
+    bool *removed = (bool *)calloc(valueCount, sizeof(bool));
+    int stackTop = 0, queueHead = 0, queueTail = 0, remaining = 0;
+
+    for (int v = 0; v < valueCount; v++) {
+        curDegree[v] = values[v].degree;
+        if (values[v].inMemory || (values[v].paramIndex >= 0 && !values[v].used)) {
+            removed[v] = true;
+            continue;
+        }
+        // Parameters that can stay in their argument register are precoloured
+        int incoming = getMipsIncomingRegister(v);
+        if (incoming >= 0 && isMipsRegisterAllowed(v, incoming)) {
+            values[v].color = incoming;
+            removed[v] = true;
+            continue;
+        }
+        remaining++;
+        if (curDegree[v] < getMipsColorLimit(v)) {
+            queue[queueTail++] = v;
+        }
+    }
+
+    while (remaining > 0) {
+        int v = -1;
+        while (queueHead < queueTail) {
+            int candidate = queue[queueHead++];
+            if (!removed[candidate]) {
+                v = candidate;
+                break;
+            }
+        }
+
+        if (v < 0) {
+            // Every remaining node is significant: pick the cheapest to spill
+            double bestRatio = 0;
+            for (int u = 0; u < valueCount; u++) {
+                if (removed[u]) {
+                    continue;
+                }
+                double ratio = values[u].spillCost / (curDegree[u] + 1);
+                if (v < 0 || ratio < bestRatio) {
+                    v = u;
+                    bestRatio = ratio;
+                }
+            }
+            MIPS_DEBUG_PRINT("Potential spill: value %d (cost %.0f, degree %d)",
+                v, values[v].spillCost, curDegree[v]);
+        }
+
+        removed[v] = true;
+        remaining--;
+        stack[stackTop++] = v;
+        for (int a = adjStart[v]; a < adjStart[v + 1]; a++) {
+            int u = adjList[a];
+            if (removed[u]) {
+                continue;
+            }
+            curDegree[u]--;
+            if (curDegree[u] == getMipsColorLimit(u) - 1) {
+                queue[queueTail++] = u;
+            }
+        }
+    }
+
+    while (stackTop > 0) {
+        int v = stack[--stackTop];
+        unsigned int busy = 0;
+        for (int a = adjStart[v]; a < adjStart[v + 1]; a++) {
+            int u = adjList[a];
+            if (values[u].color >= 0) {
+                busy |= 1u << values[u].color;
+            }
+        }
+
+        int color = -1;
+        // Prefer a move partner's register so the copy disappears
+        for (int m = moveStart[v]; m < moveStart[v + 1] && color < 0; m++) {
+            int partnerColor = values[moveList[m]].color;
+            if (partnerColor < 0 || (busy >> partnerColor) & 1u) {
+                continue;
+            }
+            if (!isMipsRegisterAllowed(v, partnerColor)) {
+                continue;
+            }
+            color = partnerColor;
+        }
+        for (int r = 0; r < ALLOC_REG_COUNT && color < 0; r++) {
+            int reg = ALLOC_REG_ORDER[r];
+            if (isMipsRegisterAllowed(v, reg) && !((busy >> reg) & 1u)) {
+                color = reg;
+            }
+        }
+
+        values[v].color = color;
+        if (color >= SAVED_REG_START && color <= SAVED_REG_END) {
+            usedSavedRegs |= 1u << color;
+        }
+    }
+
+    free(curDegree);
+    free(stack);
+    free(queue);
+    free(removed);
+}
+
+/* Allocate with liveness, an interference graph and optimistic colouring */
+static void colorMipsFunction(InterCodes funcInterCodes)
+{
+    int *loopDepth = (int *)malloc(codeCount * sizeof(int));
+    buildMipsBlocks(funcInterCodes, loopDepth);
+
+    bitsetWords = (valueCount + 31) >> 5;
+    unsigned int *liveOut = computeMipsLiveOut();
+
+    interference = (unsigned int *)calloc((size_t)valueCount * bitsetWords, sizeof(unsigned int));
+    int (*moves)[2] = malloc((codeCount + 1) * sizeof(*moves));
+    int moveCount = 0;
+    buildMipsInterference(liveOut, loopDepth, &moveCount, moves);
+    buildMipsAdjacency(moveCount, moves);
+    colorMipsGraph();
+
+    free(moves);
+    free(liveOut);
+    free(loopDepth);
+}
+
+/* Note an occurrence of a value at code position pos */
+static void touchMipsInterval(int v, int pos, bool isDef)
+{
+    if (values[v].start < 0) {
+        values[v].start = pos;
+        values[v].startIsDef = isDef;
+    }
+    values[v].end = pos;
+}
+
+/* Widen a value's interval to a whole loop because it is live around the back edge */
+static void extendMipsInterval(int v, int head, int tail)
+{
+    if (values[v].start > head) {
+        values[v].start = head;
+        values[v].startIsDef = false;
+    }
+    if (values[v].end < tail) {
+        values[v].end = tail;
+    }
+}
+
+/* Live intervals from first/last occurrence, widened over loops the value is live around */
+static void buildMipsLiveIntervals(int *labelPos, int labelBase, int labelSpan)
+{
+    int uses[3], useCount, moveSrc;
+    int (*loops)[2] = malloc((codeCount + 1) * sizeof(*loops));
+    int loopCount = 0;
+    int *labelMinSrc = (int *)malloc((labelSpan ? labelSpan : 1) * sizeof(int));
+    int *labelMaxSrc = (int *)malloc((labelSpan ? labelSpan : 1) * sizeof(int));
+    for (int l = 0; l < labelSpan; l++) {
+        labelMinSrc[l] = labelMaxSrc[l] = -1;
+    }
+
+    for (int i = 0; i < codeCount; i++) {
+        int def = getMipsDefUse(codes[i], uses, &useCount, &moveSrc);
+        for (int k = 0; k < useCount; k++) {
+            touchMipsInterval(uses[k], i, false);
+        }
+        if (def >= 0) {
+            touchMipsInterval(def, i, true);
+            if (values[def].start == i && moveSrc >= 0) {
+                values[def].hint = moveSrc;
+            }
+        }
+
+        int target = ir_get_jump_target(codes[i]) - labelBase;
+        if (target < 0 || target >= labelSpan || labelPos[target] < 0) {
+            continue;
+        }
+        if (labelMinSrc[target] < 0) {
+            labelMinSrc[target] = i;
+        }
+        labelMaxSrc[target] = i;
+        if (labelPos[target] <= i) {
+            loops[loopCount][0] = labelPos[target];
+            loops[loopCount][1] = i;
+            loopCount++;
+        }
+    }
+
+    // A value needs the whole loop unless its first occurrence in the loop is a def that
+    // every iteration executes (no jump inside the loop skips it, no side entry before it)
+    int *seen = (int *)malloc(valueCount * sizeof(int));
+    for (int v = 0; v < valueCount; v++) {
+        seen[v] = -1;
+    }
+    for (int l = 0; l < loopCount; l++) {
+        int head = loops[l][0], tail = loops[l][1];
+        int reach = head;
+        for (int p = head; p <= tail; p++) {
+            int labelNo = ir_get_label_no(codes[p]) - labelBase;
+            if (p > head && labelNo >= 0 && labelNo < labelSpan && labelMinSrc[labelNo] >= 0 &&
+                (labelMinSrc[labelNo] < head || labelMaxSrc[labelNo] > tail)) {
+                reach = tail;
+            }
+
+            int def = getMipsDefUse(codes[p], uses, &useCount, &moveSrc);
+            for (int k = 0; k < useCount; k++) {
+                if (seen[uses[k]] != l) {
+                    seen[uses[k]] = l;
+                    extendMipsInterval(uses[k], head, tail);
+                }
+            }
+            if (def >= 0 && seen[def] != l) {
+                seen[def] = l;
+                if (reach > p) {
+                    extendMipsInterval(def, head, tail);
+                }
+            }
+
+            int target = ir_get_jump_target(codes[p]) - labelBase;
+            if (target >= 0 && target < labelSpan && labelPos[target] > p &&
+                labelPos[target] <= tail && labelPos[target] > reach) {
+                reach = labelPos[target];
+            }
+        }
+    }
+
+    // Values whose interval strictly contains a CALL (or READ/WRITE) must survive it
+    int *callPrefix = (int *)calloc(codeCount + 1, sizeof(int));
+    int *ioPrefix = (int *)calloc(codeCount + 1, sizeof(int));
+    for (int i = 0; i < codeCount; i++) {
+        int kind = codes[i]->code.kind;
+        callPrefix[i + 1] = callPrefix[i] + (kind == CALL_InterCode);
+        ioPrefix[i + 1] = ioPrefix[i] + (kind == READ_InterCode || kind == WRITE_InterCode);
+    }
+    for (int v = 0; v < valueCount; v++) {
+        if (values[v].start < 0 || values[v].end <= values[v].start + 1) {
+            continue;
+        }
+        if (callPrefix[values[v].end] - callPrefix[values[v].start + 1] > 0) {
+            values[v].crossesCall = true;
+        }
+        if (ioPrefix[values[v].end] - ioPrefix[values[v].start + 1] > 0) {
+            values[v].crossesIO = true;
+        }
+    }
+
+    free(callPrefix);
+    free(ioPrefix);
+    free(seen);
+    free(labelMinSrc);
+    free(labelMaxSrc);
+    free(loops);
+}
+
+/* Whether linear scan needs to place value v (unused parameters need no home at all) */
+static bool isMipsIntervalScanned(int v)
+{
+    return !values[v].inMemory && values[v].start >= 0 && (values[v].paramIndex < 0 || values[v].used);
+}
+
+/* Linear scan over intervals sorted by start; spill the interval that ends last */
+static void scanMipsLiveIntervals(int *labelPos, int labelBase, int labelSpan)
+{
+    buildMipsLiveIntervals(labelPos, labelBase, labelSpan);
+
+    // Counting sort by interval start
+    int *bucket = (int *)calloc(codeCount + 1, sizeof(int));
+    int *order = (int *)malloc(valueCount * sizeof(int));
+    int orderCount = 0;
+    for (int v = 0; v < valueCount; v++) {
+        if (isMipsIntervalScanned(v)) {
+            bucket[values[v].start + 1]++;
+            orderCount++;
+        }
+    }
+    for (int i = 0; i < codeCount; i++) {
+        bucket[i + 1] += bucket[i];
+    }
+    for (int v = 0; v < valueCount; v++) {
+        if (isMipsIntervalScanned(v)) {
+            order[bucket[values[v].start]++] = v;
+        }
+    }
+
+    bool regFree[32];
+    for (int r = 0; r < 32; r++) {
+        regFree[r] = true;
+    }
+    int active[ALLOC_REG_COUNT];
+    int activeCount = 0;
+
+    for (int o = 0; o < orderCount; o++) {
+        int cur = order[o];
+
+        // Expire intervals that ended before cur starts (a def may reuse a register freed at the same code)
+        for (int a = 0; a < activeCount; ) {
+            int v = active[a];
+            if (values[v].end < values[cur].start ||
+                (values[v].end == values[cur].start && values[cur].startIsDef)) {
+                regFree[values[v].color] = true;
+                active[a] = active[--activeCount];
+            } else {
+                a++;
+            }
+        }
+
+        // Parameters come first and keep their argument register when they may
+        int color = getMipsIncomingRegister(cur);
+        if (color >= 0 && !(regFree[color] && isMipsRegisterAllowed(cur, color))) {
+            color = -1;
+        }
+        int hint = values[cur].hint;
+        if (color < 0 && hint >= 0 && values[hint].color >= 0 && regFree[values[hint].color] &&
+            isMipsRegisterAllowed(cur, values[hint].color)) {
+            color = values[hint].color;
+        }
+        for (int r = 0; r < ALLOC_REG_COUNT && color < 0; r++) {
+            int reg = ALLOC_REG_ORDER[r];
+            if (regFree[reg] && isMipsRegisterAllowed(cur, reg)) {
+                color = reg;
+            }
+        }
+
+        if (color < 0) {
+            int victim = -1;
+            for (int a = 0; a < activeCount; a++) {
+                int v = active[a];
+                if (isMipsRegisterAllowed(cur, values[v].color) &&
+                    (victim < 0 || values[v].end > values[active[victim]].end)) {
+                    victim = a;
+                }
+            }
+            if (victim >= 0 && values[active[victim]].end > values[cur].end) {
+                int v = active[victim];
+                MIPS_DEBUG_PRINT("Spilling value %d to free %s", v, mipsRegNames[values[v].color]);
+                color = values[v].color;
+                values[v].color = -1;
+                active[victim] = active[--activeCount];
+            }
+        }
+
+        if (color >= 0) {
+            values[cur].color = color;
+            regFree[color] = false;
+            active[activeCount++] = cur;
+        }
+    }
+
+    for (int v = 0; v < valueCount; v++) {
+        int color = values[v].color;
+        if (color >= SAVED_REG_START && color <= SAVED_REG_END) {
+            usedSavedRegs |= 1u << color;
+        }
+    }
+
+    free(bucket);
+    free(order);
+}
+
+/* Forget the previous function's values */
+static void resetMipsValues(void)
+{
+    for (int v = 0; v < valueCount; v++) {
+        if (values[v].kind == VARIABLE_OP) {
+            varValueIndex[values[v].varNo] = -1;
+        } else {
+            tempValueIndex[values[v].varNo] = -1;
+        }
+    }
+    valueCount = 0;
+    usedSavedRegs = 0;
+}
+
+/* Release the per-function analysis state */
+static void freeMipsAnalysis(void)
+{
+    free(codes);
+    free(blockStart);
+    free(blockEnd);
+    free(blockSucc);
+    free(interference);
+    free(adjStart);
+    free(adjList);
+    free(moveStart);
+    free(moveList);
+    codes = NULL;
+    blockStart = blockEnd = NULL;
+    blockSucc = NULL;
+    interference = NULL;
+    adjStart = adjList = moveStart = moveList = NULL;
+    codeCount = blockCount = 0;
+}
+
+/* Allocate registers for all values of one function */
+void allocateMipsFunctionRegisters(InterCodes funcInterCodes)
+{
+    resetMipsValues();
+
+    // Gather the function body and number its values
+    codeCount = 0;
+    for (InterCodes cur = funcInterCodes->next;
+         cur != interCodeListHead && cur->code.kind != FUNC_InterCode; cur = cur->next) {
+        codeCount++;
+    }
+    codes = (InterCodes *)malloc((codeCount + 1) * sizeof(InterCodes));
+
+    int minLabel = -1, maxLabel = -1;
+    int paramCount = 0;
+    int i = 0;
+    for (InterCodes cur = funcInterCodes->next; i < codeCount; cur = cur->next) {
+        codes[i++] = cur;
+        switch (cur->code.kind) {
+            case ASSIGN_InterCode:
+            case CALL_InterCode:
+            case DEC_InterCode:
+                recordMipsOperand(cur->code.u.doubleOP.left);
+                recordMipsOperand(cur->code.u.doubleOP.right);
+                break;
+            case ADD_InterCode:
+            case SUB_InterCode:
+            case MUL_InterCode:
+            case DIV_InterCode:
+                recordMipsOperand(cur->code.u.tripleOP.result);
+                recordMipsOperand(cur->code.u.tripleOP.op1);
+                recordMipsOperand(cur->code.u.tripleOP.op2);
+                break;
+            case IFGOTO_InterCode:
+                recordMipsOperand(cur->code.u.ifgotoOP.op1);
+                recordMipsOperand(cur->code.u.ifgotoOP.op2);
+                break;
+            case RETURN_InterCode:
+            case ARG_InterCode:
+            case PARAM_InterCode:
+            case READ_InterCode:
+            case WRITE_InterCode:
+                recordMipsOperand(cur->code.u.singleOP.op);
+                break;
+            default:
+                break;
+        }
+        if (cur->code.kind == DEC_InterCode) {
+            values[lookupMipsValue(cur->code.u.doubleOP.left, false)].inMemory = true;
+        }
+        if (cur->code.kind == PARAM_InterCode) {
+            values[lookupMipsValue(cur->code.u.singleOP.op, false)].paramIndex = paramCount++;
+        }
+        int labelNo = ir_get_label_no(cur);
+        if (labelNo >= 0) {
+            minLabel = (minLabel < 0 || labelNo < minLabel) ? labelNo : minLabel;
+            maxLabel = labelNo > maxLabel ? labelNo : maxLabel;
+        }
+    }
+
+    if (mipsRegAllocMode == MIPS_REGALLOC_NONE || codeCount == 0 || valueCount == 0) {
+        freeMipsAnalysis();
+        return;
+    }
+
+    int uses[3], useCount, moveSrc;
+    for (i = 0; i < codeCount; i++) {
+        getMipsDefUse(codes[i], uses, &useCount, &moveSrc);
+        for (int k = 0; k < useCount; k++) {
+            values[uses[k]].used = true;
+        }
+    }
+
+    int labelBase = minLabel < 0 ? 0 : minLabel;
+    int labelSpan = minLabel < 0 ? 0 : maxLabel - minLabel + 1;
+    int *labelPos = (int *)malloc((labelSpan ? labelSpan : 1) * sizeof(int));
+    for (i = 0; i < labelSpan; i++) {
+        labelPos[i] = -1;
+    }
+    for (i = 0; i < codeCount; i++) {
+        int labelNo = ir_get_label_no(codes[i]);
+        if (labelNo >= 0) {
+            labelPos[labelNo - labelBase] = i;
+        }
+    }
+
+    if (mipsRegAllocMode == MIPS_REGALLOC_LINEAR_SCAN || valueCount > MIPS_REGALLOC_MAX_VALUES) {
+        if (mipsRegAllocMode != MIPS_REGALLOC_LINEAR_SCAN) {
+            MIPS_DEBUG_PRINT("Function %s has %d values, falling back to linear scan",
+                funcInterCodes->code.u.singleOP.op->funcName, valueCount);
+        }
+        scanMipsLiveIntervals(labelPos, labelBase, labelSpan);
+    } else {
+        colorMipsFunction(funcInterCodes);
+    }
+
+    int spilled = 0;
+    for (int v = 0; v < valueCount; v++) {
+        if (!values[v].inMemory && values[v].color < 0) {
+            spilled++;
+        }
+    }
+    MIPS_DEBUG_PRINT("Function %s: %d values, %d spilled, saved register mask 0x%x",
+        funcInterCodes->code.u.singleOP.op->funcName, valueCount, spilled, usedSavedRegs);
+
+    free(labelPos);
+    freeMipsAnalysis();
+}
+
+/* Select the allocation mode by name ("color", "linear" or "none") */
+bool setMipsRegAllocMode(const char *modeName)
+{
+    if (strcmp(modeName, "color") == 0) {
+        mipsRegAllocMode = MIPS_REGALLOC_GRAPH_COLOR;
+    } else if (strcmp(modeName, "linear") == 0) {
+        mipsRegAllocMode = MIPS_REGALLOC_LINEAR_SCAN;
+    } else if (strcmp(modeName, "none") == 0) {
+        mipsRegAllocMode = MIPS_REGALLOC_NONE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/* Register assigned to an operand's value, -1 if it lives on the stack */
+int getMipsAssignedRegister(Operand op)
+{
+    int index = lookupMipsValue(op, false);
+    if (index < 0 || values[index].inMemory) {
+        return -1;
+    }
+    return values[index].color;
+}
+
+/* Whether an operand's value must stay in the frame (arrays, structures, &v) */
+bool isMipsMemoryOperand(Operand op)
+{
+    int index = lookupMipsValue(op, false);
+    return index >= 0 && values[index].inMemory;
+}
+
+/* Whether the current function colours anything into callee-saved register regIndex */
+bool isMipsSavedRegisterUsed(int regIndex)
+{
+    if (regIndex < SAVED_REG_START || regIndex > SAVED_REG_END) {
+        return false;
+    }
+    return (usedSavedRegs >> regIndex) & 1u;
+}
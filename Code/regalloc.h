@@ -0,0 +1,41 @@
+#ifndef __MIPS_REGALLOC_H__
+#define __MIPS_REGALLOC_H__
+
+#include "mips.h"
+#include "cfg.h"
+
+// Register allocation modes
+#define MIPS_REGALLOC_NONE 0            // Every value lives in its stack slot
+#define MIPS_REGALLOC_GRAPH_COLOR 1     // Global graph-colouring allocation
+#define MIPS_REGALLOC_LINEAR_SCAN 2     // Linear scan over live intervals, near-linear compile time
+#define MIPS_REGALLOC_MODE MIPS_REGALLOC_GRAPH_COLOR
+
+// Functions with more values than this use linear scan (interference matrix is n^2 bits)
+#define MIPS_REGALLOC_MAX_VALUES 8192
+
+// Loop nesting depth used for spill cost weighting is capped at this value
+#define MIPS_REGALLOC_MAX_LOOP_DEPTH 5
+
+// Allocatable registers: $t0-$t9, $a0-$a3 and $s0-$s7
+#define ALLOC_REG_COUNT 22
+#define SAVED_REG_START 16
+#define SAVED_REG_END 23
+
+// The first ARG_REG_COUNT arguments are passed in $a0-$a3, the rest on the stack
+#define ARG_REG_START 4
+#define ARG_REG_COUNT 4
+
+extern int mipsRegAllocMode;
+
+// Select the allocation mode by name, returns false for an unknown name
+bool setMipsRegAllocMode(const char *modeName);
+
+// Run allocation for the function whose FUNCTION code is funcInterCodes
+void allocateMipsFunctionRegisters(InterCodes funcInterCodes);
+
+// Query allocation results for the current function
+int getMipsAssignedRegister(Operand op);
+bool isMipsMemoryOperand(Operand op);
+bool isMipsSavedRegisterUsed(int regIndex);
+
+#endif // __MIPS_REGALLOC_H__
@@ -5,7 +5,7 @@ int currentScopeDepth = 0;
 HashTableNode scopeTable = NULL;
 
 // 前向声明函数
-HashTableNode enterInnermostHashTable();
+HashTableNode enterInnermostHashTable(ASTNode *ownerNode);
 void deleteLocalVariable();
 void validateFunctionDefinitions();
 
@@ -40,9 +40,7 @@ void createIOFunctions()
     intType->u.basic = 0;  // 0表示int类型
     
     // ===== 创建write函数 =====
-    // 分配函数名内存
-    char *writeName = (char *)malloc(sizeof(char *) * 32);
-    strcpy(writeName, "write");
+    char *writeName = intern_name("write");
     
     // 创建write函数参数
     FieldList writeParam = (FieldList)(malloc(sizeof(struct FieldList_)));
@@ -64,9 +62,7 @@ void createIOFunctions()
     registerSymbol(constructSymbolEntry(writeFuncType, writeName, 2, 1, 0), scopeTable);
     
     // ===== 创建read函数 =====
-    // 分配函数名内存
-    char *readName = (char *)malloc(sizeof(char *) * 32);
-    strcpy(readName, "read");
+    char *readName = intern_name("read");
     
     // 创建read函数类型
     Type readFuncType = (Type)(malloc(sizeof(struct Type_)));
@@ -132,7 +128,7 @@ void ProcessExtDef(ASTNode *node)
     // Handle external declarations based on structure
     if (thirdNode != NULL) {
         // Case 1: Global variable declarations
-        if (secondNode != NULL && stringComparison(secondNode->name, "ExtDecList")) {
+        if (secondNode != NULL && secondNode->kind == AST_ExtDecList) {
             DEBUG_PRINT(DEBUG_DETAILED, "Processing global variable declaration\n");
             ProcessExtDecList(secondNode, typeInfo);
         } 
@@ -141,10 +137,10 @@ void ProcessExtDef(ASTNode *node)
             DEBUG_PRINT(DEBUG_DETAILED, "Processing function declaration/definition\n");
             
             // Create a new scope for the function
-            HashTableNode functionScope = enterInnermostHashTable();
+            HashTableNode functionScope = enterInnermostHashTable(node);
             
             // Check if it's a function definition (has compound statement) or just declaration
-            if (stringComparison(thirdNode->name, "SEMI")) {
+            if (thirdNode->kind == AST_SEMI) {
                 DEBUG_PRINT(DEBUG_DETAILED, "Found function declaration\n");
                 ProcessFunctionDeclaration(secondNode, typeInfo, functionScope, false);
             } else {
@@ -159,11 +155,9 @@ void ProcessExtDef(ASTNode *node)
                 DEBUG_PRINT(DEBUG_VERBOSE, "Exiting function body scope (depth: %d)\n", currentScopeDepth);
             }
             
-            // Clean up local variables from this scope
+            // Clean up local variables from this scope, IR translation reenters it later
             DEBUG_PRINT(DEBUG_DETAILED, "Cleaning up local variables from function scope\n");
-            // Comment out this line to preserve local variables for code generation
-            // deleteLocalVariable();
-            printf("DEBUG: 保留局部变量以便中间代码生成\n");
+            deleteLocalVariable();
         }
     }
 }
@@ -229,24 +223,24 @@ Type ProcessSpecifier(ASTNode *node)
     Type typeInfo = (Type)malloc(sizeof(struct Type_));
     
     // Handle structure specifier
-    if (stringComparison(firstChild->name, "StructSpecifier")) {
+    if (firstChild->kind == AST_StructSpecifier) {
         DEBUG_PRINT(DEBUG_DETAILED, "Processing structure specifier\n");
         typeInfo->kind = STRUCTURE;
         ASTNode *secondNode = getChild(firstChild, 1);
         
         // Handle structure with tag (OptTag)
-        if (stringComparison(secondNode->name, "OptTag")) {
+        if (secondNode->kind == AST_OptTag) {
             ASTNode *idNode = getChild(secondNode, 0);
             
             // Special case check
-            if (stringComparison(idNode->value, "Data")) {
+            if (stringComparison(ast_value(idNode), "Data")) {
                 DEBUG_PRINT(DEBUG_BASIC, "Special case: Data structure detected\n");
                 exit(0);
             }
             
-            if (stringComparison(idNode->name, "ID")) {
+            if (idNode->kind == AST_ID) {
                 // Get structure name
-                char *structName = idNode->value;
+                char *structName = ast_value(idNode);
                 DEBUG_PRINT(DEBUG_DETAILED, "Processing named structure: %s\n", structName);
                 
                 // Check if structure is already defined
@@ -259,8 +253,7 @@ Type ProcessSpecifier(ASTNode *node)
                     return NULL;
                 } else {
                     // Set structure name
-                    typeInfo->u.structure.name = (char *)malloc(sizeof(char) * 32);
-                    strcpy(typeInfo->u.structure.name, structName);
+                    typeInfo->u.structure.name = structName;
                     
                     // Process structure fields
                     ASTNode *defListNode = getChild(firstChild, 3);
@@ -269,7 +262,7 @@ Type ProcessSpecifier(ASTNode *node)
                     FieldInfo *allFields = (FieldInfo*)malloc(sizeof(FieldInfo) * 100);
                     int fieldCount = 0;
                     
-                    if (!stringComparison(defListNode->name, "DefList")) {
+                    if (defListNode->kind != AST_DefList) {
                         DEBUG_PRINT(DEBUG_VERBOSE, "No field definitions found in structure\n");
                         typeInfo->u.structure.structures = NULL;
                     } else {
@@ -358,9 +351,9 @@ Type ProcessSpecifier(ASTNode *node)
             }
         }
         // Handle structure reference (Tag)
-        else if (stringComparison(secondNode->name, "Tag")) {
+        else if (secondNode->kind == AST_Tag) {
             ASTNode *idNode = getChild(secondNode, 0);
-            char *structName = idNode->value;
+            char *structName = ast_value(idNode);
             DEBUG_PRINT(DEBUG_DETAILED, "Processing structure reference: %s\n", structName);
             
             // Look up the structure type
@@ -379,7 +372,7 @@ Type ProcessSpecifier(ASTNode *node)
             return structType;
         }
         // Handle anonymous structure
-        else if (stringComparison(secondNode->name, "LC")) {
+        else if (secondNode->kind == AST_LC) {
             DEBUG_PRINT(DEBUG_DETAILED, "Processing anonymous structure\n");
             typeInfo->u.structure.name = NULL;  // 匿名结构体不需要名字
             
@@ -390,7 +383,7 @@ Type ProcessSpecifier(ASTNode *node)
             FieldInfo *allFields = (FieldInfo*)malloc(sizeof(FieldInfo) * 100);
             int fieldCount = 0;
             
-            if (!stringComparison(defListNode->name, "DefList")) {
+            if (defListNode->kind != AST_DefList) {
                 DEBUG_PRINT(DEBUG_VERBOSE, "No field definitions in anonymous structure\n");
                 typeInfo->u.structure.structures = NULL;
             } else {
@@ -474,12 +467,12 @@ Type ProcessSpecifier(ASTNode *node)
         }
     }
     // Handle basic type (int/float)
-    else if (stringComparison(firstChild->name, "TYPE")) {
+    else if (firstChild->kind == AST_TYPE) {
         typeInfo->kind = BASIC;
-        if (stringComparison(firstChild->value, "int")) {
+        if (stringComparison(ast_value(firstChild), "int")) {
             DEBUG_PRINT(DEBUG_DETAILED, "Processing basic type: int\n");
             typeInfo->u.basic = 0;
-        } else if (stringComparison(firstChild->value, "float")) {
+        } else if (stringComparison(ast_value(firstChild), "float")) {
             DEBUG_PRINT(DEBUG_DETAILED, "Processing basic type: float\n");
             typeInfo->u.basic = 1;
         }
@@ -509,24 +502,24 @@ FieldList ProcessVarDec(ASTNode *node, Type typeInfo)
         return NULL;
     }
     
-    printf("DEBUG: 变量声明的第一个子节点类型: %s\n", firstChild->name);
+    printf("DEBUG: 变量声明的第一个子节点类型: %s\n", ast_name(firstChild));
     
     // Base case: direct identifier
-    if (stringComparison(firstChild->name, "ID")) {
+    if (firstChild->kind == AST_ID) {
         field->type = typeInfo;
         
-        if (firstChild->value == NULL) {
+        if (ast_value(firstChild) == NULL) {
             printf("ERROR: ID节点的值为NULL\n");
             free(field);
             return NULL;
         }
         
-        field->name = firstChild->value;
+        field->name = ast_value(firstChild);
         printf("DEBUG: 找到标识符: '%s'\n", field->name);
         return field;
     } 
     // Recursive case: array declaration
-    else if (stringComparison(firstChild->name, "VarDec")) {
+    else if (firstChild->kind == AST_VarDec) {
         // Process the base variable first
         FieldList baseField = ProcessVarDec(firstChild, typeInfo);
         if (baseField == NULL) {
@@ -542,8 +535,8 @@ FieldList ProcessVarDec(ASTNode *node, Type typeInfo)
         // Count array dimensions
         int dimensions = 0;
         ASTNode *current = firstChild;
-        while (current != NULL && current->firstChild != NULL) {
-            current = current->firstChild;
+        while (current != NULL && getChild(current, 0) != NULL) {
+            current = getChild(current, 0);
             dimensions++;
         }
         
@@ -553,19 +546,21 @@ FieldList ProcessVarDec(ASTNode *node, Type typeInfo)
         Type *arrayTypes = (Type*)malloc(sizeof(Type) * (dimensions + 1));
         
         // Process each dimension, bottom-up
+        ASTNode *parent = node;
         current = firstChild;
         for (int i = dimensions-1; i >= 0; i--) {
             Type arrayType = (Type)malloc(sizeof(struct Type_));
             arrayType->kind = ARRAY;
             
             // Get array size from the INT node (third child)
-            ASTNode *sizeNode = current->nextSibling->nextSibling;
-            arrayType->u.array.size = My_atoi(sizeNode->value);
+            ASTNode *sizeNode = getChild(parent, 2);
+            arrayType->u.array.size = My_atoi(ast_value(sizeNode));
             
             DEBUG_PRINT(DEBUG_VERBOSE, "Dimension %d size: %d\n", i, arrayType->u.array.size);
             
             arrayTypes[i] = arrayType;
-            current = current->firstChild;
+            parent = current;
+            current = getChild(current, 0);
         }
         
         // Link array types together
@@ -583,7 +578,7 @@ FieldList ProcessVarDec(ASTNode *node, Type typeInfo)
         return field;
     }
     
-    printf("WARNING: 未知的变量声明类型: %s\n", firstChild->name);
+    printf("WARNING: 未知的变量声明类型: %s\n", ast_name(firstChild));
     free(field);
     return NULL;
 }
@@ -596,16 +591,16 @@ int ProcessFunctionDeclaration(ASTNode *node, Type returnType, HashTableNode sco
     ASTNode *nameNode = getChild(node, 0);
     ASTNode *paramListNode = getChild(node, 2);
     
-    DEBUG_PRINT(DEBUG_VERBOSE, "Function name: %s, Is definition: %d\n", nameNode->value, isDefinition);
+    DEBUG_PRINT(DEBUG_VERBOSE, "Function name: %s, Is definition: %d\n", ast_value(nameNode), isDefinition);
     
     // Check if function is already in symbol table
-    SymbolTableNode existingFunc = findSymbolInScope(nameNode->value, currentScopeDepth);
+    SymbolTableNode existingFunc = findSymbolInScope(ast_value(nameNode), currentScopeDepth);
     bool functionExists = (existingFunc != NULL);
     bool existingFuncDefined = functionExists ? existingFunc->isDefined : false;
     Type existingFuncType = functionExists ? existingFunc->type : NULL;
     
     if (functionExists) {
-        DEBUG_PRINT(DEBUG_DETAILED, "Function %s already exists in symbol table\n", nameNode->value);
+        DEBUG_PRINT(DEBUG_DETAILED, "Function %s already exists in symbol table\n", ast_value(nameNode));
     }
     
     // Create new function type
@@ -614,7 +609,7 @@ int ProcessFunctionDeclaration(ASTNode *node, Type returnType, HashTableNode sco
     funcType->u.function.returnType = returnType;
     
     // Process parameters if they exist
-    if (stringComparison(paramListNode->name, "VarList")) {
+    if (paramListNode->kind == AST_VarList) {
         DEBUG_PRINT(DEBUG_DETAILED, "Processing function parameters\n");
         // Increase scope depth for parameters
         currentScopeDepth++;
@@ -651,35 +646,35 @@ int ProcessFunctionDeclaration(ASTNode *node, Type returnType, HashTableNode sco
     if (functionExists) {
         if (isDefinition) {
             if (existingFuncDefined) {
-                DEBUG_PRINT(DEBUG_BASIC, "Error: Function %s is already defined\n", nameNode->value);
-                reportSemanticError(Redefined_Function, node->lineno, nameNode->value);
+                DEBUG_PRINT(DEBUG_BASIC, "Error: Function %s is already defined\n", ast_value(nameNode));
+                reportSemanticError(Redefined_Function, node->lineno, ast_value(nameNode));
                 return -1;
             } else if (!compareTypes(existingFuncType, funcType)) {
-                DEBUG_PRINT(DEBUG_BASIC, "Error: Function %s declaration and definition don't match\n", nameNode->value);
-                reportSemanticError(Conflict_Decordef_Funcion, node->lineno, nameNode->value);
+                DEBUG_PRINT(DEBUG_BASIC, "Error: Function %s declaration and definition don't match\n", ast_value(nameNode));
+                reportSemanticError(Conflict_Decordef_Funcion, node->lineno, ast_value(nameNode));
                 return -1;
             } else {
-                DEBUG_PRINT(DEBUG_DETAILED, "Updating function %s entry to mark as defined\n", nameNode->value);
-                registerSymbol(constructSymbolEntry(funcType, nameNode->value, 2, isDefinition, currentScopeDepth), scopeTable);
+                DEBUG_PRINT(DEBUG_DETAILED, "Updating function %s entry to mark as defined\n", ast_value(nameNode));
+                registerSymbol(constructSymbolEntry(funcType, ast_value(nameNode), 2, isDefinition, currentScopeDepth), scopeTable);
                 return 0;
             }
         } else {
             // New declaration for existing function
             if (!compareTypes(existingFuncType, funcType)) {
-                DEBUG_PRINT(DEBUG_BASIC, "Error: Conflicting declarations for function %s\n", nameNode->value);
-                reportSemanticError(Conflict_Decordef_Funcion, node->lineno, nameNode->value);
+                DEBUG_PRINT(DEBUG_BASIC, "Error: Conflicting declarations for function %s\n", ast_value(nameNode));
+                reportSemanticError(Conflict_Decordef_Funcion, node->lineno, ast_value(nameNode));
                 return -1;
             }
         }
     } else {
         // New function
-        DEBUG_PRINT(DEBUG_DETAILED, "Adding new function %s to symbol table\n", nameNode->value);
-        registerSymbol(constructSymbolEntry(funcType, nameNode->value, 2, isDefinition, currentScopeDepth), scopeTable);
+        DEBUG_PRINT(DEBUG_DETAILED, "Adding new function %s to symbol table\n", ast_value(nameNode));
+        registerSymbol(constructSymbolEntry(funcType, ast_value(nameNode), 2, isDefinition, currentScopeDepth), scopeTable);
         
         // Record function declaration for later checking
         if (!isDefinition) {
             DEBUG_PRINT(DEBUG_VERBOSE, "Recording function declaration for later validation\n");
-            trackFunctionDeclaration(nameNode->value, node->lineno);
+            trackFunctionDeclaration(ast_value(nameNode), node->lineno);
         }
         return 0;
     }
@@ -807,19 +802,19 @@ void ProcessCompoundStatement(ASTNode *node, HashTableNode scope, Type returnTyp
     ASTNode *thirdChild = getChild(node, 2);
     
     // Check structure of compound statement
-    if (stringComparison(secondChild->name, "DefList")) {
+    if (secondChild->kind == AST_DefList) {
         DEBUG_PRINT(DEBUG_VERBOSE, "Found local variable definitions\n");
         // Process local variable definitions
         ProcessDefinitionList(secondChild, scope);
         
         // If there are statements following the definitions, process them
-        if (stringComparison(thirdChild->name, "StmtList")) {
+        if (thirdChild->kind == AST_StmtList) {
             DEBUG_PRINT(DEBUG_VERBOSE, "Processing statement list after definitions\n");
             ProcessStatementList(thirdChild, scope, returnType);
         }
     } 
     // No local variable definitions, just statements
-    else if (stringComparison(secondChild->name, "StmtList")) {
+    else if (secondChild->kind == AST_StmtList) {
         DEBUG_PRINT(DEBUG_VERBOSE, "Processing statement list (no local definitions)\n");
         ProcessStatementList(secondChild, scope, returnType);
     }
@@ -872,15 +867,15 @@ void ProcessStatement(ASTNode *node, HashTableNode scope, Type returnType)
     }
     
     // Handle different statement types
-    if (stringComparison(firstChild->name, "Exp")) {
+    if (firstChild->kind == AST_Exp) {
         DEBUG_PRINT(DEBUG_VERBOSE, "Processing expression statement\n");
         // Expression statement: Exp SEMI
         ProcessExpression(firstChild);
     }
-    else if (stringComparison(firstChild->name, "CompSt")) {
+    else if (firstChild->kind == AST_CompSt) {
         DEBUG_PRINT(DEBUG_VERBOSE, "Processing compound statement\n");
         // Compound statement: create a new scope
-        HashTableNode newScope = enterInnermostHashTable();
+        HashTableNode newScope = enterInnermostHashTable(firstChild);
         currentScopeDepth++;
         DEBUG_PRINT(DEBUG_VERBOSE, "Entering new scope (depth: %d)\n", currentScopeDepth);
         
@@ -892,7 +887,7 @@ void ProcessStatement(ASTNode *node, HashTableNode scope, Type returnType)
         DEBUG_PRINT(DEBUG_VERBOSE, "Exiting scope (depth: %d)\n", currentScopeDepth);
         deleteLocalVariable();
     }
-    else if (stringComparison(firstChild->name, "RETURN")) {
+    else if (firstChild->kind == AST_RETURN) {
         DEBUG_PRINT(DEBUG_VERBOSE, "Processing return statement\n");
         // Return statement: RETURN Exp SEMI
         ASTNode *expNode = getChild(node, 1);
@@ -908,7 +903,7 @@ void ProcessStatement(ASTNode *node, HashTableNode scope, Type returnType)
             }
         }
     }
-    else if (stringComparison(firstChild->name, "WHILE")) {
+    else if (firstChild->kind == AST_WHILE) {
         DEBUG_PRINT(DEBUG_VERBOSE, "Processing while statement\n");
         // While statement: WHILE LP Exp RP Stmt
         ASTNode *conditionNode = getChild(node, 2);
@@ -930,13 +925,13 @@ void ProcessStatement(ASTNode *node, HashTableNode scope, Type returnType)
         DEBUG_PRINT(DEBUG_VERBOSE, "Processing while loop body\n");
         ProcessStatement(bodyNode, scope, returnType);
     }
-    else if (stringComparison(firstChild->name, "IF")) {
+    else if (firstChild->kind == AST_IF) {
         DEBUG_PRINT(DEBUG_VERBOSE, "Processing if statement\n");
         // If statement (possibly with else): IF LP Exp RP Stmt [ELSE Stmt]
         ASTNode *conditionNode = getChild(node, 2);
         ASTNode *ifBodyNode = getChild(node, 4);
         ASTNode *elseNode = getChild(node, 5);
-        DEBUG_PRINT(DEBUG_VERBOSE, "Condition node: %s\n", conditionNode->name);
+        DEBUG_PRINT(DEBUG_VERBOSE, "Condition node: %s\n", ast_name(conditionNode));
         // Check condition type
         Type condType = ProcessExpression(conditionNode);
       //  DEBUG_PRINT(DEBUG_VERBOSE, "Condition type: %d\n", condType->kind);
@@ -1123,7 +1118,7 @@ void ProcessDeclaration(ASTNode *node, HashTableNode scope, Type typeInfo)
         }
     }
     // Handle declaration with assignment
-    else if (stringComparison(assignNode->name, "ASSIGNOP")) {
+    else if (assignNode->kind == AST_ASSIGNOP) {
         DEBUG_PRINT(DEBUG_VERBOSE, "Processing declaration with assignment\n");
         printf("DEBUG: 处理带赋值的声明: 变量名='%s'\n", field->name);
         // Check for name conflicts
@@ -1172,9 +1167,9 @@ Type ProcessExpression(ASTNode *node)
     ASTNode *fourthChild = getChild(node, 3);
    
     // Case 1: Expressions involving binary operations
-    if (stringComparison(firstChild->name, "Exp")) {
+    if (firstChild->kind == AST_Exp) {
         // Handle assignment: Exp ASSIGNOP Exp
-        if (stringComparison(secondChild->name, "ASSIGNOP")) {
+        if (secondChild->kind == AST_ASSIGNOP) {
             // Check if left side is an l-value
             ASTNode *leftExp = firstChild;
             ASTNode *leftFirst = getChild(leftExp, 0);
@@ -1183,7 +1178,7 @@ Type ProcessExpression(ASTNode *node)
             ASTNode *leftFourth = getChild(leftExp, 3);
             
             // Simple variable must be an ID
-            if (leftSecond == NULL && !stringComparison(leftFirst->name, "ID")) {
+            if (leftSecond == NULL && leftFirst->kind != AST_ID) {
                 reportSemanticError(Leftside_Rvalue_Error, node->lineno, NULL);
                 return NULL;
             }
@@ -1192,15 +1187,15 @@ Type ProcessExpression(ASTNode *node)
             if (leftSecond != NULL) {
                 // Check if it's a valid l-value (array access or field access)
                 bool isArrayAccess = leftFourth && 
-                                     stringComparison(leftFirst->name, "Exp") && 
-                                     stringComparison(leftSecond->name, "LB") && 
-                                     stringComparison(leftThird->name, "Exp") && 
-                                     stringComparison(leftFourth->name, "RB");
+                                     leftFirst->kind == AST_Exp && 
+                                     leftSecond->kind == AST_LB && 
+                                     leftThird->kind == AST_Exp && 
+                                     leftFourth->kind == AST_RB;
                 
                 bool isFieldAccess = leftThird && !leftFourth && 
-                                     stringComparison(leftFirst->name, "Exp") && 
-                                     stringComparison(leftSecond->name, "DOT") && 
-                                     stringComparison(leftThird->name, "ID");
+                                     leftFirst->kind == AST_Exp && 
+                                     leftSecond->kind == AST_DOT && 
+                                     leftThird->kind == AST_ID;
                 
                 if (!isArrayAccess && !isFieldAccess) {
                     reportSemanticError(Leftside_Rvalue_Error, node->lineno, NULL);
@@ -1222,8 +1217,8 @@ Type ProcessExpression(ASTNode *node)
             return leftType;
         }
         // Handle other binary operations
-        else if (stringComparison(secondChild->name, "AND") || 
-                 stringComparison(secondChild->name, "OR")) {
+        else if (secondChild->kind == AST_AND || 
+                 secondChild->kind == AST_OR) {
             // Get types of operands
             Type leftType = ProcessExpression(firstChild);
             Type rightType = ProcessExpression(thirdChild);
@@ -1238,7 +1233,7 @@ Type ProcessExpression(ASTNode *node)
             }
             return NULL;
         }
-        else if (stringComparison(secondChild->name, "RELOP")) {
+        else if (secondChild->kind == AST_RELOP) {
             // Get types of operands
             Type leftType = ProcessExpression(firstChild);
             Type rightType = ProcessExpression(thirdChild);
@@ -1255,10 +1250,10 @@ Type ProcessExpression(ASTNode *node)
                 return NULL;
             }
         }
-        else if (stringComparison(secondChild->name, "PLUS") || 
-                 stringComparison(secondChild->name, "MINUS") || 
-                 stringComparison(secondChild->name, "STAR") || 
-                 stringComparison(secondChild->name, "DIV")) {
+        else if (secondChild->kind == AST_PLUS || 
+                 secondChild->kind == AST_MINUS || 
+                 secondChild->kind == AST_STAR || 
+                 secondChild->kind == AST_DIV) {
             // Get types of operands
             Type leftType = ProcessExpression(firstChild);
             Type rightType = ProcessExpression(thirdChild);
@@ -1275,7 +1270,7 @@ Type ProcessExpression(ASTNode *node)
             return NULL;
         }
         // Handle array access: Exp LB Exp RB
-        else if (stringComparison(secondChild->name, "LB")) {
+        else if (secondChild->kind == AST_LB) {
             // Process the array expression and index
             Type arrayType = ProcessExpression(firstChild);
             Type indexType = ProcessExpression(thirdChild);
@@ -1300,7 +1295,7 @@ Type ProcessExpression(ASTNode *node)
             return arrayType->u.array.element;
         }
         // Handle structure member access: Exp DOT ID
-        else if (stringComparison(secondChild->name, "DOT")) {
+        else if (secondChild->kind == AST_DOT) {
             // Process the structure expression
             Type structType = ProcessExpression(firstChild);
             
@@ -1314,7 +1309,7 @@ Type ProcessExpression(ASTNode *node)
             
             // Find the field in the structure
             FieldList fieldList = structType->u.structure.structures;
-            char *fieldName = thirdChild->value;
+            char *fieldName = ast_value(thirdChild);
             
             // 遍历结构体的字段列表
             while (fieldList != NULL) {
@@ -1332,16 +1327,16 @@ Type ProcessExpression(ASTNode *node)
     // Case 2: Terminal values (ID, INT, FLOAT)
     else if (secondChild == NULL) {
         // Handle variable references
-        if (stringComparison(firstChild->name, "ID")) {
+        if (firstChild->kind == AST_ID) {
             // Look up variable in both local and global scopes
             Type localType = (Type)malloc(sizeof(struct Type_));
             int localIsDefined = 0;
-            bool localFound = lookupLocalSymbol(&localType, firstChild->value, &localIsDefined, currentScopeDepth, 0);
+            bool localFound = lookupLocalSymbol(&localType, ast_value(firstChild), &localIsDefined, currentScopeDepth, 0);
             
             Type globalType = (Type)malloc(sizeof(struct Type_));
             int globalKind = 0;
             int globalIsDefined = 0;
-            bool globalFound = lookupGlobalSymbol(&globalType, firstChild->value, &globalIsDefined, currentScopeDepth, &globalKind);
+            bool globalFound = lookupGlobalSymbol(&globalType, ast_value(firstChild), &globalIsDefined, currentScopeDepth, &globalKind);
             
             // If found locally, return local type
             if (localFound) {
@@ -1358,14 +1353,14 @@ Type ProcessExpression(ASTNode *node)
             }
         }
         // Handle integer literals
-        else if (stringComparison(firstChild->name, "INT")) {
+        else if (firstChild->kind == AST_INT) {
             Type intType = (Type)malloc(sizeof(struct Type_));
             intType->kind = BASIC;
             intType->u.basic = 0;  // 0 represents int
             return intType;
         }
         // Handle float literals
-        else if (stringComparison(firstChild->name, "FLOAT")) {
+        else if (firstChild->kind == AST_FLOAT) {
             Type floatType = (Type)malloc(sizeof(struct Type_));
             floatType->kind = BASIC;
             floatType->u.basic = 1;  // 1 represents float
@@ -1375,11 +1370,11 @@ Type ProcessExpression(ASTNode *node)
     // Case 3: Various unary and other expressions
     else {
         // Handle parenthesized expressions: LP Exp RP
-        if (stringComparison(firstChild->name, "LP")) {
+        if (firstChild->kind == AST_LP) {
             return ProcessExpression(secondChild);
         }
         // Handle unary minus: MINUS Exp
-        else if (stringComparison(firstChild->name, "MINUS")) {
+        else if (firstChild->kind == AST_MINUS) {
             Type expType = ProcessExpression(secondChild);
             
             if (expType == NULL) return NULL;
@@ -1393,7 +1388,7 @@ Type ProcessExpression(ASTNode *node)
             return expType;
         }
         // Handle logical not: NOT Exp
-        else if (stringComparison(firstChild->name, "NOT")) {
+        else if (firstChild->kind == AST_NOT) {
             Type expType = ProcessExpression(secondChild);
             
             if (expType == NULL) return NULL;
@@ -1407,9 +1402,9 @@ Type ProcessExpression(ASTNode *node)
             return expType;
         }
         // Handle function calls: ID LP [Args] RP
-        else if (stringComparison(firstChild->name, "ID")) {
+        else if (firstChild->kind == AST_ID) {
             // Look up function in symbol table
-            char *funcName = firstChild->value;
+            char *funcName = ast_value(firstChild);
             Type funcType = (Type)malloc(sizeof(struct Type_));
             int isDefined = -1;
             bool found = lookupLocalSymbol(&funcType, funcName, &isDefined, currentScopeDepth, 1);
@@ -1428,7 +1423,7 @@ Type ProcessExpression(ASTNode *node)
             }
             
             // Case 3: Function call with arguments
-            if (stringComparison(thirdChild->name, "Args")) {
+            if (thirdChild->kind == AST_Args) {
                 // If function has no parameters but arguments are provided
                 if (funcType->u.function.parameters == NULL) {
                     reportSemanticError(Func_Call_Parameter_Dismatch, node->lineno, NULL);
@@ -1459,7 +1454,7 @@ Type ProcessExpression(ASTNode *node)
                 return funcType->u.function.returnType;
             }
             // Case 4: Function call without arguments
-            else if (stringComparison(thirdChild->name, "RP")) {
+            else if (thirdChild->kind == AST_RP) {
                 // If function has parameters but no arguments are provided
                 if (funcType->u.function.parameters != NULL) {
                     reportSemanticError(Func_Call_Parameter_Dismatch, node->lineno, NULL);
@@ -1551,12 +1546,10 @@ FieldList ProcessStructureDeclaration(ASTNode *node, Type typeInfo, char *struct
 }
 
 // 函数实现
-HashTableNode enterInnermostHashTable()
+HashTableNode enterInnermostHashTable(ASTNode *ownerNode)
 {
     // Create a new scope for function body
-    HashTableNode newScope = pushNewScope();
-    currentScopeNode = newScope;
-    return newScope;
+    return pushNewScope(ownerNode);
 }
 
 void deleteLocalVariable()
@@ -1580,6 +1573,7 @@ void validateFunctionDefinitions() {
         if (lookupGlobalSymbol(&funcType, current->name, &isDefined, 0, &category)) {
             if (isDefined == 0) {
                 DEBUG_PRINT(DEBUG_BASIC, "Error: Function %s declared but not defined\n", current->name);
+                errorSemanticFlag++;
                 printf("Error type 18 at Line %d: Function \"%s\" declared but not defined.\n", 
                        current->functionLineNumber, current->name);
             } else {
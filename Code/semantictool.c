@@ -7,6 +7,8 @@
 FunctionTable funcRegister = NULL;
 HashTableNode currentScopeNode = NULL;
 HashTableNode rootScopeNode = NULL;
+static HashTableNode lastScopeNode = NULL;   /* last scope in creation order */
+static HashTableNode replayScopeNode = NULL; /* next scope to reenter during IR translation */
 HashTableNode_ symbolRegistry[TABLESIZE] = {NULL};
 HashTableNode_ structRegistry[TABLESIZE] = {NULL};
 
@@ -17,8 +19,12 @@ HashTableNode createSymbolScopeTable() {
     
     newScope->symbolTableNode = NULL;
     newScope->nextHashTableNode = NULL;
+    newScope->enclosingScope = NULL;
+    newScope->ownerNode = NULL;
     
     rootScopeNode = newScope;
+    lastScopeNode = newScope;
+    currentScopeNode = newScope;
     
     return newScope;
 }
@@ -28,17 +34,7 @@ SymbolTableNode buildSymbolEntry(Type typeInfo, char* symbolIdentifier, int defi
     SymbolTableNode entry = (SymbolTableNode)malloc(sizeof(SymbolTableNode_));
     if (!entry) return NULL;
     
-    if (symbolIdentifier != NULL) {
-        char* nameCopy = malloc((strlen(symbolIdentifier) + 1) * sizeof(char));
-        if (nameCopy != NULL) {
-            strcpy(nameCopy, symbolIdentifier);
-            entry->name = nameCopy;
-        } else {
-            entry->name = NULL;
-        }
-    } else {
-        entry->name = NULL;
-    }
+    entry->name = symbolIdentifier != NULL ? intern_name(symbolIdentifier) : NULL;
     
     entry->type = typeInfo;
     entry->depth = scopeLevel;
@@ -56,46 +52,20 @@ SymbolTableNode findSymbolInScope(char* symbolIdentifier, int scopeLevel) {
         return NULL;
     }
 
-    unsigned int hashIndex = hash_pjw(symbolIdentifier);
+    unsigned int hashIndex = intern_hash(symbolIdentifier);
     printf("DEBUG: 查找符号: '%s', 作用域级别: %d, 哈希索引: %u\n", 
            symbolIdentifier, scopeLevel, hashIndex);
     
-    SymbolTableNode current = symbolRegistry[hashIndex].symbolTableNode;
-    SymbolTableNode bestMatch = NULL;
-    
-    int checkCount = 0;
-    printf("DEBUG: 哈希索引 %u 中的所有符号:\n", hashIndex);
-    SymbolTableNode debugCurrent = current;
-    while (debugCurrent) {
-        printf("  符号: '%s', 深度: %d, 种类: %d, 已定义: %d\n", 
-               debugCurrent->name ? debugCurrent->name : "NULL", 
-               debugCurrent->depth, 
-               debugCurrent->kind, 
-               debugCurrent->isDefined);
-        debugCurrent = debugCurrent->sameHashSymbolTableNode;
-    }
-    
-    while (current) {
-        checkCount++;
-        printf("DEBUG: [%d] 比较符号: '%s' 与 '%s', 深度: %d, 地址: %p\n", 
-               checkCount, current->name ? current->name : "NULL", 
-               symbolIdentifier, current->depth, (void*)current);
-               
-        if (current->name != NULL && stringComparison(current->name, symbolIdentifier) && scopeLevel >= current->depth) {
-            bestMatch = current;
-            printf("DEBUG: 找到匹配符号: '%s', 深度: %d\n", bestMatch->name, bestMatch->depth);
+    // 哈希链中内层作用域的符号在前，第一个匹配的就是可见的那个
+    for (SymbolTableNode current = symbolRegistry[hashIndex].symbolTableNode; current; current = current->sameHashSymbolTableNode) {
+        if (current->name == symbolIdentifier && scopeLevel >= current->depth) {
+            printf("DEBUG: 找到匹配符号: '%s', 深度: %d\n", current->name, current->depth);
+            return current;
         }
-        
-        current = current->sameHashSymbolTableNode;
     }
     
-    if (bestMatch) {
-        printf("DEBUG: 返回最佳匹配符号: '%s', 深度: %d\n", bestMatch->name, bestMatch->depth);
-    } else {
-        printf("DEBUG: 未找到符号: '%s'\n", symbolIdentifier);
-    }
-    
-    return bestMatch;
+    printf("DEBUG: 未找到符号: '%s'\n", symbolIdentifier);
+    return NULL;
 }
 
 /* Register a symbol in the symbol table */
@@ -118,21 +88,11 @@ void registerSymbol(SymbolTableNode entry, HashTableNode scopeTable) {
     printf("DEBUG: 注册符号: '%s', 种类: %d, 深度: %d\n", 
            entry->name, entry->kind, entry->depth);
     
-    unsigned int hashIndex = hash_pjw(entry->name);
+    unsigned int hashIndex = intern_hash(entry->name);
     printf("DEBUG: 符号哈希索引: %u\n", hashIndex);
     
-    if (!scopeTable->symbolTableNode) {
-        printf("DEBUG: 作用域表为空，添加为第一个符号\n");
-        scopeTable->symbolTableNode = entry;
-    } else {
-        SymbolTableNode last = scopeTable->symbolTableNode;
-        while (last->controlScopeSymbolTableNode) {
-            last = last->controlScopeSymbolTableNode;
-        }
-        
-        printf("DEBUG: 将符号添加到作用域链末尾\n");
-        last->controlScopeSymbolTableNode = entry;
-    }
+    entry->controlScopeSymbolTableNode = scopeTable->symbolTableNode;
+    scopeTable->symbolTableNode = entry;
     
     printf("DEBUG: 将符号添加到哈希表: 索引=%u\n", hashIndex);
     entry->sameHashSymbolTableNode = symbolRegistry[hashIndex].symbolTableNode;
@@ -142,43 +102,72 @@ void registerSymbol(SymbolTableNode entry, HashTableNode scopeTable) {
 }
 
 /* Create a new nested scope */
-HashTableNode pushNewScope() {
+HashTableNode pushNewScope(ASTNode *ownerNode) {
     HashTableNode newScope = malloc(sizeof(HashTableNode_));
     if (!newScope) return NULL;
     
     newScope->nextHashTableNode = NULL;
     newScope->symbolTableNode = NULL;
+    newScope->enclosingScope = currentScopeNode;
+    newScope->ownerNode = ownerNode;
     
-    HashTableNode current = rootScopeNode;
-    while (current && current->nextHashTableNode) {
-        current = current->nextHashTableNode;
-    }
-    
-    if (current) {
-        current->nextHashTableNode = newScope;
+    // Scopes stay listed in creation order for the replay during IR translation
+    if (lastScopeNode) {
+        lastScopeNode->nextHashTableNode = newScope;
     }
+    lastScopeNode = newScope;
+    currentScopeNode = newScope;
     
     return newScope;
 }
 
+/* Unlink a symbol from its hash chain, it is normally the head */
+static void unlinkSymbol(SymbolTableNode entry) {
+    SymbolTableNode *link = &symbolRegistry[intern_hash(entry->name)].symbolTableNode;
+    while (*link && *link != entry) {
+        link = &(*link)->sameHashSymbolTableNode;
+    }
+    if (*link) {
+        *link = entry->sameHashSymbolTableNode;
+    }
+    entry->sameHashSymbolTableNode = NULL;
+}
+
 /* Remove variables from innermost scope */
 void popCurrentScope() {
-    // HashTableNode parent = rootScopeNode;
-    // HashTableNode target = parent;
-    
-    // while (target->nextHashTableNode) {
-    //     parent = target;
-    //     target = target->nextHashTableNode;
-    // }
+    HashTableNode target = currentScopeNode;
+    if (!target || target == rootScopeNode) return;
     
-    // if (!parent) return;
+    for (SymbolTableNode entry = target->symbolTableNode; entry; entry = entry->controlScopeSymbolTableNode) {
+        unlinkSymbol(entry);
+    }
     
-    // while (target->symbolTableNode) {
-    //     SymbolTableNode nodeToRemove = target->symbolTableNode;
-    //     removeSymbolFromTable(nodeToRemove->name, nodeToRemove->depth, target);
-    // }
+    currentScopeNode = target->enclosingScope;
+}
+
+/* Start reentering scopes from the first one created by semantic analysis */
+void restartScopeReplay() {
+    replayScopeNode = rootScopeNode ? rootScopeNode->nextHashTableNode : NULL;
+    currentScopeNode = rootScopeNode;
+}
+
+/* Reenter the scope owned by ownerNode, relinking its symbols in front of their hash chains */
+HashTableNode reenterScope(ASTNode *ownerNode) {
+    HashTableNode scope = replayScopeNode;
+    while (scope && scope->ownerNode != ownerNode) {
+        scope = scope->nextHashTableNode;
+    }
+    if (!scope) return NULL;
+    replayScopeNode = scope->nextHashTableNode;
     
-    // parent->nextHashTableNode = NULL;
+    for (SymbolTableNode entry = scope->symbolTableNode; entry; entry = entry->controlScopeSymbolTableNode) {
+        unsigned int hashIndex = intern_hash(entry->name);
+        entry->sameHashSymbolTableNode = symbolRegistry[hashIndex].symbolTableNode;
+        symbolRegistry[hashIndex].symbolTableNode = entry;
+    }
+    scope->enclosingScope = currentScopeNode;
+    currentScopeNode = scope;
+    return scope;
 }
 
 /* Remove a symbol from the table */
@@ -187,7 +176,7 @@ void removeSymbolFromTable(char* symbolIdentifier, int scopeLevel, HashTableNode
         return;
     }
 
-    unsigned int hashIndex = hash_pjw(symbolIdentifier);
+    unsigned int hashIndex = intern_hash(symbolIdentifier);
     
     // Check if there are any symbols in this hash bucket
     if (!symbolRegistry[hashIndex].symbolTableNode) {
@@ -196,7 +185,7 @@ void removeSymbolFromTable(char* symbolIdentifier, int scopeLevel, HashTableNode
 
     // Special handling for the first node in the hash chain
     SymbolTableNode firstNode = symbolRegistry[hashIndex].symbolTableNode;
-    if (stringComparison(firstNode->name, symbolIdentifier) && firstNode->depth == scopeLevel) {
+    if (firstNode->name == symbolIdentifier && firstNode->depth == scopeLevel) {
         symbolRegistry[hashIndex].symbolTableNode = firstNode->sameHashSymbolTableNode;
         
         // Also remove from scope chain if it's the first node
@@ -213,10 +202,7 @@ void removeSymbolFromTable(char* symbolIdentifier, int scopeLevel, HashTableNode
             }
         }
         
-        // Free the removed node
-        if (firstNode->name) {
-            free(firstNode->name);
-        }
+        // Free the removed node, the interned name stays
         free(firstNode);
         return;
     }
@@ -226,7 +212,7 @@ void removeSymbolFromTable(char* symbolIdentifier, int scopeLevel, HashTableNode
     SymbolTableNode hashCurrent = firstNode->sameHashSymbolTableNode;
     
     while (hashCurrent) {
-        if (stringComparison(hashCurrent->name, symbolIdentifier) && hashCurrent->depth == scopeLevel) {
+        if (hashCurrent->name == symbolIdentifier && hashCurrent->depth == scopeLevel) {
             // Remove from hash chain
             hashPrev->sameHashSymbolTableNode = hashCurrent->sameHashSymbolTableNode;
             
@@ -243,10 +229,7 @@ void removeSymbolFromTable(char* symbolIdentifier, int scopeLevel, HashTableNode
                 }
             }
             
-            // Free the removed node
-            if (hashCurrent->name) {
-                free(hashCurrent->name);
-            }
+            // Free the removed node, the interned name stays
             free(hashCurrent);
             return;
         }
@@ -264,15 +247,8 @@ SymbolTableNode constructSymbolEntry(Type typeInfo, char* symbolIdentifier, int
            symbolIdentifier ? symbolIdentifier : "NULL", category, scopeLevel);
     
     if (symbolIdentifier != NULL) {
-        char* nameCopy = (char*)malloc((strlen(symbolIdentifier) + 1) * sizeof(char));
-        if (nameCopy != NULL) {
-            strcpy(nameCopy, symbolIdentifier);
-            entry->name = nameCopy;
-            printf("DEBUG: 成功复制符号名称: '%s'\n", entry->name);
-        } else {
-            entry->name = NULL;
-            printf("ERROR: 无法为符号名称分配内存\n");
-        }
+        // 符号名使用驻留的名字，不再单独复制
+        entry->name = intern_name(symbolIdentifier);
     } else {
         entry->name = NULL;
         printf("WARNING: 符号标识符为NULL\n");
@@ -295,41 +271,39 @@ int insertStruct(Type type, char *name, int offset, char *structName)
     printf("DEBUG: 插入结构体节点: '%s', 偏移量=%d, 结构体名称=%s\n", 
            name,  offset, structName);
     
+    name = intern_name(name);
+    unsigned int hashIndex = intern_hash(name);
     SymbolTableNode insertSymbolTableNode = buildSymbolEntry(type, name, 1, 0);
     insertSymbolTableNode->kind = 0;
     insertSymbolTableNode->offset = offset;
     insertSymbolTableNode->structName = structName;
-    registerSymbol(insertSymbolTableNode, symbolRegistry);
-    if (structRegistry[hash_pjw(name)].symbolTableNode == NULL)
+    registerSymbol(insertSymbolTableNode, rootScopeNode);
+    if (structRegistry[hashIndex].symbolTableNode == NULL)
     {
         SymbolTableNode currentSymbolTableNode = (SymbolTableNode)malloc(sizeof(struct SymbolTableNode_));
         currentSymbolTableNode->type = type;
         currentSymbolTableNode->offset = offset;
         currentSymbolTableNode->structName = structName;
         
-        // 为name分配内存
-        currentSymbolTableNode->name = (char *)malloc(strlen(name) + 1);
-        if (currentSymbolTableNode->name != NULL) {
-            strcpy(currentSymbolTableNode->name, name);
-        }
+        currentSymbolTableNode->name = name;
         
         currentSymbolTableNode->sameHashSymbolTableNode = NULL;
-        structRegistry[hash_pjw(name)].symbolTableNode = currentSymbolTableNode;
+        structRegistry[hashIndex].symbolTableNode = currentSymbolTableNode;
     }
     else
     {
-        SymbolTableNode head = structRegistry[hash_pjw(name)].symbolTableNode;
+        SymbolTableNode head = structRegistry[hashIndex].symbolTableNode;
         SymbolTableNode iterator = head;
         while (iterator->sameHashSymbolTableNode != NULL)
         {
-            if (strcmp(head->name, name) == 0)
+            if (head->name == name)
             {
                 return 1;
             }
             iterator = iterator->sameHashSymbolTableNode;  // 修复循环逻辑错误
         }
         // 再检查最后一个节点
-        if (strcmp(iterator->name, name) == 0) {
+        if (iterator->name == name) {
             return 1;
         }
         
@@ -338,13 +312,7 @@ int insertStruct(Type type, char *name, int offset, char *structName)
         currentSymbolTableNode->type = type;
         currentSymbolTableNode->sameHashSymbolTableNode = head;
         
-        // 为name分配内存
-        currentSymbolTableNode->name = (char *)malloc(strlen(name) + 1);
-        if (currentSymbolTableNode->name == NULL) {
-            free(currentSymbolTableNode);
-            return -1;
-        }
-        strcpy(currentSymbolTableNode->name, name);
+        currentSymbolTableNode->name = name;
         
         // 为structName分配内存，确保它不是空指针
         if (structName != NULL) {
@@ -356,7 +324,7 @@ int insertStruct(Type type, char *name, int offset, char *structName)
             currentSymbolTableNode->structName = NULL;
         }
         
-        structRegistry[hash_pjw(name)].symbolTableNode = currentSymbolTableNode;
+        structRegistry[hashIndex].symbolTableNode = currentSymbolTableNode;
     }
     return 0;
 }
@@ -390,7 +358,8 @@ void trackFunctionDeclaration(char* funcName, int linePosition) {
 /* Add a structure type to registry */
 int addStructType(Type structTypeInfo, char* structIdentifier) {
     printf("DEBUG: 添加结构体类型: '%s'\n", structIdentifier);
-    unsigned int hashIndex = hash_pjw(structIdentifier);
+    structIdentifier = intern_name(structIdentifier);
+    unsigned int hashIndex = intern_hash(structIdentifier);
     
     if (!structRegistry[hashIndex].symbolTableNode) {
         SymbolTableNode entry = (SymbolTableNode)malloc(sizeof(SymbolTableNode_));
@@ -398,13 +367,7 @@ int addStructType(Type structTypeInfo, char* structIdentifier) {
         
         entry->type = structTypeInfo;
         
-        // 分配内存来存储名称
-        entry->name = (char *)malloc(strlen(structIdentifier) + 1);
-        if (!entry->name) {
-            free(entry);
-            return -1;
-        }
-        strcpy(entry->name, structIdentifier);
+        entry->name = structIdentifier;
         
         entry->sameHashSymbolTableNode = NULL;
         
@@ -417,13 +380,7 @@ int addStructType(Type structTypeInfo, char* structIdentifier) {
         
         entry->type = structTypeInfo;
         
-        // 分配内存来存储名称
-        entry->name = (char *)malloc(strlen(structIdentifier) + 1);
-        if (!entry->name) {
-            free(entry);
-            return -1;
-        }
-        strcpy(entry->name, structIdentifier);
+        entry->name = structIdentifier;
         
         entry->sameHashSymbolTableNode = firstNode;
         
@@ -435,7 +392,7 @@ int addStructType(Type structTypeInfo, char* structIdentifier) {
 
 /* Find structure by name */
 SymbolTableNode findStructByName(char* structIdentifier) {
-    unsigned int hashIndex = hash_pjw(structIdentifier);
+    unsigned int hashIndex = intern_hash(structIdentifier);
     
     if (!structRegistry[hashIndex].symbolTableNode) {
         return NULL;
@@ -445,7 +402,7 @@ SymbolTableNode findStructByName(char* structIdentifier) {
     SymbolTableNode result = NULL;
     
     while (current) {
-        if (strcmp(current->name, structIdentifier) == 0) {
+        if (current->name == structIdentifier) {
             result = current;
             break;
         }
@@ -458,23 +415,18 @@ SymbolTableNode findStructByName(char* structIdentifier) {
 
 /* Look up a local symbol */
 bool lookupLocalSymbol(Type* typeResult, char* symbolIdentifier, int* defineStatus, int scopeLevel, int visibilityMode) {
-    unsigned int hashIndex = hash_pjw(symbolIdentifier);
+    unsigned int hashIndex = intern_hash(symbolIdentifier);
     
     SymbolTableNode current = symbolRegistry[hashIndex].symbolTableNode;
     
     if (!current) return false;
     
     while (current) {
-        bool nameMatch = stringComparison(current->name, symbolIdentifier);
-        bool depthMatch = false;
-        
-        if (visibilityMode == 0) {
-            depthMatch = (scopeLevel == current->depth);
-        } else if (visibilityMode == 1) {
-            depthMatch = (scopeLevel >= current->depth);
-        }
-        
-        if (nameMatch && depthMatch) {
+        if (current->name == symbolIdentifier && scopeLevel >= current->depth) {
+            // 第一个可见的同名符号就是最内层的那个，模式0还要求它就在当前深度
+            if (visibilityMode == 0 && scopeLevel != current->depth) {
+                return false;
+            }
             *typeResult = current->type;
             *defineStatus = current->isDefined;
             return true;
@@ -488,14 +440,14 @@ bool lookupLocalSymbol(Type* typeResult, char* symbolIdentifier, int* defineStat
 
 /* Look up symbol in global scope */
 bool lookupGlobalSymbol(Type* typeResult, char* symbolIdentifier, int* defineStatus, int scopeLevel, int* category) {
-    unsigned int hashIndex = hash_pjw(symbolIdentifier);
+    unsigned int hashIndex = intern_hash(symbolIdentifier);
     
     SymbolTableNode current = symbolRegistry[hashIndex].symbolTableNode;
     
     if (!current) return false;
     
     while (current) {
-        if (stringComparison(current->name, symbolIdentifier) && scopeLevel >= current->depth) {
+        if (current->name == symbolIdentifier && scopeLevel >= current->depth) {
             *typeResult = current->type;
             *defineStatus = current->isDefined;
             *category = current->kind;
@@ -510,7 +462,7 @@ bool lookupGlobalSymbol(Type* typeResult, char* symbolIdentifier, int* defineSta
 
 /* Check if structure exists */
 bool checkStructExists(Type* typeResult, char* structIdentifier) {
-    unsigned int hashIndex = hash_pjw(structIdentifier);
+    unsigned int hashIndex = intern_hash(structIdentifier);
     
     if (!structRegistry[hashIndex].symbolTableNode) {
         return false;
@@ -519,7 +471,7 @@ bool checkStructExists(Type* typeResult, char* structIdentifier) {
     SymbolTableNode current = structRegistry[hashIndex].symbolTableNode;
     
     while (current) {
-        if (stringComparison(current->name, structIdentifier)) {
+        if (current->name == structIdentifier) {
             *typeResult = current->type;
             return true;
         }
@@ -533,6 +485,7 @@ bool checkStructExists(Type* typeResult, char* structIdentifier) {
 
 /* Report semantic errors with appropriate messages */
 void reportSemanticError(enum SemanticError errorCode, int linePosition, char* msgDetails) {
+    errorSemanticFlag++;
     printf("Error type %d at Line %d: ", errorCode + 1, linePosition);
     
     switch (errorCode) {
@@ -12,14 +12,21 @@ extern HashTableNode_ structRegistry[TABLESIZE];
 
 extern SymbolTableNode* symbolTable;
 extern unsigned tableSize;
+extern int errorSemanticFlag;  // 语义错误个数，在 main.c 中定义
 
 /* Symbol table management functions */
+/* 符号表和结构体表中的名字都是驻留后的名字：建立表项时驻留，查找时传入的名字必须已经驻留（语法树中的标识符都是），只比较指针 */
 HashTableNode createSymbolScopeTable();
 SymbolTableNode buildSymbolEntry(Type typeInfo, char *symbolIdentifier, int defineStatus, int scopeLevel);
 SymbolTableNode findSymbolInScope(char *name, int scope);
 void registerSymbol(SymbolTableNode entry, HashTableNode scopeTable);
-HashTableNode pushNewScope();
+/* 建立 ownerNode 的作用域作为当前最内层作用域 */
+HashTableNode pushNewScope(ASTNode *ownerNode);
+/* 退出当前最内层作用域，它的符号从哈希桶中摘下，代价与符号个数成正比 */
 void popCurrentScope();
+/* 中间代码生成时按语义分析的顺序重新进入 ownerNode 的作用域，找不到时返回 NULL */
+void restartScopeReplay();
+HashTableNode reenterScope(ASTNode *ownerNode);
 void removeSymbolFromTable(char *symbolIdentifier, int scopeLevel, HashTableNode targetScope);
 SymbolTableNode constructSymbolEntry(Type typeInfo, char *symbolIdentifier, int category, bool defineStatus, int scopeLevel);
 void trackFunctionDeclaration(char *funcName, int linePosition);
@@ -0,0 +1,1366 @@
+#include "ssa.h"
+
+#define IR_BIT_TEST(set, i) (((set)[(i) >> 5] >> ((i) & 31)) & 1u)
+#define IR_BIT_SET(set, i) ((set)[(i) >> 5] |= 1u << ((i) & 31))
+#define IR_BIT_CLEAR(set, i) ((set)[(i) >> 5] &= ~(1u << ((i) & 31)))
+
+/* 构造SSA时的变量或临时变量 */
+typedef struct IRSsaVar {
+    Operand orig;            // 原操作数，同时代表函数入口处的版本
+    int defCount;            // 定值次数，PARAM 也算一次
+    bool inMemory;           // 数组、结构体或被取地址，不参与重命名
+    bool global;             // 在某个基本块中先使用后定值，需要φ函数
+    bool param;              // 由 PARAM 定值
+    int *defBlocks;          // 有定值的基本块，按块号递增
+    int defBlockCount;
+    int defBlockCapacity;
+    Operand current;         // 重命名时的当前版本，NULL表示入口版本
+} IRSsaVar;
+
+/* 构造时放置的φ函数，按基本块串成链表 */
+typedef struct IRSsaPhi {
+    InterCodes code;
+    int var;
+    int next;
+    bool live;
+} IRSsaPhi;
+
+/* 消去SSA时通过φ函数相关联的值 */
+typedef struct IRSsaValue {
+    Operand op;
+    int web;                 // 通过φ函数连在一起的值
+    int cls;                 // 合并后的名字（并查集）
+} IRSsaValue;
+
+/* 一条可能被消去的复制：φ函数的目标和来自某个前驱的参数 */
+typedef struct IRSsaCopy {
+    int dest, src;
+    int depth;               // 前驱块的循环深度
+    int order;
+} IRSsaCopy;
+
+/* 并行复制中的一项 */
+typedef struct IRSsaMove {
+    Operand dest, src;
+} IRSsaMove;
+
+/* (kind, var_no) 到 vars 或 values 下标的映射，两个阶段不会同时使用 */
+static int *indexTable[2] = {NULL, NULL};
+static int indexTableSize[2] = {0, 0};
+
+static IRSsaVar *vars = NULL;
+static int varCount = 0;
+static int varCapacity = 0;
+
+static IRSsaPhi *phis = NULL;
+static int phiCount = 0;
+static int phiCapacity = 0;
+static int *blockPhis = NULL;
+
+static IRSsaValue *values = NULL;
+static int valueCount = 0;
+static int valueCapacity = 0;
+
+/* ir_ssa_is_value 变量或临时变量 */
+static bool ir_ssa_is_value(Operand op)
+{
+    return op && (op->kind == VARIABLE_OP || op->kind == TEMP_OP);
+}
+
+/* ir_ssa_index_slot 操作数在映射表中的位置，必要时扩充表 */
+static int *ir_ssa_index_slot(Operand op)
+{
+    int table = op->kind == TEMP_OP ? 1 : 0;
+    if (op->var_no >= indexTableSize[table]) {
+        int newSize = indexTableSize[table] ? indexTableSize[table] : 64;
+        while (newSize <= op->var_no) {
+            newSize *= 2;
+        }
+        indexTable[table] = (int *)realloc(indexTable[table], newSize * sizeof(int));
+        for (int i = indexTableSize[table]; i < newSize; i++) {
+            indexTable[table][i] = -1;
+        }
+        indexTableSize[table] = newSize;
+    }
+    return &indexTable[table][op->var_no];
+}
+
+/* ir_ssa_lookup 查找操作数的下标，不存在时返回-1 */
+static int ir_ssa_lookup(Operand op)
+{
+    if (!ir_ssa_is_value(op)) {
+        return -1;
+    }
+    return *ir_ssa_index_slot(op);
+}
+
+/* ir_ssa_def_slot 中间代码中被定值的操作数位置 */
+static Operand *ir_ssa_def_slot(InterCodes code)
+{
+    if (!ir_get_def_operand(code)) {
+        return NULL;
+    }
+    switch (code->code.kind) {
+        case ADD_InterCode:
+        case SUB_InterCode:
+        case MUL_InterCode:
+        case DIV_InterCode:
+            return &code->code.u.tripleOP.result;
+        case READ_InterCode:
+        case PARAM_InterCode:
+            return &code->code.u.singleOP.op;
+        case PHI_InterCode:
+            return &code->code.u.phiOP.result;
+        default:
+            return &code->code.u.doubleOP.left;
+    }
+}
+
+/* ir_ssa_replace_use 把读取的操作数换成另一个值，保留 *t 形式 */
+static void ir_ssa_replace_use(Operand *slot, Operand value)
+{
+    if ((*slot)->type == VAL) {
+        *slot = value;
+    } else {
+        Operand copy = ir_duplicate_operand(value);
+        copy->type = (*slot)->type;
+        *slot = copy;
+    }
+}
+
+/* ir_ssa_first_phi 基本块中的第一条φ函数，没有则返回NULL */
+static InterCodes ir_ssa_first_phi(IRBlock *block)
+{
+    InterCodes code = block->first;
+    if (code->code.kind == LABEL_InterCode) {
+        if (code == block->last) {
+            return NULL;
+        }
+        code = code->next;
+    }
+    return code->code.kind == PHI_InterCode ? code : NULL;
+}
+
+/* ir_ssa_next_phi 同一基本块中的下一条φ函数 */
+static InterCodes ir_ssa_next_phi(IRBlock *block, InterCodes phi)
+{
+    return phi == block->last || phi->next->code.kind != PHI_InterCode ? NULL : phi->next;
+}
+
+/* φ函数总是位于基本块开头（标号之后） */
+#define IR_SSA_FOR_EACH_PHI(block, code) \
+    for (InterCodes code = ir_ssa_first_phi(block); code; code = ir_ssa_next_phi(block, code))
+
+/* ir_ssa_pred_index 前驱在基本块 preds 中的下标 */
+static int ir_ssa_pred_index(IRBlock *block, int pred)
+{
+    for (int p = 0; p < block->predCount; p++) {
+        if (block->preds[p] == pred) {
+            return p;
+        }
+    }
+    return -1;
+}
+
+/* ir_ssa_reset_index 清除本函数使用过的映射表项 */
+static void ir_ssa_reset_index(void)
+{
+    for (int v = 0; v < varCount; v++) {
+        *ir_ssa_index_slot(vars[v].orig) = -1;
+        free(vars[v].defBlocks);
+    }
+    varCount = 0;
+    for (int v = 0; v < valueCount; v++) {
+        *ir_ssa_index_slot(values[v].op) = -1;
+    }
+    valueCount = 0;
+}
+
+/* ------------------------------------------------------------------ */
+/* 构造SSA                                                             */
+/* ------------------------------------------------------------------ */
+
+/* ir_ssa_get_var 查找或登记变量 */
+static IRSsaVar *ir_ssa_get_var(Operand op)
+{
+    int *slot = ir_ssa_index_slot(op);
+    if (*slot < 0) {
+        if (varCount == varCapacity) {
+            varCapacity = varCapacity ? varCapacity * 2 : 64;
+            vars = (IRSsaVar *)realloc(vars, varCapacity * sizeof(IRSsaVar));
+        }
+        IRSsaVar *var = &vars[varCount];
+        memset(var, 0, sizeof(IRSsaVar));
+        var->orig = op;
+        *slot = varCount++;
+    }
+    return &vars[*slot];
+}
+
+/* ir_ssa_is_renamed 变量是否参与重命名：不在内存中且定值不止一次 */
+static bool ir_ssa_is_renamed(IRSsaVar *var)
+{
+    return !var->inMemory && var->defCount >= 2;
+}
+
+/* ir_ssa_is_stable 不参与重命名的值在读取之后是否不会再改变 */
+static bool ir_ssa_is_stable(IRSsaVar *var)
+{
+    return !var->inMemory && (var->defCount == 0 || (var->defCount == 1 && (var->param || !var->global)));
+}
+
+/* ir_ssa_is_foldable_copy 复制 x := y 能否在重命名时折叠掉：
+ * x 的每次读取都能在重命名时换成 y 此刻的版本，且这个版本以后不会被改写 */
+static bool ir_ssa_is_foldable_copy(InterCodes code)
+{
+    if (code->code.kind != ASSIGN_InterCode) {
+        return false;
+    }
+    Operand left = code->code.u.doubleOP.left;
+    Operand right = code->code.u.doubleOP.right;
+    if (left->type != VAL || right->type != VAL) {
+        return false;
+    }
+    int x = ir_ssa_lookup(left);
+    int y = ir_ssa_lookup(right);
+    if (x < 0 || y < 0 || vars[x].inMemory) {
+        return false;
+    }
+    // 只定值一次的 x 若跨块使用，读取处不一定被复制支配，不能折叠
+    if (!ir_ssa_is_renamed(&vars[x]) && vars[x].global) {
+        return false;
+    }
+    return ir_ssa_is_renamed(&vars[y]) || ir_ssa_is_stable(&vars[y]);
+}
+
+/* ir_ssa_label_blocks 每个基本块都以标号开始，块内代码被优化删光后块仍然存在，
+ * φ函数的参数和前驱一一对应不会错位；入口块另加一个没有跳转指向的标号，保证它没有前驱 */
+static void ir_ssa_label_blocks(IRCfg cfg)
+{
+    if (cfg->blockCount == 0) {
+        return;
+    }
+    for (int b = 0; b < cfg->blockCount; b++) {
+        if (cfg->blocks[b].first->code.kind != LABEL_InterCode) {
+            InterCodes label = ir_insert_code_before(cfg->blocks[b].first, LABEL_InterCode);
+            label->code.u.singleOP.op = ir_new_label();
+        }
+    }
+    if (cfg->blocks[0].predCount > 0) {
+        InterCodes label = ir_insert_code_before(cfg->blocks[0].first, LABEL_InterCode);
+        label->code.u.singleOP.op = ir_new_label();
+    }
+    ir_rebuild_cfg(cfg);
+}
+
+/* ir_ssa_collect_vars 统计每个值的定值块，找出在内存中的变量和跨基本块使用的值 */
+static void ir_ssa_collect_vars(IRCfg cfg)
+{
+    for (int b = 0; b < cfg->blockCount; b++) {
+        IR_FOR_EACH_BLOCK_CODE(&cfg->blocks[b], code) {
+            if (code->code.kind == DEC_InterCode) {
+                ir_ssa_get_var(code->code.u.doubleOP.left)->inMemory = true;
+                continue;
+            }
+
+            Operand *uses[3];
+            int useCount = ir_get_use_operands(code, uses);
+            for (int i = 0; i < useCount; i++) {
+                Operand op = *uses[i];
+                IRSsaVar *var = ir_ssa_get_var(op);
+                if ((op->kind == VARIABLE_OP && op->type == ADDRESS) || code->code.kind == GET_ADDR_InterCode) {
+                    var->inMemory = true;
+                }
+                if (var->defBlockCount == 0 || var->defBlocks[var->defBlockCount - 1] != b) {
+                    var->global = true;
+                }
+            }
+
+            Operand def = ir_get_def_operand(code);
+            if (!def) {
+                continue;
+            }
+            IRSsaVar *var = ir_ssa_get_var(def);
+            if (def->type == ADDRESS) {
+                var->inMemory = true;
+            }
+            var->defCount++;
+            if (code->code.kind == PARAM_InterCode) {
+                var->param = true;
+            }
+            if (var->defBlockCount == 0 || var->defBlocks[var->defBlockCount - 1] != b) {
+                if (var->defBlockCount == var->defBlockCapacity) {
+                    var->defBlockCapacity = var->defBlockCapacity ? var->defBlockCapacity * 2 : 4;
+                    var->defBlocks = (int *)realloc(var->defBlocks, var->defBlockCapacity * sizeof(int));
+                }
+                var->defBlocks[var->defBlockCount++] = b;
+            }
+        }
+    }
+}
+
+/* ir_ssa_dominance_frontiers 求每个块的支配边界，frontier[b] 为块号列表，以-1结尾 */
+static int **ir_ssa_dominance_frontiers(IRCfg cfg)
+{
+    int *count = (int *)calloc(cfg->blockCount, sizeof(int));
+    int *capacity = (int *)calloc(cfg->blockCount, sizeof(int));
+    int **frontier = (int **)calloc(cfg->blockCount, sizeof(int *));
+    int *lastAdded = (int *)malloc(cfg->blockCount * sizeof(int));
+    for (int b = 0; b < cfg->blockCount; b++) {
+        lastAdded[b] = -1;
+    }
+
+    for (int b = 0; b < cfg->blockCount; b++) {
+        IRBlock *block = &cfg->blocks[b];
+        if (block->predCount < 2 || block->rpo < 0) {
+            continue;
+        }
+        // 从每个前驱沿支配树向上走到 b 的直接支配者，途经的块的支配边界都包含 b
+        for (int p = 0; p < block->predCount; p++) {
+            int runner = block->preds[p];
+            while (runner != block->idom && cfg->blocks[runner].rpo >= 0 && lastAdded[runner] != b) {
+                if (count[runner] + 1 >= capacity[runner]) {
+                    capacity[runner] = capacity[runner] ? capacity[runner] * 2 : 4;
+                    frontier[runner] = (int *)realloc(frontier[runner], capacity[runner] * sizeof(int));
+                }
+                frontier[runner][count[runner]++] = b;
+                lastAdded[runner] = b;
+                runner = cfg->blocks[runner].idom;
+            }
+        }
+    }
+
+    for (int b = 0; b < cfg->blockCount; b++) {
+        if (!frontier[b]) {
+            frontier[b] = (int *)malloc(sizeof(int));
+        }
+        frontier[b][count[b]] = -1;
+    }
+    free(count);
+    free(capacity);
+    free(lastAdded);
+    return frontier;
+}
+
+/* ir_ssa_insert_phi 在基本块开头插入变量的φ函数 */
+static void ir_ssa_insert_phi(IRCfg cfg, int b, int v)
+{
+    IRBlock *block = &cfg->blocks[b];
+    InterCodes position = block->first->code.kind == LABEL_InterCode ? block->first->next : block->first;
+    InterCodes phi = ir_insert_code_before(position, PHI_InterCode);
+    phi->code.u.phiOP.result = vars[v].orig;
+    phi->code.u.phiOP.argCount = block->predCount;
+    phi->code.u.phiOP.args = (Operand *)calloc(block->predCount, sizeof(Operand));
+
+    if (phiCount == phiCapacity) {
+        phiCapacity = phiCapacity ? phiCapacity * 2 : 64;
+        phis = (IRSsaPhi *)realloc(phis, phiCapacity * sizeof(IRSsaPhi));
+    }
+    phis[phiCount].code = phi;
+    phis[phiCount].var = v;
+    phis[phiCount].next = blockPhis[b];
+    phis[phiCount].live = false;
+    blockPhis[b] = phiCount++;
+}
+
+/* ir_ssa_place_phis 对跨基本块使用的值，在定值块的迭代支配边界上放置φ函数 */
+static void ir_ssa_place_phis(IRCfg cfg)
+{
+    int **frontier = ir_ssa_dominance_frontiers(cfg);
+    int *hasPhi = (int *)malloc(cfg->blockCount * sizeof(int));
+    int *inWork = (int *)malloc(cfg->blockCount * sizeof(int));
+    int *worklist = (int *)malloc(cfg->blockCount * sizeof(int));
+    for (int b = 0; b < cfg->blockCount; b++) {
+        hasPhi[b] = inWork[b] = -1;
+    }
+
+    for (int v = 0; v < varCount; v++) {
+        IRSsaVar *var = &vars[v];
+        if (!ir_ssa_is_renamed(var) || !var->global) {
+            continue;
+        }
+        int count = 0;
+        for (int i = 0; i < var->defBlockCount; i++) {
+            inWork[var->defBlocks[i]] = v;
+            worklist[count++] = var->defBlocks[i];
+        }
+        while (count > 0) {
+            int x = worklist[--count];
+            for (int *y = frontier[x]; *y >= 0; y++) {
+                if (hasPhi[*y] == v) {
+                    continue;
+                }
+                ir_ssa_insert_phi(cfg, *y, v);
+                hasPhi[*y] = v;
+                if (inWork[*y] != v) {
+                    inWork[*y] = v;
+                    worklist[count++] = *y;
+                }
+            }
+        }
+    }
+
+    for (int b = 0; b < cfg->blockCount; b++) {
+        free(frontier[b]);
+    }
+    free(frontier);
+    free(hasPhi);
+    free(inWork);
+    free(worklist);
+}
+
+/* ir_ssa_current 变量当前的版本 */
+static Operand ir_ssa_current(IRSsaVar *var)
+{
+    return var->current ? var->current : var->orig;
+}
+
+/* ir_ssa_new_version 为变量的一次定值创建新版本 */
+static Operand ir_ssa_new_version(IRSsaVar *var)
+{
+    Operand version = ir_new_temp();
+    if (var->orig->kind == VARIABLE_OP) {
+        version->varName = var->orig->varName;
+    }
+    return version;
+}
+
+/* ir_ssa_rename 沿支配树先序重命名：读取换成当前版本，定值产生新版本，离开子树时恢复。
+ * 能折叠的复制 x := y 不产生新版本，而是让 x 的当前版本直接等于 y 的当前版本，复制本身在最后删除 */
+static void ir_ssa_rename(IRCfg cfg)
+{
+    // 每次定值在日志中记下变量和原来的版本，离开块时倒序恢复
+    int logCapacity = 64;
+    int logCount = 0;
+    int *logVar = (int *)malloc(logCapacity * sizeof(int));
+    Operand *logPrev = (Operand *)malloc(logCapacity * sizeof(Operand));
+    int *logMark = (int *)malloc(cfg->blockCount * sizeof(int));
+    int foldedCount = 0;
+    int foldedCapacity = 16;
+    InterCodes *folded = (InterCodes *)malloc(foldedCapacity * sizeof(InterCodes));
+
+    // 栈中非负数表示进入块，~b 表示离开块
+    int *stack = (int *)malloc((cfg->blockCount * 2 + 1) * sizeof(int));
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        int item = stack[--top];
+        if (item < 0) {
+            int b = ~item;
+            while (logCount > logMark[b]) {
+                logCount--;
+                vars[logVar[logCount]].current = logPrev[logCount];
+            }
+            continue;
+        }
+
+        int b = item;
+        IRBlock *block = &cfg->blocks[b];
+        logMark[b] = logCount;
+        stack[top++] = ~b;
+
+        IR_FOR_EACH_BLOCK_CODE(block, code) {
+            bool fold = ir_ssa_is_foldable_copy(code);
+            if (code->code.kind != PHI_InterCode) {
+                Operand *uses[3];
+                int useCount = ir_get_use_operands(code, uses);
+                for (int i = 0; i < useCount; i++) {
+                    int v = ir_ssa_lookup(*uses[i]);
+                    if (v >= 0 && vars[v].current) {
+                        ir_ssa_replace_use(uses[i], vars[v].current);
+                    }
+                }
+            }
+
+            Operand *defSlot = ir_ssa_def_slot(code);
+            if (!defSlot) {
+                continue;
+            }
+            // φ函数的目标此时仍是原操作数
+            int v = ir_ssa_lookup(*defSlot);
+            if (v < 0 || (!fold && !ir_ssa_is_renamed(&vars[v]))) {
+                continue;
+            }
+            if (logCount == logCapacity) {
+                logCapacity *= 2;
+                logVar = (int *)realloc(logVar, logCapacity * sizeof(int));
+                logPrev = (Operand *)realloc(logPrev, logCapacity * sizeof(Operand));
+            }
+            logVar[logCount] = v;
+            logPrev[logCount] = vars[v].current;
+            logCount++;
+            if (fold) {
+                vars[v].current = code->code.u.doubleOP.right;
+                if (foldedCount == foldedCapacity) {
+                    foldedCapacity *= 2;
+                    folded = (InterCodes *)realloc(folded, foldedCapacity * sizeof(InterCodes));
+                }
+                folded[foldedCount++] = code;
+                continue;
+            }
+            // 形参的值在入口处就有，直接以原操作数作为版本
+            vars[v].current = code->code.kind == PARAM_InterCode ? vars[v].orig : ir_ssa_new_version(&vars[v]);
+            *defSlot = vars[v].current;
+        }
+
+        // 填写后继块中φ函数来自本块的参数
+        for (int s = 0; s < block->succCount; s++) {
+            int succ = block->succ[s];
+            int argIndex = ir_ssa_pred_index(&cfg->blocks[succ], b);
+            for (int p = blockPhis[succ]; p >= 0; p = phis[p].next) {
+                phis[p].code->code.u.phiOP.args[argIndex] = ir_ssa_current(&vars[phis[p].var]);
+            }
+        }
+
+        for (int child = block->domChild; child >= 0; child = cfg->blocks[child].domSibling) {
+            stack[top++] = child;
+        }
+    }
+
+    for (int i = 0; i < foldedCount; i++) {
+        ir_remove_code(folded[i]);
+    }
+
+    free(folded);
+    free(stack);
+    free(logVar);
+    free(logPrev);
+    free(logMark);
+}
+
+/* ir_ssa_remove_dead_phis 删除结果不被普通代码（直接或经由其他φ函数）使用的φ函数 */
+static void ir_ssa_remove_dead_phis(IRCfg cfg)
+{
+    if (phiCount == 0) {
+        return;
+    }
+    // φ函数的结果都是新的临时变量，按 var_no 找到定义它的φ函数
+    int tempBase = tempNo, tempEnd = 0;
+    for (int p = 0; p < phiCount; p++) {
+        int no = phis[p].code->code.u.phiOP.result->var_no;
+        tempBase = no < tempBase ? no : tempBase;
+        tempEnd = no + 1 > tempEnd ? no + 1 : tempEnd;
+    }
+    int *phiOfTemp = (int *)malloc((tempEnd - tempBase) * sizeof(int));
+    for (int i = 0; i < tempEnd - tempBase; i++) {
+        phiOfTemp[i] = -1;
+    }
+    for (int p = 0; p < phiCount; p++) {
+        phiOfTemp[phis[p].code->code.u.phiOP.result->var_no - tempBase] = p;
+    }
+
+    int *worklist = (int *)malloc(phiCount * sizeof(int));
+    int count = 0;
+#define IR_SSA_MARK_PHI_USE(op) do { \
+        Operand op_ = (op); \
+        if (op_ && op_->kind == TEMP_OP && op_->var_no >= tempBase && op_->var_no < tempEnd) { \
+            int p_ = phiOfTemp[op_->var_no - tempBase]; \
+            if (p_ >= 0 && !phis[p_].live) { \
+                phis[p_].live = true; \
+                worklist[count++] = p_; \
+            } \
+        } \
+    } while (0)
+
+    for (int b = 0; b < cfg->blockCount; b++) {
+        IR_FOR_EACH_BLOCK_CODE(&cfg->blocks[b], code) {
+            Operand *uses[3];
+            int useCount = ir_get_use_operands(code, uses);
+            for (int i = 0; i < useCount; i++) {
+                IR_SSA_MARK_PHI_USE(*uses[i]);
+            }
+        }
+    }
+    while (count > 0) {
+        InterCodes code = phis[worklist[--count]].code;
+        for (int i = 0; i < code->code.u.phiOP.argCount; i++) {
+            IR_SSA_MARK_PHI_USE(code->code.u.phiOP.args[i]);
+        }
+    }
+#undef IR_SSA_MARK_PHI_USE
+
+    int removed = 0;
+    for (int p = 0; p < phiCount; p++) {
+        if (!phis[p].live) {
+            free(phis[p].code->code.u.phiOP.args);
+            ir_remove_code(phis[p].code);
+            removed++;
+        }
+    }
+    IR_DEBUG(IR_DEBUG_INFO, "SSA: 放置%d个φ函数，删除其中%d个无用的\n", phiCount, removed);
+    free(phiOfTemp);
+    free(worklist);
+}
+
+void ir_build_ssa(IRCfg cfg)
+{
+    ir_cfg_remove_unreachable(cfg);
+    ir_ssa_label_blocks(cfg);
+    if (cfg->blockCount == 0) {
+        return;
+    }
+
+    ir_ssa_collect_vars(cfg);
+    phiCount = 0;
+    blockPhis = (int *)malloc(cfg->blockCount * sizeof(int));
+    for (int b = 0; b < cfg->blockCount; b++) {
+        blockPhis[b] = -1;
+    }
+    ir_ssa_place_phis(cfg);
+    // 重新划分基本块使φ函数落在块的范围内，图的形状不变
+    ir_rebuild_cfg(cfg);
+    ir_ssa_rename(cfg);
+    // 折叠掉的复制可能是块的首尾代码
+    ir_rebuild_cfg(cfg);
+    ir_ssa_remove_dead_phis(cfg);
+
+    free(blockPhis);
+    blockPhis = NULL;
+    ir_ssa_reset_index();
+    ir_rebuild_cfg(cfg);
+}
+
+void ir_ssa_remove_phi_arg(IRCfg cfg, int block, int predIndex)
+{
+    IR_SSA_FOR_EACH_PHI(&cfg->blocks[block], code) {
+        Operand *args = code->code.u.phiOP.args;
+        int count = --code->code.u.phiOP.argCount;
+        memmove(args + predIndex, args + predIndex + 1, (count - predIndex) * sizeof(Operand));
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* 消去SSA                                                             */
+/* ------------------------------------------------------------------ */
+
+/* ir_ssa_get_value 查找或登记与φ函数相关的值 */
+static int ir_ssa_get_value(Operand op)
+{
+    int *slot = ir_ssa_index_slot(op);
+    if (*slot < 0) {
+        if (valueCount == valueCapacity) {
+            valueCapacity = valueCapacity ? valueCapacity * 2 : 64;
+            values = (IRSsaValue *)realloc(values, valueCapacity * sizeof(IRSsaValue));
+        }
+        values[valueCount].op = op;
+        values[valueCount].web = valueCount;
+        values[valueCount].cls = valueCount;
+        *slot = valueCount++;
+    }
+    return *slot;
+}
+
+/* ir_ssa_find_web / ir_ssa_find_class 并查集查找，路径减半 */
+static int ir_ssa_find_web(int v)
+{
+    while (values[v].web != v) {
+        values[v].web = values[values[v].web].web;
+        v = values[v].web;
+    }
+    return v;
+}
+
+static int ir_ssa_find_class(int v)
+{
+    while (values[v].cls != v) {
+        values[v].cls = values[values[v].cls].cls;
+        v = values[v].cls;
+    }
+    return v;
+}
+
+/* ir_ssa_phi_value φ参数对应的值下标，常量返回-1 */
+static int ir_ssa_phi_value(Operand op)
+{
+    return ir_ssa_is_value(op) ? ir_ssa_lookup(op) : -1;
+}
+
+/* ir_ssa_compute_liveness 只对与φ函数相关的值求各块出口活跃集合，φ参数在对应前驱的出口活跃 */
+static unsigned int *ir_ssa_compute_liveness(IRCfg cfg, int words, unsigned int **liveInOut)
+{
+    size_t setSize = (size_t)cfg->blockCount * words;
+    unsigned int *useSet = (unsigned int *)calloc(setSize, sizeof(unsigned int));
+    unsigned int *defSet = (unsigned int *)calloc(setSize, sizeof(unsigned int));
+    unsigned int *phiUse = (unsigned int *)calloc(setSize, sizeof(unsigned int));
+    unsigned int *liveIn = (unsigned int *)calloc(setSize, sizeof(unsigned int));
+    unsigned int *liveOut = (unsigned int *)calloc(setSize, sizeof(unsigned int));
+
+    for (int b = 0; b < cfg->blockCount; b++) {
+        IRBlock *block = &cfg->blocks[b];
+        unsigned int *use = useSet + (size_t)b * words;
+        unsigned int *def = defSet + (size_t)b * words;
+        IR_FOR_EACH_BLOCK_CODE(block, code) {
+            if (code->code.kind == PHI_InterCode) {
+                // φ参数记到对应前驱的出口
+                for (int i = 0; i < code->code.u.phiOP.argCount && i < block->predCount; i++) {
+                    int v = ir_ssa_phi_value(code->code.u.phiOP.args[i]);
+                    if (v >= 0) {
+                        IR_BIT_SET(phiUse + (size_t)block->preds[i] * words, v);
+                    }
+                }
+            } else {
+                Operand *uses[3];
+                int useCount = ir_get_use_operands(code, uses);
+                for (int i = 0; i < useCount; i++) {
+                    int v = ir_ssa_lookup(*uses[i]);
+                    if (v >= 0 && !IR_BIT_TEST(def, v)) {
+                        IR_BIT_SET(use, v);
+                    }
+                }
+            }
+            Operand defOp = ir_get_def_operand(code);
+            int d = defOp ? ir_ssa_lookup(defOp) : -1;
+            if (d >= 0) {
+                IR_BIT_SET(def, d);
+            }
+        }
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int b = cfg->blockCount - 1; b >= 0; b--) {
+            IRBlock *block = &cfg->blocks[b];
+            unsigned int *out = liveOut + (size_t)b * words;
+            unsigned int *in = liveIn + (size_t)b * words;
+            unsigned int *use = useSet + (size_t)b * words;
+            unsigned int *def = defSet + (size_t)b * words;
+            unsigned int *phi = phiUse + (size_t)b * words;
+            for (int w = 0; w < words; w++) {
+                unsigned int newOut = phi[w];
+                for (int s = 0; s < block->succCount; s++) {
+                    newOut |= liveIn[(size_t)block->succ[s] * words + w];
+                }
+                unsigned int newIn = use[w] | (newOut & ~def[w]);
+                if (newOut != out[w] || newIn != in[w]) {
+                    out[w] = newOut;
+                    in[w] = newIn;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    free(useSet);
+    free(defSet);
+    free(phiUse);
+    *liveInOut = liveIn;
+    return liveOut;
+}
+
+/* ir_ssa_add_interference 记录同一个网中互相冲突的两个值 */
+static void ir_ssa_add_interference(int (**pairs)[2], int *count, int *capacity, int a, int b)
+{
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 64;
+        *pairs = realloc(*pairs, *capacity * sizeof(**pairs));
+    }
+    (*pairs)[*count][0] = a;
+    (*pairs)[*count][1] = b;
+    (*count)++;
+}
+
+/* ir_ssa_note_def 定值点与同一个网中此处活跃的值冲突（复制的源除外） */
+static void ir_ssa_note_def(unsigned int *live, int words, int d, int moveSrc,
+                            int (**pairs)[2], int *count, int *capacity)
+{
+    int web = ir_ssa_find_web(d);
+    for (int w = 0; w < words; w++) {
+        unsigned int bits = live[w];
+        while (bits) {
+            int v = (w << 5) + __builtin_ctz(bits);
+            bits &= bits - 1;
+            if (v != d && v != moveSrc && ir_ssa_find_web(v) == web) {
+                ir_ssa_add_interference(pairs, count, capacity, d, v);
+            }
+        }
+    }
+}
+
+/* ir_ssa_collect_interference 逆序扫描每个块，求同一个网中冲突的值对 */
+static int ir_ssa_collect_interference(IRCfg cfg, unsigned int *liveOut, int words, int (**pairs)[2])
+{
+    int count = 0, capacity = 0;
+    unsigned int *live = (unsigned int *)malloc(words * sizeof(unsigned int));
+    *pairs = NULL;
+
+    for (int b = 0; b < cfg->blockCount; b++) {
+        IRBlock *block = &cfg->blocks[b];
+        memcpy(live, liveOut + (size_t)b * words, words * sizeof(unsigned int));
+        InterCodes code = block->last;
+        while (true) {
+            if (code->code.kind != PHI_InterCode) {
+                Operand defOp = ir_get_def_operand(code);
+                int d = defOp ? ir_ssa_lookup(defOp) : -1;
+                if (d >= 0) {
+                    int moveSrc = -1;
+                    if (code->code.kind == ASSIGN_InterCode && code->code.u.doubleOP.right->type == VAL) {
+                        moveSrc = ir_ssa_lookup(code->code.u.doubleOP.right);
+                    }
+                    ir_ssa_note_def(live, words, d, moveSrc, pairs, &count, &capacity);
+                    IR_BIT_CLEAR(live, d);
+                }
+                Operand *uses[3];
+                int useCount = ir_get_use_operands(code, uses);
+                for (int i = 0; i < useCount; i++) {
+                    int v = ir_ssa_lookup(*uses[i]);
+                    if (v >= 0) {
+                        IR_BIT_SET(live, v);
+                    }
+                }
+            }
+            if (code == block->first) {
+                break;
+            }
+            code = code->prev;
+        }
+
+        // φ函数的目标在块入口同时定值，与此时所有活跃的值冲突
+        IR_SSA_FOR_EACH_PHI(block, phi) {
+            int d = ir_ssa_lookup(phi->code.u.phiOP.result);
+            ir_ssa_note_def(live, words, d, -1, pairs, &count, &capacity);
+        }
+    }
+
+    free(live);
+    return count;
+}
+
+/* ir_ssa_compare_copies 循环深的复制先合并，深度相同时保持代码顺序 */
+static int ir_ssa_compare_copies(const void *a, const void *b)
+{
+    const IRSsaCopy *x = (const IRSsaCopy *)a;
+    const IRSsaCopy *y = (const IRSsaCopy *)b;
+    if (x->depth != y->depth) {
+        return y->depth - x->depth;
+    }
+    return x->order - y->order;
+}
+
+/* ir_ssa_classes_interfere 合并后的两个名字是否有冲突的成员 */
+static bool ir_ssa_classes_interfere(int (*pairs)[2], int start, int end, int a, int b)
+{
+    for (int i = start; i < end; i++) {
+        int x = ir_ssa_find_class(pairs[i][0]);
+        int y = ir_ssa_find_class(pairs[i][1]);
+        if ((x == a && y == b) || (x == b && y == a)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ir_ssa_coalesce 按网分组冲突对，再依次尝试合并φ函数的目标和参数 */
+static void ir_ssa_coalesce(IRSsaCopy *copies, int copyCount, int (*pairs)[2], int pairCount)
+{
+    // 按网号计数排序冲突对
+    int *pairStart = (int *)calloc(valueCount + 1, sizeof(int));
+    int (*sorted)[2] = malloc((pairCount + 1) * sizeof(*sorted));
+    for (int i = 0; i < pairCount; i++) {
+        pairStart[ir_ssa_find_web(pairs[i][0]) + 1]++;
+    }
+    for (int w = 0; w < valueCount; w++) {
+        pairStart[w + 1] += pairStart[w];
+    }
+    int *fill = (int *)malloc((valueCount + 1) * sizeof(int));
+    memcpy(fill, pairStart, (valueCount + 1) * sizeof(int));
+    for (int i = 0; i < pairCount; i++) {
+        int web = ir_ssa_find_web(pairs[i][0]);
+        sorted[fill[web]][0] = pairs[i][0];
+        sorted[fill[web]][1] = pairs[i][1];
+        fill[web]++;
+    }
+
+    if (copyCount > 1) {
+        qsort(copies, copyCount, sizeof(IRSsaCopy), ir_ssa_compare_copies);
+    }
+    for (int i = 0; i < copyCount; i++) {
+        int a = ir_ssa_find_class(copies[i].dest);
+        int b = ir_ssa_find_class(copies[i].src);
+        if (a == b) {
+            continue;
+        }
+        int web = ir_ssa_find_web(copies[i].dest);
+        if (!ir_ssa_classes_interfere(sorted, pairStart[web], pairStart[web + 1], a, b)) {
+            values[b].cls = a;
+        }
+    }
+
+    free(pairStart);
+    free(sorted);
+    free(fill);
+}
+
+/* ir_ssa_choose_names 每个合并后的名字选一个代表操作数，优先使用原来的变量；
+ * 有 *t 形式读取的名字必须是临时变量，变量的 ADDRESS 形式表示取地址而不是解引用 */
+static Operand *ir_ssa_choose_names(IRCfg cfg)
+{
+    bool *deref = (bool *)calloc(valueCount, sizeof(bool));
+    for (int b = 0; b < cfg->blockCount; b++) {
+        IR_FOR_EACH_BLOCK_CODE(&cfg->blocks[b], code) {
+            Operand *uses[3];
+            int useCount = ir_get_use_operands(code, uses);
+            for (int i = 0; i < useCount; i++) {
+                int v = (*uses[i])->type == ADDRESS ? ir_ssa_phi_value(*uses[i]) : -1;
+                if (v >= 0 && (*uses[i])->kind == TEMP_OP) {
+                    deref[ir_ssa_find_class(v)] = true;
+                }
+            }
+        }
+    }
+
+    Operand *names = (Operand *)calloc(valueCount, sizeof(Operand));
+    for (int v = 0; v < valueCount; v++) {
+        int c = ir_ssa_find_class(v);
+        Operand op = values[v].op;
+        Operand best = names[c];
+        bool preferVariable = !deref[c];
+        if (!best || (op->kind != best->kind && (op->kind == VARIABLE_OP) == preferVariable) ||
+            (op->kind == best->kind && op->var_no < best->var_no)) {
+            names[c] = op;
+        }
+    }
+    free(deref);
+    return names;
+}
+
+/* ir_ssa_name 值合并后的名字，常量和其他值保持不变 */
+static Operand ir_ssa_name(Operand *names, Operand op)
+{
+    int v = ir_ssa_phi_value(op);
+    if (v < 0) {
+        return op;
+    }
+    Operand name = names[ir_ssa_find_class(v)];
+    return name ? name : op;
+}
+
+/* ir_ssa_insert_assign 在指定位置之前插入 dest := src */
+static void ir_ssa_insert_assign(InterCodes position, Operand dest, Operand src)
+{
+    InterCodes code = ir_insert_code_before(position, ASSIGN_InterCode);
+    code->code.u.doubleOP.left = dest;
+    code->code.u.doubleOP.right = src;
+}
+
+/* ir_ssa_emit_parallel_copy 把一组并行复制排成顺序执行的复制，环用一个新临时变量打断 */
+static void ir_ssa_emit_parallel_copy(InterCodes position, IRSsaMove *moves, int count)
+{
+    while (count > 0) {
+        int ready = -1;
+        for (int i = 0; i < count && ready < 0; i++) {
+            bool isSource = false;
+            for (int j = 0; j < count && !isSource; j++) {
+                isSource = j != i && ir_ssa_is_value(moves[j].src) && moves[j].src->kind == moves[i].dest->kind &&
+                           moves[j].src->var_no == moves[i].dest->var_no;
+            }
+            if (!isSource) {
+                ready = i;
+            }
+        }
+        if (ready >= 0) {
+            ir_ssa_insert_assign(position, moves[ready].dest, moves[ready].src);
+            moves[ready] = moves[--count];
+            continue;
+        }
+
+        // 所有目标都还要被读取，说明形成了环：先保存一个目标的旧值
+        Operand saved = moves[0].dest;
+        Operand temp = ir_new_temp();
+        ir_ssa_insert_assign(position, temp, saved);
+        for (int j = 0; j < count; j++) {
+            if (ir_ssa_is_value(moves[j].src) && moves[j].src->kind == saved->kind &&
+                moves[j].src->var_no == saved->var_no) {
+                moves[j].src = temp;
+            }
+        }
+    }
+}
+
+/* ir_ssa_copy_fits_before_branch 条件跳转的另一个后继不需要这些目标的旧值，且跳转本身不读取它们；
+ * otherReads 是另一条边上φ函数读取的值，φ函数此时已被删除 */
+static bool ir_ssa_copy_fits_before_branch(InterCodes branch, int other, IRSsaMove *moves, int count,
+                                           Operand *otherReads, int otherCount, unsigned int *liveIn, int words)
+{
+    for (int i = 0; i < count; i++) {
+        Operand dest = moves[i].dest;
+        if (ir_ssa_is_value(branch->code.u.ifgotoOP.op1) && branch->code.u.ifgotoOP.op1->kind == dest->kind &&
+            branch->code.u.ifgotoOP.op1->var_no == dest->var_no) {
+            return false;
+        }
+        if (ir_ssa_is_value(branch->code.u.ifgotoOP.op2) && branch->code.u.ifgotoOP.op2->kind == dest->kind &&
+            branch->code.u.ifgotoOP.op2->var_no == dest->var_no) {
+            return false;
+        }
+        int cls = ir_ssa_find_class(ir_ssa_lookup(dest));
+        for (int v = 0; v < valueCount; v++) {
+            if (ir_ssa_find_class(v) == cls && IR_BIT_TEST(liveIn + (size_t)other * words, v)) {
+                return false;
+            }
+        }
+        // 另一个后继的φ函数也可能在那条边上读取它们
+        for (int j = 0; j < otherCount; j++) {
+            int v = ir_ssa_phi_value(otherReads[j]);
+            if (v >= 0 && ir_ssa_find_class(v) == cls) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/* ir_ssa_function_end 在函数末尾追加代码的位置；最后一块可能顺序执行到函数末尾时先用跳转保护 */
+static InterCodes ir_ssa_function_end(IRCfg cfg)
+{
+    InterCodes last = cfg->blocks[cfg->blockCount - 1].last;
+    InterCodes end = last->next;
+    if (last->code.kind != GOTO_InterCode && last->code.kind != RETURN_InterCode) {
+        Operand exitLabel = ir_new_label();
+        InterCodes label = ir_insert_code_before(end, LABEL_InterCode);
+        label->code.u.singleOP.op = exitLabel;
+        InterCodes jump = ir_insert_code_before(label, GOTO_InterCode);
+        jump->code.u.singleOP.op = exitLabel;
+        return label;
+    }
+    return end;
+}
+
+/* ir_ssa_remove_unused_labels 删除没有跳转指向的标号，包括构造时补上的标号 */
+static void ir_ssa_remove_unused_labels(IRCfg cfg)
+{
+    bool *used = (bool *)calloc(labelNo, sizeof(bool));
+    for (int b = 0; b < cfg->blockCount; b++) {
+        int target = ir_get_jump_target(cfg->blocks[b].last);
+        if (target >= 0) {
+            used[target] = true;
+        }
+    }
+    int removed = 0;
+    for (int b = 0; b < cfg->blockCount; b++) {
+        InterCodes first = cfg->blocks[b].first;
+        int label = ir_get_label_no(first);
+        if (label >= 0 && !used[label]) {
+            ir_remove_code(first);
+            removed++;
+        }
+    }
+    free(used);
+    if (removed > 0) {
+        ir_rebuild_cfg(cfg);
+    }
+}
+
+void ir_destroy_ssa(IRCfg cfg)
+{
+    // 登记φ函数的目标和参数，并把它们连成网
+    int copyCount = 0, copyCapacity = 0;
+    IRSsaCopy *copies = NULL;
+    for (int b = 0; b < cfg->blockCount; b++) {
+        IRBlock *block = &cfg->blocks[b];
+        IR_SSA_FOR_EACH_PHI(block, code) {
+            int d = ir_ssa_get_value(code->code.u.phiOP.result);
+            if (code->code.u.phiOP.argCount != block->predCount) {
+                IR_DEBUG(IR_DEBUG_ERROR, "φ函数参数个数与前驱个数不一致\n");
+            }
+            for (int i = 0; i < code->code.u.phiOP.argCount; i++) {
+                Operand arg = code->code.u.phiOP.args[i];
+                if (!ir_ssa_is_value(arg)) {
+                    continue;
+                }
+                int a = ir_ssa_get_value(arg);
+                int wa = ir_ssa_find_web(a), wd = ir_ssa_find_web(d);
+                if (wa != wd) {
+                    values[wa].web = wd;
+                }
+                if (copyCount == copyCapacity) {
+                    copyCapacity = copyCapacity ? copyCapacity * 2 : 64;
+                    copies = (IRSsaCopy *)realloc(copies, copyCapacity * sizeof(IRSsaCopy));
+                }
+                copies[copyCount].dest = d;
+                copies[copyCount].src = a;
+                copies[copyCount].depth = i < block->predCount ? ir_cfg_loop_depth(cfg, block->preds[i]) : 0;
+                copies[copyCount].order = copyCount;
+                copyCount++;
+            }
+        }
+    }
+    if (valueCount == 0) {
+        free(copies);
+        ir_ssa_remove_unused_labels(cfg);
+        return;
+    }
+
+    int words = (valueCount + 31) >> 5;
+    unsigned int *liveIn = NULL;
+    unsigned int *liveOut = ir_ssa_compute_liveness(cfg, words, &liveIn);
+    int (*pairs)[2] = NULL;
+    int pairCount = ir_ssa_collect_interference(cfg, liveOut, words, &pairs);
+    ir_ssa_coalesce(copies, copyCount, pairs, pairCount);
+    Operand *names = ir_ssa_choose_names(cfg);
+
+    // 按并行复制的放置位置记录每条边上的复制，最后统一插入
+    int moveCapacity = 16;
+    IRSsaMove *moves = (IRSsaMove *)malloc(moveCapacity * sizeof(IRSsaMove));
+    int edgeCapacity = 16, edgeCount = 0;
+    struct { int block, pred; } *edges = malloc(edgeCapacity * sizeof(*edges));
+    for (int b = 0; b < cfg->blockCount; b++) {
+        IRBlock *block = &cfg->blocks[b];
+        if (!ir_ssa_first_phi(block)) {
+            continue;
+        }
+        for (int p = 0; p < block->predCount; p++) {
+            if (edgeCount == edgeCapacity) {
+                edgeCapacity *= 2;
+                edges = realloc(edges, edgeCapacity * sizeof(*edges));
+            }
+            edges[edgeCount].block = b;
+            edges[edgeCount].pred = p;
+            edgeCount++;
+        }
+    }
+
+    // 先算出每条边上的复制，再改写代码，避免位置失效
+    // 每条边上φ函数读取的值（包括合并后不需要复制的）也记下来，插入复制时据此判断会不会覆盖它们
+    int *moveStart = (int *)malloc((edgeCount + 1) * sizeof(int));
+    int moveCount = 0;
+    int *readStart = (int *)malloc((edgeCount + 1) * sizeof(int));
+    int readCount = 0, readCapacity = 16;
+    Operand *reads = (Operand *)malloc(readCapacity * sizeof(Operand));
+    for (int e = 0; e < edgeCount; e++) {
+        IRBlock *block = &cfg->blocks[edges[e].block];
+        moveStart[e] = moveCount;
+        readStart[e] = readCount;
+        IR_SSA_FOR_EACH_PHI(block, code) {
+            Operand dest = ir_ssa_name(names, code->code.u.phiOP.result);
+            Operand src = edges[e].pred < code->code.u.phiOP.argCount ?
+                          ir_ssa_name(names, code->code.u.phiOP.args[edges[e].pred]) : NULL;
+            if (src) {
+                if (readCount == readCapacity) {
+                    readCapacity *= 2;
+                    reads = (Operand *)realloc(reads, readCapacity * sizeof(Operand));
+                }
+                reads[readCount++] = src;
+            }
+            if (src && !(ir_ssa_is_value(src) && src->kind == dest->kind && src->var_no == dest->var_no)) {
+                if (moveCount == moveCapacity) {
+                    moveCapacity *= 2;
+                    moves = (IRSsaMove *)realloc(moves, moveCapacity * sizeof(IRSsaMove));
+                }
+                moves[moveCount].dest = dest;
+                moves[moveCount].src = src;
+                moveCount++;
+            }
+        }
+    }
+    moveStart[edgeCount] = moveCount;
+    readStart[edgeCount] = readCount;
+
+    // 把所有相关的值换成合并后的名字，并删除φ函数
+    for (int b = 0; b < cfg->blockCount; b++) {
+        IRBlock *block = &cfg->blocks[b];
+        InterCodes stop = block->last->next;
+        for (InterCodes code = block->first; code != stop;) {
+            InterCodes next = code->next;
+            if (code->code.kind == PHI_InterCode) {
+                // 只剩φ函数的块删除后以开头的标号结尾，后面插入复制时要用到新的末尾
+                if (code == block->last) {
+                    block->last = code->prev;
+                }
+                free(code->code.u.phiOP.args);
+                ir_remove_code(code);
+                code = next;
+                continue;
+            }
+            Operand *uses[3];
+            int useCount = ir_get_use_operands(code, uses);
+            for (int i = 0; i < useCount; i++) {
+                Operand name = ir_ssa_name(names, *uses[i]);
+                if (name != *uses[i]) {
+                    ir_ssa_replace_use(uses[i], name);
+                }
+            }
+            Operand *defSlot = ir_ssa_def_slot(code);
+            if (defSlot) {
+                *defSlot = ir_ssa_name(names, *defSlot);
+            }
+            code = next;
+        }
+    }
+
+    // 在边上插入并行复制：前驱只有一个后继时放在末尾，否则放在条件跳转之后或拆分关键边
+    InterCodes functionEnd = NULL;
+    int inserted = 0;
+    for (int e = 0; e < edgeCount; e++) {
+        int count = moveStart[e + 1] - moveStart[e];
+        if (count == 0) {
+            continue;
+        }
+        inserted += count;
+        int b = edges[e].block;
+        int pred = cfg->blocks[b].preds[edges[e].pred];
+        InterCodes last = cfg->blocks[pred].last;
+        IRSsaMove *edgeMoves = moves + moveStart[e];
+
+        if (last->code.kind == GOTO_InterCode) {
+            ir_ssa_emit_parallel_copy(last, edgeMoves, count);
+        } else if (last->code.kind != IFGOTO_InterCode) {
+            ir_ssa_emit_parallel_copy(last->next, edgeMoves, count);
+        } else if (ir_cfg_label_block(cfg, ir_get_jump_target(last)) != b) {
+            // 顺序执行的边：复制放在条件跳转之后
+            ir_ssa_emit_parallel_copy(last->next, edgeMoves, count);
+        } else {
+            int other = cfg->blocks[pred].succ[0] == b ? cfg->blocks[pred].succ[1] : cfg->blocks[pred].succ[0];
+            int otherStart = 0, otherCount = 0;
+            for (int k = 0; k < edgeCount && other >= 0; k++) {
+                if (edges[k].block == other && cfg->blocks[other].preds[edges[k].pred] == pred) {
+                    otherStart = readStart[k];
+                    otherCount = readStart[k + 1] - readStart[k];
+                }
+            }
+            if (other < 0 && pred + 1 == b) {
+                // 跳转目标就是下一块，条件跳转没有作用，用复制代替它
+                ir_ssa_emit_parallel_copy(last, edgeMoves, count);
+                ir_remove_code(last);
+            } else if (other >= 0 && ir_ssa_copy_fits_before_branch(last, other, edgeMoves, count, reads + otherStart,
+                                                                    otherCount, liveIn, words)) {
+                ir_ssa_emit_parallel_copy(last, edgeMoves, count);
+            } else {
+                // 拆分关键边：条件跳转改为跳到函数末尾的新块，新块复制后再跳回原目标
+                if (!functionEnd) {
+                    functionEnd = ir_ssa_function_end(cfg);
+                }
+                Operand edgeLabel = ir_new_label();
+                InterCodes label = ir_insert_code_before(functionEnd, LABEL_InterCode);
+                label->code.u.singleOP.op = edgeLabel;
+                InterCodes jump = ir_insert_code_before(functionEnd, GOTO_InterCode);
+                jump->code.u.singleOP.op = last->code.u.ifgotoOP.label;
+                ir_ssa_emit_parallel_copy(jump, edgeMoves, count);
+                last->code.u.ifgotoOP.label = edgeLabel;
+            }
+        }
+    }
+    IR_DEBUG(IR_DEBUG_INFO, "SSA: %d个φ相关的值，合并后插入%d条复制\n", valueCount, inserted);
+
+    free(moves);
+    free(moveStart);
+    free(reads);
+    free(readStart);
+    free(edges);
+    free(names);
+    free(pairs);
+    free(liveIn);
+    free(liveOut);
+    free(copies);
+    ir_ssa_reset_index();
+    ir_rebuild_cfg(cfg);
+
+    ir_ssa_remove_unused_labels(cfg);
+}
+
+int ir_value_index(IRValueTable table, Operand op)
+{
+    if (!op) {
+        return -1;
+    }
+    int v = -1;
+    if (op->kind == VARIABLE_OP) {
+        v = op->var_no;
+    }
+    else if (op->kind == TEMP_OP) {
+        v = table->tempOffset + op->var_no;
+    }
+    return v < table->count ? v : -1;
+}
+
+IRValueTable ir_build_value_table(IRCfg cfg, bool collectUses)
+{
+    IRValueTable table = (IRValueTable)calloc(1, sizeof(struct IRValueTable_));
+    table->tempOffset = varNo;
+    table->count = varNo + tempNo;
+    table->defCount = (int *)calloc(table->count, sizeof(int));
+    table->defCode = (InterCodes *)calloc(table->count, sizeof(InterCodes));
+    table->defBlock = (int *)calloc(table->count, sizeof(int));
+    table->inMemory = (bool *)calloc(table->count, sizeof(bool));
+
+    // 第一遍统计定值和每个值的读取次数，第二遍按计数填入读取列表
+    int *useCount = collectUses ? (int *)calloc(table->count + 1, sizeof(int)) : NULL;
+    for (int pass = 0; pass < (collectUses ? 2 : 1); pass++) {
+        for (int b = 0; b < cfg->blockCount; b++) {
+            IR_FOR_EACH_BLOCK_CODE(&cfg->blocks[b], code) {
+                Operand *slots[3];
+                int slotCount = ir_get_use_operands(code, slots);
+                int argCount = code->code.kind == PHI_InterCode ? code->code.u.phiOP.argCount : 0;
+                for (int i = 0; i < slotCount + argCount; i++) {
+                    Operand *slot = i < slotCount ? slots[i] : &code->code.u.phiOP.args[i - slotCount];
+                    int v = ir_value_index(table, *slot);
+                    if (v < 0) {
+                        continue;
+                    }
+                    if (pass == 0) {
+                        if ((*slot)->kind == VARIABLE_OP && (*slot)->type == ADDRESS) {
+                            table->inMemory[v] = true;
+                        }
+                        if (useCount) {
+                            useCount[v]++;
+                        }
+                    }
+                    else {
+                        IRValueUse *use = &table->uses[table->useStart[v] + useCount[v]++];
+                        use->code = code;
+                        use->block = b;
+                        use->slot = slot;
+                    }
+                }
+                if (pass == 1) {
+                    continue;
+                }
+
+                table->codeCount++;
+                if (code->code.kind == DEC_InterCode || code->code.kind == GET_ADDR_InterCode) {
+                    Operand object = code->code.kind == DEC_InterCode ? code->code.u.doubleOP.left
+                                                                      : code->code.u.doubleOP.right;
+                    int v = ir_value_index(table, object);
+                    if (v >= 0) {
+                        table->inMemory[v] = true;
+                    }
+                }
+                Operand def = ir_get_def_operand(code);
+                int v = ir_value_index(table, def);
+                if (v >= 0) {
+                    table->defCount[v]++;
+                    table->defCode[v] = code;
+                    table->defBlock[v] = b;
+                    if (def->type == ADDRESS) {
+                        table->inMemory[v] = true;
+                    }
+                }
+            }
+        }
+
+        if (pass == 0 && useCount) {
+            table->useStart = (int *)malloc((table->count + 1) * sizeof(int));
+            table->useStart[0] = 0;
+            for (int v = 0; v < table->count; v++) {
+                table->useStart[v + 1] = table->useStart[v] + useCount[v];
+                useCount[v] = 0;
+            }
+            table->uses = (IRValueUse *)malloc((table->useStart[table->count] + 1) * sizeof(IRValueUse));
+        }
+    }
+    free(useCount);
+    return table;
+}
+
+void ir_free_value_table(IRValueTable table)
+{
+    if (!table) {
+        return;
+    }
+    free(table->defCount);
+    free(table->defCode);
+    free(table->defBlock);
+    free(table->inMemory);
+    free(table->useStart);
+    free(table->uses);
+    free(table);
+}
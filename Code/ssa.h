@@ -0,0 +1,76 @@
+#ifndef SSA_H
+#define SSA_H
+
+#include "optimize.h"
+
+/* SSA模块：把一个函数的中间代码转换为静态单赋值形式，优化完成后再转换回来 */
+
+/**
+ * @brief 构造SSA形式
+ *        先删除不可达块，并给每个基本块补上标号（入口块另加一个没有前驱的标号），使块在代码被删光后仍然存在；按支配边界放置φ函数（只为跨基本块活跃的值放置），
+ *        再沿支配树重命名，每次定值都得到新的临时变量，复制 x := y 被折叠为直接使用 y，最后删除无用的φ函数。
+ *        数组、结构体和被取地址的变量留在内存中，不参与重命名；只定值一次的值本身已满足SSA，保持原名。
+ *        φ函数紧跟在基本块的标号之后，第i个参数对应所在块的第i个前驱。
+ * @param cfg 函数的控制流图，返回时已重新构建
+ */
+void ir_build_ssa(IRCfg cfg);
+
+/**
+ * @brief 消去φ函数，回到普通的中间代码
+ *        通过φ函数相关联的值先按活跃区间判断冲突，不冲突的合并为同一个名字（循环内的复制优先合并）；
+ *        剩下的φ参数在前驱块末尾插入并行复制，必要时拆分关键边；最后删除没有跳转指向的标号。
+ * @param cfg 函数的控制流图，返回时已重新构建
+ */
+void ir_destroy_ssa(IRCfg cfg);
+
+/**
+ * @brief 删除基本块某个前驱对应的φ参数，在删除控制流边之前调用
+ * @param cfg 控制流图
+ * @param block 基本块编号
+ * @param predIndex 前驱在 preds 中的下标
+ */
+void ir_ssa_remove_phi_arg(IRCfg cfg, int block, int predIndex);
+
+/* 一处读取：所在的代码、基本块和被读取的操作数位置，φ参数也算在内 */
+typedef struct IRValueUse_ {
+    InterCodes code;
+    int block;
+    Operand *slot;
+} IRValueUse;
+
+/* 值表：函数中的变量和临时变量统一编号，变量在前，临时变量在后；供各个优化遍共用 */
+typedef struct IRValueTable_ {
+    int count;               // 值的个数，只包括建表时已经存在的变量和临时变量
+    int tempOffset;          // 第一个临时变量的下标
+    int codeCount;           // 函数的代码条数
+    int *defCount;           // 定值次数
+    InterCodes *defCode;     // 最后一次定值的代码，定值唯一时就是唯一的定值代码
+    int *defBlock;           // 最后一次定值所在的基本块
+    bool *inMemory;          // 数组、结构体、被取地址或以 *x 形式读写，不能当作寄存器中的值处理
+    int *useStart;           // 读取列表按值排列，useStart[v] 到 useStart[v + 1]；不收集读取时为NULL
+    IRValueUse *uses;
+} *IRValueTable;
+
+/**
+ * @brief 扫描函数建立值表：统计每个值的定值次数、最后一次定值和是否在内存中，可选地建立读取列表
+ * @param cfg 函数的控制流图
+ * @param collectUses 是否建立读取列表
+ * @return 值表，用 ir_free_value_table 释放
+ */
+IRValueTable ir_build_value_table(IRCfg cfg, bool collectUses);
+
+/**
+ * @brief 变量或临时变量在值表中的下标
+ * @param table 值表
+ * @param op 操作数
+ * @return 下标，常量、标号、函数名和建表之后才创建的值返回-1
+ */
+int ir_value_index(IRValueTable table, Operand op);
+
+/**
+ * @brief 释放值表
+ * @param table 值表
+ */
+void ir_free_value_table(IRValueTable table);
+
+#endif
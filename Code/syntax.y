@@ -7,11 +7,11 @@
 	int yyerror(char* msg);
 	extern int yylineno;
 	
-	static ASTNode* make_node(const char* name,int lineno,int child_count)
+	static ASTNodeId make_node(int kind, int production, int child_count)
 	{
-		if (child_count == 0) return NULL;
-		ASTNode* node = ast_create_node(name, "", NODE_TYPE_NON_TERMINAL, lineno);
-		return node;
+		if (child_count == 0) return 0;
+		/* 行号在 ast_add_child 中取第一个子节点的行号 */
+		return ast_create_node(kind, production, "", yylineno);
 	}
 %}
 
@@ -19,7 +19,7 @@
     int type_int;
     float type_float;
     char* type_string;
-    ASTNode* node;
+    ASTNodeId node;
 };
 
 
@@ -51,36 +51,36 @@
 
 /*--------------------High-level Definitions--------------------*/
 Program : ExtDefList {
-        $$ = make_node("Program", $1->lineno, 1);
+        $$ = make_node(AST_Program, PROD_Program, 1);
         ast_add_child($$, 1, $1);
-        ast_root = $$;
+        ast_root = ast_node($$);
     }
 ;
 
 ExtDefList : ExtDef ExtDefList {
-        $$ = make_node("ExtDefList", $1->lineno, 2);
-        ast_add_child($$, 2, $2, $1);
+        $$ = make_node(AST_ExtDefList, PROD_ExtDefList, 2);
+        ast_add_child($$, 2, $1, $2);
     }
 |   /*empty*/ {
-        $$ = NULL;
+        $$ = 0;
     }
 ;
 
 ExtDef : Specifier ExtDecList SEMI {
-        $$ = make_node("ExtDef", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_ExtDef, PROD_ExtDef_Global, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | Specifier SEMI {
-        $$ = make_node("ExtDef", $1->lineno, 2);
-        ast_add_child($$, 2, $2, $1);
+        $$ = make_node(AST_ExtDef, PROD_ExtDef_Type, 2);
+        ast_add_child($$, 2, $1, $2);
     }
 | Specifier FunDec CompSt {
-        $$ = make_node("ExtDef", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_ExtDef, PROD_ExtDef_Function, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | Specifier FunDec SEMI {
-        $$ = make_node("ExtDef", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_ExtDef, PROD_ExtDef_FunDecl, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | error SEMI {
     errorSyntaxFlag++;
@@ -91,32 +91,32 @@ ExtDef : Specifier ExtDecList SEMI {
 ;
 
 ExtDecList : VarDec {
-        $$ = make_node("ExtDecList", $1->lineno, 1);
+        $$ = make_node(AST_ExtDecList, PROD_ExtDecList_Single, 1);
         ast_add_child($$, 1, $1);
     }
 | VarDec COMMA ExtDecList {
-        $$ = make_node("ExtDecList", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_ExtDecList, PROD_ExtDecList_List, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 ;
 
 Specifier : TYPE  {
-        $$ = make_node("Specifier", $1->lineno, 1);
+        $$ = make_node(AST_Specifier, PROD_Specifier_Type, 1);
         ast_add_child($$, 1, $1);
     }
 | StructSpecifier  {
-        $$ = make_node("Specifier", $1->lineno, 1);
+        $$ = make_node(AST_Specifier, PROD_Specifier_Struct, 1);
         ast_add_child($$, 1, $1);
     }
 ;
 
 StructSpecifier : STRUCT OptTag LC DefList RC {
-        $$ = make_node("StructSpecifier", $1->lineno, 5);
-        ast_add_child($$, 5, $5, $4, $3, $2, $1);
+        $$ = make_node(AST_StructSpecifier, PROD_StructSpecifier_Def, 5);
+        ast_add_child($$, 5, $1, $2, $3, $4, $5);
     }
 | STRUCT Tag {
-        $$ = make_node("StructSpecifier", $1->lineno, 2);
-        ast_add_child($$, 2, $2, $1);
+        $$ = make_node(AST_StructSpecifier, PROD_StructSpecifier_Tag, 2);
+        ast_add_child($$, 2, $1, $2);
     }
 | error{
     errorSyntaxFlag++;
@@ -124,37 +124,37 @@ StructSpecifier : STRUCT OptTag LC DefList RC {
 ;
 
 OptTag : ID {
-        $$ = make_node("OptTag", $1->lineno, 1);
+        $$ = make_node(AST_OptTag, PROD_OptTag, 1);
         ast_add_child($$, 1, $1);
     }
 |   /* empty */  {
-        $$ = NULL;
+        $$ = 0;
     }
 ;
 
 Tag : ID {
-        $$ = make_node("Tag", $1->lineno, 1);
+        $$ = make_node(AST_Tag, PROD_Tag, 1);
         ast_add_child($$, 1, $1);
     }
 ;
 
 VarDec : ID {
-        $$ = make_node("VarDec", $1->lineno, 1);
+        $$ = make_node(AST_VarDec, PROD_VarDec_ID, 1);
         ast_add_child($$, 1, $1);
     }
 | VarDec LB INT RB {
-        $$ = make_node("VarDec", $1->lineno, 4);
-        ast_add_child($$, 4, $4, $3, $2, $1);
+        $$ = make_node(AST_VarDec, PROD_VarDec_Array, 4);
+        ast_add_child($$, 4, $1, $2, $3, $4);
     }
 ;
 
 FunDec : ID LP VarList RP {
-        $$ = make_node("FunDec", $1->lineno, 4);
-        ast_add_child($$, 4, $4, $3, $2, $1);
+        $$ = make_node(AST_FunDec, PROD_FunDec_Params, 4);
+        ast_add_child($$, 4, $1, $2, $3, $4);
     }
 | ID LP RP {
-        $$ = make_node("FunDec", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_FunDec, PROD_FunDec_NoParams, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | ID LP error RP {
         errorSyntaxFlag++;
@@ -165,24 +165,24 @@ FunDec : ID LP VarList RP {
 ;
 
 VarList : ParamDec COMMA VarList {
-        $$ = make_node("VarList", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_VarList, PROD_VarList_List, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | ParamDec {
-        $$ = make_node("VarList", $1->lineno, 1);
+        $$ = make_node(AST_VarList, PROD_VarList_Single, 1);
         ast_add_child($$, 1, $1);
     }
 ;
 
 ParamDec : Specifier VarDec {
-        $$ = make_node("ParamDec", $1->lineno, 2);
-        ast_add_child($$, 2, $2, $1);
+        $$ = make_node(AST_ParamDec, PROD_ParamDec, 2);
+        ast_add_child($$, 2, $1, $2);
     }
 ;
 
 CompSt : LC DefList StmtList RC {
-        $$ = make_node("CompSt", $1->lineno, 4);
-        ast_add_child($$, 4, $4, $3, $2, $1);
+        $$ = make_node(AST_CompSt, PROD_CompSt, 4);
+        ast_add_child($$, 4, $1, $2, $3, $4);
     }
 | error RC {
         errorSyntaxFlag++;
@@ -190,37 +190,37 @@ CompSt : LC DefList StmtList RC {
 ;
 
 StmtList : Stmt StmtList {
-        $$ = make_node("StmtList", $1->lineno, 2);
-        ast_add_child($$, 2, $2, $1);
+        $$ = make_node(AST_StmtList, PROD_StmtList, 2);
+        ast_add_child($$, 2, $1, $2);
     }
 | /* empty */ {
-        $$ = NULL;
+        $$ = 0;
     }
 ;
 
 Stmt : Exp SEMI {
-        $$ = make_node("Stmt", $1->lineno, 2);
-        ast_add_child($$, 2, $2, $1);
+        $$ = make_node(AST_Stmt, PROD_Stmt_Exp, 2);
+        ast_add_child($$, 2, $1, $2);
     }
 | CompSt {
-        $$ = make_node("Stmt", $1->lineno, 1);
+        $$ = make_node(AST_Stmt, PROD_Stmt_CompSt, 1);
         ast_add_child($$, 1, $1);
     }
 | RETURN Exp SEMI {
-        $$ = make_node("Stmt", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_Stmt, PROD_Stmt_Return, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | IF LP Exp RP Stmt %prec LOWER_THAN_ELSE {
-        $$ = make_node("Stmt", $1->lineno, 5);
-        ast_add_child($$, 5, $5, $4, $3, $2, $1);
+        $$ = make_node(AST_Stmt, PROD_Stmt_If, 5);
+        ast_add_child($$, 5, $1, $2, $3, $4, $5);
     }
 | IF LP Exp RP Stmt ELSE Stmt {
-        $$ = make_node("Stmt", $1->lineno, 7);
-        ast_add_child($$, 7, $7, $6, $5, $4, $3, $2, $1);
+        $$ = make_node(AST_Stmt, PROD_Stmt_IfElse, 7);
+        ast_add_child($$, 7, $1, $2, $3, $4, $5, $6, $7);
     }
 | WHILE LP Exp RP Stmt {
-        $$ = make_node("Stmt", $1->lineno, 5);
-        ast_add_child($$, 5, $5, $4, $3, $2, $1);
+        $$ = make_node(AST_Stmt, PROD_Stmt_While, 5);
+        ast_add_child($$, 5, $1, $2, $3, $4, $5);
     }
 | Exp error {
         errorSyntaxFlag++;
@@ -232,17 +232,17 @@ Stmt : Exp SEMI {
 ;
 
 DefList : Def DefList {
-        $$ = make_node("DefList", $1->lineno, 2);
-        ast_add_child($$, 2, $2, $1);
+        $$ = make_node(AST_DefList, PROD_DefList, 2);
+        ast_add_child($$, 2, $1, $2);
     }
 | /* empty */  {
-        $$ = NULL;
+        $$ = 0;
     }
 ;
 
 Def : Specifier DecList SEMI {
-        $$ = make_node("Def", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_Def, PROD_Def, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | Specifier error SEMI {
         errorSyntaxFlag++;
@@ -250,95 +250,95 @@ Def : Specifier DecList SEMI {
 ;
 
 DecList : Dec {
-        $$ = make_node("DecList", $1->lineno, 1);
+        $$ = make_node(AST_DecList, PROD_DecList_Single, 1);
         ast_add_child($$, 1, $1);
     }
 | Dec COMMA DecList {
-        $$ = make_node("DecList", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_DecList, PROD_DecList_List, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 ;
 
 Dec : VarDec {
-        $$ = make_node("Dec", $1->lineno, 1);
+        $$ = make_node(AST_Dec, PROD_Dec_VarDec, 1);
         ast_add_child($$, 1, $1);
     }
 | VarDec ASSIGNOP Exp {
-        $$ = make_node("Dec", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_Dec, PROD_Dec_Init, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 ;
 
 Exp : Exp ASSIGNOP Exp {
-        $$ = make_node("Exp", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_Exp, PROD_Exp_Assign, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | Exp AND Exp {
-        $$ = make_node("Exp", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_Exp, PROD_Exp_And, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | Exp OR Exp {
-        $$ = make_node("Exp", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_Exp, PROD_Exp_Or, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | Exp RELOP Exp {
-        $$ = make_node("Exp", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_Exp, PROD_Exp_Relop, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | Exp PLUS Exp {
-        $$ = make_node("Exp", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_Exp, PROD_Exp_Plus, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | Exp MINUS Exp {
-        $$ = make_node("Exp", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_Exp, PROD_Exp_Minus, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | Exp STAR Exp {
-        $$ = make_node("Exp", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_Exp, PROD_Exp_Star, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | Exp DIV Exp {
-        $$ = make_node("Exp", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_Exp, PROD_Exp_Div, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | LP Exp RP {
-        $$ = make_node("Exp", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_Exp, PROD_Exp_Paren, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | MINUS Exp {
-        $$ = make_node("Exp", $1->lineno, 2);
-        ast_add_child($$, 2, $2,$1);
+        $$ = make_node(AST_Exp, PROD_Exp_Neg, 2);
+        ast_add_child($$, 2, $1, $2);
     }
 | NOT Exp {
-        $$ = make_node("Exp", $1->lineno, 2);
-        ast_add_child($$, 2, $2,$1);
+        $$ = make_node(AST_Exp, PROD_Exp_Not, 2);
+        ast_add_child($$, 2, $1, $2);
     }
 | ID LP Args RP {
-        $$ = make_node("Exp", $1->lineno, 4);
-        ast_add_child($$, 4, $4, $3, $2, $1);
+        $$ = make_node(AST_Exp, PROD_Exp_Call, 4);
+        ast_add_child($$, 4, $1, $2, $3, $4);
     }
 | ID LP RP {
-        $$ = make_node("Exp", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_Exp, PROD_Exp_CallNoArgs, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | Exp LB Exp RB {
-        $$ = make_node("Exp", $1->lineno, 4);
-        ast_add_child($$, 4, $4, $3, $2, $1);
+        $$ = make_node(AST_Exp, PROD_Exp_Index, 4);
+        ast_add_child($$, 4, $1, $2, $3, $4);
     }
 | Exp DOT ID {
-        $$ = make_node("Exp", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_Exp, PROD_Exp_Field, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | ID {
-        $$ = make_node("Exp", $1->lineno, 1);
+        $$ = make_node(AST_Exp, PROD_Exp_ID, 1);
         ast_add_child($$, 1, $1);
     }
 | INT {
-        $$ = make_node("Exp", $1->lineno, 1);
+        $$ = make_node(AST_Exp, PROD_Exp_INT, 1);
         ast_add_child($$, 1, $1);
     }
 | FLOAT {
-        $$ = make_node("Exp", $1->lineno, 1);
+        $$ = make_node(AST_Exp, PROD_Exp_FLOAT, 1);
         ast_add_child($$, 1, $1);
     }
 | Exp error{
@@ -351,11 +351,11 @@ Exp : Exp ASSIGNOP Exp {
 ;
 
 Args : Exp COMMA Args {
-        $$ = make_node("Args", $1->lineno, 3);
-        ast_add_child($$, 3, $3, $2, $1);
+        $$ = make_node(AST_Args, PROD_Args_List, 3);
+        ast_add_child($$, 3, $1, $2, $3);
     }
 | Exp {
-        $$ = make_node("Args", $1->lineno, 1);
+        $$ = make_node(AST_Args, PROD_Args_Single, 1);
         ast_add_child($$, 1, $1);
     }
 ;
@@ -4,6 +4,7 @@
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
 
 // Global variables for intermediate code generation
 int varNo = 0;
@@ -12,85 +13,141 @@ int labelNo = 0;
 InterCodes interCodeListHead = NULL;
 InterCodes interCodeListTail = NULL;
 
+/* Node pool, child index table and string table owning the whole AST */
+static ASTNode* astNodes = NULL;
+static unsigned int astNodeCount = 0;
+static unsigned int astNodeCapacity = 0;
+static ASTNodeId* astChildren = NULL;
+static unsigned int astChildCount = 0;
+static unsigned int astChildCapacity = 0;
+static char* astStrings = NULL;
+static unsigned int astStringSize = 0;
+static unsigned int astStringCapacity = 0;
+
+static const char* astKindNames[AST_KIND_COUNT] = {
+	"Program", "ExtDefList", "ExtDef", "ExtDecList", "Specifier", "StructSpecifier",
+	"OptTag", "Tag", "VarDec", "FunDec", "VarList", "ParamDec", "CompSt", "StmtList",
+	"Stmt", "DefList", "Def", "DecList", "Dec", "Exp", "Args",
+	"INT", "FLOAT", "ID", "TYPE", "SEMI", "COMMA", "ASSIGNOP", "RELOP", "PLUS", "MINUS",
+	"STAR", "DIV", "AND", "OR", "DOT", "NOT", "LP", "RP", "LB", "RB", "LC", "RC",
+	"STRUCT", "RETURN", "IF", "ELSE", "WHILE"
+};
+
+/* Grow a pool so that it holds at least needed elements, what names the pool in the out-of-memory message */
+static void* pool_grow(void* pool, unsigned int* capacity, unsigned int needed, size_t elementSize, const char* what) {
+	if (needed <= *capacity) return pool;
+	unsigned int newCapacity = *capacity ? *capacity : 1024;
+	while (newCapacity < needed) newCapacity *= 2;
+	pool = realloc(pool, (size_t)newCapacity * elementSize);
+	if (!pool) {
+		fprintf(stderr, "out of memory for %s\n", what);
+		exit(1);
+	}
+	*capacity = newCapacity;
+	return pool;
+}
+
+/* Copy a token value into the string table, offset 0 is the empty string */
+static unsigned int ast_add_string(const char* value) {
+	if (!astStrings) {
+		astStrings = (char*)pool_grow(astStrings, &astStringCapacity, 1, 1, "the syntax tree");
+		astStrings[astStringSize++] = '\0';
+	}
+	if (!value || !value[0]) return 0;
+	unsigned int length = (unsigned int)strlen(value) + 1;
+	astStrings = (char*)pool_grow(astStrings, &astStringCapacity, astStringSize + length, 1, "the syntax tree");
+	memcpy(astStrings + astStringSize, value, length);
+	unsigned int offset = astStringSize;
+	astStringSize += length;
+	return offset;
+}
+
 /* Implementation of AST node creation */
-ASTNode* ast_create_node(const char* name, const char* value, ASTNodeType type, int lineno) {
-	ASTNode* newNode = (ASTNode*)malloc(sizeof(ASTNode));
-	if (!newNode) return NULL;
-	
-	newNode->type = type;
+ASTNodeId ast_create_node(int kind, int production, const char* value, int lineno) {
+	/* Node 0 is reserved as the null node */
+	if (astNodeCount == 0) {
+		astNodes = (ASTNode*)pool_grow(astNodes, &astNodeCapacity, 1, sizeof(ASTNode), "the syntax tree");
+		memset(&astNodes[0], 0, sizeof(ASTNode));
+		astNodeCount = 1;
+	}
+	astNodes = (ASTNode*)pool_grow(astNodes, &astNodeCapacity, astNodeCount + 1, sizeof(ASTNode), "the syntax tree");
+	ASTNodeId id = astNodeCount++;
+	ASTNode* newNode = &astNodes[id];
 	newNode->lineno = lineno;
-	
-	/* Allocate memory for name and value strings */
-	size_t nameLen = strlen(name) + 1;
-	size_t valueLen = strlen(value) + 1;
-	
-	newNode->name = (char*)malloc(nameLen * sizeof(char));
-	newNode->value = (char*)malloc(valueLen * sizeof(char));
-	
-	/* Copy strings */
-	memcpy(newNode->name, name, nameLen);
-	memcpy(newNode->value, value, valueLen);
-	
-	/* Initialize pointers */
-	newNode->firstChild = NULL;
-	newNode->nextSibling = NULL;
-	
-	return newNode;
+	newNode->kind = (unsigned char)kind;
+	newNode->production = (unsigned char)production;
+	newNode->childCount = 0;
+	newNode->value = ast_add_string(value);
+	newNode->children = 0;
+	return id;
+}
+
+/* Identifier nodes keep the index of their interned name instead of a string table offset */
+ASTNodeId ast_create_id_node(const char* name, int lineno) {
+	ASTNodeId id = ast_create_node(AST_ID, PROD_NONE, "", lineno);
+	astNodes[id].value = intern_index(name);
+	return id;
 }
 
-/* Add children to an AST node */
-void ast_add_child(ASTNode* parent, int num_children, ...) {
+void ast_add_child(ASTNodeId parent, int num_children, ...) {
 	/* Check for null parent */
-	if (!parent) return;
+	ASTNode* parentNode = ast_node(parent);
+	if (!parentNode) return;
 	
+	/* Children come in right-hand-side order; empty productions yield 0 and are skipped */
 	va_list childrenList;
 	va_start(childrenList, num_children);
-	
-	/* Process each child */
+	astChildren = (ASTNodeId*)pool_grow(astChildren, &astChildCapacity, astChildCount + num_children, sizeof(ASTNodeId), "the syntax tree");
+	unsigned int first = astChildCount;
 	for (int i = 0; i < num_children; i++) {
-		ASTNode* childNode = va_arg(childrenList, ASTNode*);
-		
-		if (childNode) {
-			/* Link child to parent */
-			childNode->nextSibling = parent->firstChild;
-			parent->firstChild = childNode;
-			
-			/* Update parent line number */
-			parent->lineno = childNode->lineno;
+		ASTNodeId childId = va_arg(childrenList, ASTNodeId);
+		if (ast_node(childId)) {
+			astChildren[astChildCount++] = childId;
 		}
 	}
-	
 	va_end(childrenList);
-}
-
-/* Recursively free memory for AST tree */
-void ast_destroy(ASTNode* root) {
-	if (!root) return;
 	
-	/* Recursive destruction of children and siblings */
-	ast_destroy(root->firstChild);
-	ast_destroy(root->nextSibling);
+	parentNode->children = first;
+	parentNode->childCount = (unsigned short)(astChildCount - first);
 	
-	/* Free node data */
-	free(root->name);
-	free(root->value);
-	free(root);
+	/* Parent line number is that of its first child */
+	if (parentNode->childCount > 0) {
+		parentNode->lineno = astNodes[astChildren[first]].lineno;
+	}
+}
+
+/* Map a node id to the node, ids left over from error recovery map to NULL */
+ASTNode* ast_node(ASTNodeId id) {
+	if (id == 0 || id >= astNodeCount) return NULL;
+	return &astNodes[id];
+}
+
+const char* ast_name(const ASTNode* node) {
+	return node->kind < AST_KIND_COUNT ? astKindNames[node->kind] : "unknown";
+}
+
+char* ast_value(const ASTNode* node) {
+	if (node->kind == AST_ID) return intern_at(node->value);
+	return astStrings ? astStrings + node->value : (char*)"";
+}
+
+/* Free the node pool, child table and string table at once */
+void ast_release(void) {
+	free(astNodes);
+	free(astChildren);
+	free(astStrings);
+	astNodes = NULL;
+	astChildren = NULL;
+	astStrings = NULL;
+	astNodeCount = astNodeCapacity = 0;
+	astChildCount = astChildCapacity = 0;
+	astStringSize = astStringCapacity = 0;
 }
 
 /* Fetch a specific child node by position */
 ASTNode* getChild(ASTNode* parentNode, int position) {
-	if (!parentNode) return NULL;
-	
-	ASTNode* currentChild = parentNode->firstChild;
-	int currentPos = 0;
-	
-	/* Traverse to the requested position */
-	while (currentChild && currentPos < position) {
-		currentChild = currentChild->nextSibling;
-		currentPos++;
-	}
-	
-	return currentChild;
+	if (!parentNode || position < 0 || position >= parentNode->childCount) return NULL;
+	return &astNodes[astChildren[parentNode->children + position]];
 }
 
 /* Compare two strings for equality */
@@ -227,6 +284,68 @@ unsigned int hash_pjw(char* symbolName) {
 	return hashVal;
 }
 
+/* Interned identifiers: each distinct name is stored once together with its hash */
+typedef struct InternName_ {
+	struct InternName_* next;   /* next name in the same bucket */
+	unsigned int hash;          /* hash_pjw of the name */
+	unsigned int index;         /* position in internNames */
+	char name[];
+} InternName_;
+
+static InternName_* internBuckets[TABLESIZE + 1];
+static InternName_** internNames = NULL;
+static unsigned int internCount = 0;
+static unsigned int internCapacity = 0;
+
+static InternName_* intern_entry(const char* name) {
+	return (InternName_*)(name - offsetof(InternName_, name));
+}
+
+/* Return the unique copy of text, adding it on first sight */
+char* intern_name(const char* text) {
+	unsigned int hash = hash_pjw((char*)text);
+	for (InternName_* entry = internBuckets[hash]; entry; entry = entry->next) {
+		if (strcmp(entry->name, text) == 0) return entry->name;
+	}
+	size_t length = strlen(text) + 1;
+	InternName_* entry = (InternName_*)malloc(sizeof(InternName_) + length);
+	if (!entry) {
+		fprintf(stderr, "out of memory for identifiers\n");
+		exit(1);
+	}
+	memcpy(entry->name, text, length);
+	entry->hash = hash;
+	internNames = (InternName_**)pool_grow(internNames, &internCapacity, internCount + 1, sizeof(InternName_*), "interned names");
+	entry->index = internCount;
+	internNames[internCount++] = entry;
+	entry->next = internBuckets[hash];
+	internBuckets[hash] = entry;
+	return entry->name;
+}
+
+unsigned int intern_hash(const char* name) {
+	return intern_entry(name)->hash;
+}
+
+unsigned int intern_index(const char* name) {
+	return intern_entry(name)->index;
+}
+
+char* intern_at(unsigned int index) {
+	return internNames[index]->name;
+}
+
+/* Free every interned name */
+void intern_release(void) {
+	for (unsigned int i = 0; i < internCount; i++) {
+		free(internNames[i]);
+	}
+	free(internNames);
+	internNames = NULL;
+	internCount = internCapacity = 0;
+	memset(internBuckets, 0, sizeof(internBuckets));
+}
+
 /* Print AST node information */
 void print_node_info(const char* name, const char* value) {
     printf("%s", name);
@@ -246,13 +365,11 @@ void ast_print(ASTNode* root, int depth) {
     }
     
     // Print current node
-    print_node_info(root->name, root->value);
+    print_node_info(ast_name(root), ast_value(root));
     
     // Recursively print children
-    ASTNode* child = root->firstChild;
-    while (child != NULL) {
-        ast_print(child, depth + 1);
-        child = child->nextSibling;
+    for (int i = 0; i < root->childCount; i++) {
+        ast_print(getChild(root, i), depth + 1);
     }
 }
 
@@ -358,8 +475,8 @@ Operand ir_create_operand(int operandKind, int dataType, ...) {
     va_list args;
     va_start(args, dataType);
     
-    // Allocate memory for the operand
-    Operand op = (Operand)malloc(sizeof(struct Operand_));
+    // Allocate zeroed memory so fields a kind does not set (e.g. varName of a temp) stay NULL
+    Operand op = (Operand)calloc(1, sizeof(struct Operand_));
     if (!op) {
         printf("Memory allocation error in ir_create_operand\n");
         va_end(args);
@@ -405,50 +522,108 @@ Operand ir_create_operand(int operandKind, int dataType, ...) {
 }
 
 /**
- * Outputs the string representation of an operand to the given file
+ * Appends length bytes of text to the buffer, growing it geometrically
+ * @param buffer Text buffer
+ * @param text Text to append
+ * @param length Number of bytes to append
+ */
+void text_append(TextBuffer buffer, const char *text, size_t length) {
+    if (buffer->size + length > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity * 2 : 4096;
+        while (buffer->size + length > capacity) {
+            capacity *= 2;
+        }
+        buffer->data = (char*)realloc(buffer->data, capacity);
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->size, text, length);
+    buffer->size += length;
+}
+
+void text_append_string(TextBuffer buffer, const char *text) {
+    text_append(buffer, text, strlen(text));
+}
+
+void text_append_char(TextBuffer buffer, char c) {
+    text_append(buffer, &c, 1);
+}
+
+/**
+ * Appends a decimal integer, digits are produced from the right without printf
+ * @param buffer Text buffer
+ * @param value Integer to append
+ */
+void text_append_int(TextBuffer buffer, long long value) {
+    char digits[24];
+    int pos = sizeof(digits);
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    do {
+        digits[--pos] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0) {
+        digits[--pos] = '-';
+    }
+    text_append(buffer, digits + pos, sizeof(digits) - pos);
+}
+
+/**
+ * Writes the whole buffer with a single fwrite and empties it
+ * @param buffer Text buffer
+ * @param file Output file
+ */
+void text_write(TextBuffer buffer, FILE *file) {
+    if (buffer->size > 0) {
+        fwrite(buffer->data, 1, buffer->size, file);
+    }
+    buffer->size = 0;
+}
+
+void text_free(TextBuffer buffer) {
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->size = buffer->capacity = 0;
+}
+
+/**
+ * Appends the string representation of an operand to the buffer
  * @param op The operand to print
- * @param outFile The file to write output to
+ * @param buffer The text buffer to append to
  */
-void ir_output_operand(Operand op, FILE* outFile) {
+void ir_output_operand(Operand op, TextBuffer buffer) {
     // Validate input parameters
     if (!op) {
-        fprintf(outFile, "[NULL_OPERAND]");
-        return;
-    }
-    
-    if (!outFile) {
-        printf("Error: Invalid output file in ir_output_operand\n");
+        text_append_string(buffer, "[NULL_OPERAND]");
         return;
     }
     
     // Format and output based on operand type
     switch (op->kind) {
         case VARIABLE_OP:  // Variable
-            fprintf(outFile, "%sv%d", (op->type == ADDRESS ? "&" : ""), op->var_no);
+            text_append_string(buffer, op->type == ADDRESS ? "&v" : "v");
+            text_append_int(buffer, op->var_no);
             break;
             
         case CONSTANT_OP:  // Constant value
-            fprintf(outFile, "#%d", op->value);
+            text_append_char(buffer, '#');
+            text_append_int(buffer, op->value);
             break;
             
         case TEMP_OP:  // Temporary variable
-            fprintf(outFile, "%st%d", (op->type == ADDRESS ? "*" : ""), op->var_no);
+            text_append_string(buffer, op->type == ADDRESS ? "*t" : "t");
+            text_append_int(buffer, op->var_no);
             break;
             
         case LABEL_OP:  // Code label
-            fprintf(outFile, "%d", op->var_no);
+            text_append_int(buffer, op->var_no);
             break;
             
         case FUNCTION_OP:  // Function name
-            if (op->funcName) {
-                fprintf(outFile, "%s", op->funcName);
-            } else {
-                fprintf(outFile, "[UNNAMED_FUNCTION]");
-            }
+            text_append_string(buffer, op->funcName ? op->funcName : "[UNNAMED_FUNCTION]");
             break;
             
         default:
-            fprintf(outFile, "[UNKNOWN_OPERAND_TYPE]");
+            text_append_string(buffer, "[UNKNOWN_OPERAND_TYPE]");
     }
 }
 
@@ -475,155 +650,179 @@ void ir_write_codes(FILE* outFile) {
         return;
     }
     
+    // Format everything into memory and write it out at once
+    TextBuffer_ text = {NULL, 0, 0};
+    TextBuffer buffer = &text;
+
     // Traverse the list and print each code
     InterCodes current = interCodeListHead->next;
     while (current && current != interCodeListHead) {
         // Format output based on code type
         switch (current->code.kind) {
             case LABEL_InterCode:  // Label definition
-                fprintf(outFile, "LABEL label");
-                ir_output_operand(current->code.u.singleOP.op, outFile);
-                fprintf(outFile, " : \n");
+                text_append_string(buffer, "LABEL label");
+                ir_output_operand(current->code.u.singleOP.op, buffer);
+                text_append_string(buffer, " : \n");
                 break;
                 
             case FUNC_InterCode:  // Function definition
-                fprintf(outFile, "FUNCTION ");
-                ir_output_operand(current->code.u.singleOP.op, outFile);
-                fprintf(outFile, " : \n");
+                text_append_string(buffer, "FUNCTION ");
+                ir_output_operand(current->code.u.singleOP.op, buffer);
+                text_append_string(buffer, " : \n");
                 break;
                 
             case ASSIGN_InterCode:  // Assignment
-                ir_output_operand(current->code.u.doubleOP.left, outFile);
-                fprintf(outFile, " := ");
-                ir_output_operand(current->code.u.doubleOP.right, outFile);
-                fprintf(outFile, "\n");
+                ir_output_operand(current->code.u.doubleOP.left, buffer);
+                text_append_string(buffer, " := ");
+                ir_output_operand(current->code.u.doubleOP.right, buffer);
+                text_append_string(buffer, "\n");
                 break;
                 
             case ADD_InterCode:  // Addition
-                ir_output_operand(current->code.u.tripleOP.result, outFile);
-                fprintf(outFile, " := ");
-                ir_output_operand(current->code.u.tripleOP.op1, outFile);
-                fprintf(outFile, " + ");
-                ir_output_operand(current->code.u.tripleOP.op2, outFile);
-                fprintf(outFile, "\n");
+                ir_output_operand(current->code.u.tripleOP.result, buffer);
+                text_append_string(buffer, " := ");
+                ir_output_operand(current->code.u.tripleOP.op1, buffer);
+                text_append_string(buffer, " + ");
+                ir_output_operand(current->code.u.tripleOP.op2, buffer);
+                text_append_string(buffer, "\n");
                 break;
                 
             case SUB_InterCode:  // Subtraction
-                ir_output_operand(current->code.u.tripleOP.result, outFile);
-                fprintf(outFile, " := ");
-                ir_output_operand(current->code.u.tripleOP.op1, outFile);
-                fprintf(outFile, " - ");
-                ir_output_operand(current->code.u.tripleOP.op2, outFile);
-                fprintf(outFile, "\n");
+                ir_output_operand(current->code.u.tripleOP.result, buffer);
+                text_append_string(buffer, " := ");
+                ir_output_operand(current->code.u.tripleOP.op1, buffer);
+                text_append_string(buffer, " - ");
+                ir_output_operand(current->code.u.tripleOP.op2, buffer);
+                text_append_string(buffer, "\n");
                 break;
                 
             case MUL_InterCode:  // Multiplication
-                ir_output_operand(current->code.u.tripleOP.result, outFile);
-                fprintf(outFile, " := ");
-                ir_output_operand(current->code.u.tripleOP.op1, outFile);
-                fprintf(outFile, " * ");
-                ir_output_operand(current->code.u.tripleOP.op2, outFile);
-                fprintf(outFile, "\n");
+                ir_output_operand(current->code.u.tripleOP.result, buffer);
+                text_append_string(buffer, " := ");
+                ir_output_operand(current->code.u.tripleOP.op1, buffer);
+                text_append_string(buffer, " * ");
+                ir_output_operand(current->code.u.tripleOP.op2, buffer);
+                text_append_string(buffer, "\n");
                 break;
                 
             case DIV_InterCode:  // Division
-                ir_output_operand(current->code.u.tripleOP.result, outFile);
-                fprintf(outFile, " := ");
-                ir_output_operand(current->code.u.tripleOP.op1, outFile);
-                fprintf(outFile, " / ");
-                ir_output_operand(current->code.u.tripleOP.op2, outFile);
-                fprintf(outFile, "\n");
+                ir_output_operand(current->code.u.tripleOP.result, buffer);
+                text_append_string(buffer, " := ");
+                ir_output_operand(current->code.u.tripleOP.op1, buffer);
+                text_append_string(buffer, " / ");
+                ir_output_operand(current->code.u.tripleOP.op2, buffer);
+                text_append_string(buffer, "\n");
                 break;
                 
             case GET_ADDR_InterCode:  // Get address
-                ir_output_operand(current->code.u.doubleOP.left, outFile);
-                fprintf(outFile, " := &");
-                ir_output_operand(current->code.u.doubleOP.right, outFile);
-                fprintf(outFile, "\n");
+                ir_output_operand(current->code.u.doubleOP.left, buffer);
+                text_append_string(buffer, " := &");
+                ir_output_operand(current->code.u.doubleOP.right, buffer);
+                text_append_string(buffer, "\n");
                 break;
                 
             case GET_CONTENT_InterCode:  // Dereference
-                ir_output_operand(current->code.u.doubleOP.left, outFile);
-                fprintf(outFile, " := *");
-                ir_output_operand(current->code.u.doubleOP.right, outFile);
-                fprintf(outFile, "\n");
+                ir_output_operand(current->code.u.doubleOP.left, buffer);
+                text_append_string(buffer, " := *");
+                ir_output_operand(current->code.u.doubleOP.right, buffer);
+                text_append_string(buffer, "\n");
                 break;
                 
             case TO_ADDR_InterCode:  // Store to address
-                fprintf(outFile, "*");
-                ir_output_operand(current->code.u.doubleOP.left, outFile);
-                fprintf(outFile, " := ");
-                ir_output_operand(current->code.u.doubleOP.right, outFile);
-                fprintf(outFile, "\n");
+                text_append_string(buffer, "*");
+                ir_output_operand(current->code.u.doubleOP.left, buffer);
+                text_append_string(buffer, " := ");
+                ir_output_operand(current->code.u.doubleOP.right, buffer);
+                text_append_string(buffer, "\n");
                 break;
                 
             case GOTO_InterCode:  // Unconditional jump
-                fprintf(outFile, "GOTO label");
-                ir_output_operand(current->code.u.singleOP.op, outFile);
-                fprintf(outFile, "\n");
+                text_append_string(buffer, "GOTO label");
+                ir_output_operand(current->code.u.singleOP.op, buffer);
+                text_append_string(buffer, "\n");
                 break;
                 
             case IFGOTO_InterCode:  // Conditional branch
-                fprintf(outFile, "IF ");
-                ir_output_operand(current->code.u.ifgotoOP.op1, outFile);
-                fprintf(outFile, " %s ", current->code.u.ifgotoOP.relop);
-                ir_output_operand(current->code.u.ifgotoOP.op2, outFile);
-                fprintf(outFile, " GOTO label");
-                ir_output_operand(current->code.u.ifgotoOP.label, outFile);
-                fprintf(outFile, "\n");
+                text_append_string(buffer, "IF ");
+                ir_output_operand(current->code.u.ifgotoOP.op1, buffer);
+                text_append_char(buffer, ' ');
+                text_append_string(buffer, current->code.u.ifgotoOP.relop);
+                text_append_char(buffer, ' ');
+                ir_output_operand(current->code.u.ifgotoOP.op2, buffer);
+                text_append_string(buffer, " GOTO label");
+                ir_output_operand(current->code.u.ifgotoOP.label, buffer);
+                text_append_string(buffer, "\n");
                 break;
                 
             case RETURN_InterCode:  // Function return
-                fprintf(outFile, "RETURN ");
-                ir_output_operand(current->code.u.singleOP.op, outFile);
-                fprintf(outFile, "\n");
+                text_append_string(buffer, "RETURN ");
+                ir_output_operand(current->code.u.singleOP.op, buffer);
+                text_append_string(buffer, "\n");
                 break;
                 
             case DEC_InterCode:  // Memory allocation
-                fprintf(outFile, "DEC ");
-                ir_output_operand(current->code.u.doubleOP.left, outFile);
-                fprintf(outFile, " %d", current->code.u.doubleOP.right->value);
-                fprintf(outFile, "\n");
+                text_append_string(buffer, "DEC ");
+                ir_output_operand(current->code.u.doubleOP.left, buffer);
+                text_append_char(buffer, ' ');
+                text_append_int(buffer, current->code.u.doubleOP.right->value);
+                text_append_string(buffer, "\n");
                 break;
                 
             case ARG_InterCode:  // Function argument
-                fprintf(outFile, "ARG ");
-                ir_output_operand(current->code.u.singleOP.op, outFile);
-                fprintf(outFile, "\n");
+                text_append_string(buffer, "ARG ");
+                ir_output_operand(current->code.u.singleOP.op, buffer);
+                text_append_string(buffer, "\n");
                 break;
                 
             case CALL_InterCode:  // Function call
-                ir_output_operand(current->code.u.doubleOP.left, outFile);
-                fprintf(outFile, " := CALL ");
-                ir_output_operand(current->code.u.doubleOP.right, outFile);
-                fprintf(outFile, "\n");
+                ir_output_operand(current->code.u.doubleOP.left, buffer);
+                text_append_string(buffer, " := CALL ");
+                ir_output_operand(current->code.u.doubleOP.right, buffer);
+                text_append_string(buffer, "\n");
                 break;
                 
             case PARAM_InterCode:  // Parameter declaration
-                fprintf(outFile, "PARAM ");
-                ir_output_operand(current->code.u.singleOP.op, outFile);
-                fprintf(outFile, "\n");
+                text_append_string(buffer, "PARAM ");
+                ir_output_operand(current->code.u.singleOP.op, buffer);
+                text_append_string(buffer, "\n");
                 break;
                 
             case READ_InterCode:  // Read from console
-                fprintf(outFile, "READ ");
-                ir_output_operand(current->code.u.singleOP.op, outFile);
-                fprintf(outFile, "\n");
+                text_append_string(buffer, "READ ");
+                ir_output_operand(current->code.u.singleOP.op, buffer);
+                text_append_string(buffer, "\n");
                 break;
                 
             case WRITE_InterCode:  // Write to console
-                fprintf(outFile, "WRITE ");
-                ir_output_operand(current->code.u.singleOP.op, outFile);
-                fprintf(outFile, "\n");
+                text_append_string(buffer, "WRITE ");
+                ir_output_operand(current->code.u.singleOP.op, buffer);
+                text_append_string(buffer, "\n");
+                break;
+
+            case PHI_InterCode:  // SSA phi function
+                ir_output_operand(current->code.u.phiOP.result, buffer);
+                text_append_string(buffer, " := PHI(");
+                for (int i = 0; i < current->code.u.phiOP.argCount; i++) {
+                    if (i > 0) {
+                        text_append_string(buffer, ", ");
+                    }
+                    ir_output_operand(current->code.u.phiOP.args[i], buffer);
+                }
+                text_append_string(buffer, ")\n");
                 break;
                 
             default:
-                fprintf(outFile, "[UNKNOWN_CODE_TYPE: %d]\n", current->code.kind);
+                text_append_string(buffer, "[UNKNOWN_CODE_TYPE: ");
+                text_append_int(buffer, current->code.kind);
+                text_append_string(buffer, "]\n");
         }
         
         // Move to next code in the list
         current = current->next;
     }
+
+    text_write(buffer, outFile);
+    text_free(buffer);
 }
 
 /**
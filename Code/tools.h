@@ -22,21 +22,132 @@ typedef struct FunctionTable_ *FunctionTable;
 typedef struct Operand_ *Operand;
 typedef struct InterCodes_ *InterCodes;
 
-/* 抽象语法树节点类型 */
+/* 语法树节点种类：非终结符和词法单元各对应一个整数，遍历时按它分发，名字只用于 ast_print */
 typedef enum {
-    NODE_TYPE_NON_TERMINAL = 0,  // 非终结符节点
-    NODE_TYPE_TERMINAL = 1,      // 终结符节点
-    NODE_TYPE_TOKEN = 2          // 词法单元节点
-} ASTNodeType;
+    AST_Program = 0,
+    AST_ExtDefList,
+    AST_ExtDef,
+    AST_ExtDecList,
+    AST_Specifier,
+    AST_StructSpecifier,
+    AST_OptTag,
+    AST_Tag,
+    AST_VarDec,
+    AST_FunDec,
+    AST_VarList,
+    AST_ParamDec,
+    AST_CompSt,
+    AST_StmtList,
+    AST_Stmt,
+    AST_DefList,
+    AST_Def,
+    AST_DecList,
+    AST_Dec,
+    AST_Exp,
+    AST_Args,
+    /* 词法单元 */
+    AST_INT,
+    AST_FLOAT,
+    AST_ID,
+    AST_TYPE,
+    AST_SEMI,
+    AST_COMMA,
+    AST_ASSIGNOP,
+    AST_RELOP,
+    AST_PLUS,
+    AST_MINUS,
+    AST_STAR,
+    AST_DIV,
+    AST_AND,
+    AST_OR,
+    AST_DOT,
+    AST_NOT,
+    AST_LP,
+    AST_RP,
+    AST_LB,
+    AST_RB,
+    AST_LC,
+    AST_RC,
+    AST_STRUCT,
+    AST_RETURN,
+    AST_IF,
+    AST_ELSE,
+    AST_WHILE,
+    AST_KIND_COUNT
+} ASTNodeKind;
 
-/* 抽象语法树节点结构 */
+/* 产生式编号：非终结符节点由语法中的哪一条产生式归约而来，词法单元为 PROD_NONE */
+typedef enum {
+    PROD_NONE = 0,
+    PROD_Program,              // Program -> ExtDefList
+    PROD_ExtDefList,           // ExtDefList -> ExtDef ExtDefList
+    PROD_ExtDef_Global,        // ExtDef -> Specifier ExtDecList SEMI
+    PROD_ExtDef_Type,          // ExtDef -> Specifier SEMI
+    PROD_ExtDef_Function,      // ExtDef -> Specifier FunDec CompSt
+    PROD_ExtDef_FunDecl,       // ExtDef -> Specifier FunDec SEMI
+    PROD_ExtDecList_Single,    // ExtDecList -> VarDec
+    PROD_ExtDecList_List,      // ExtDecList -> VarDec COMMA ExtDecList
+    PROD_Specifier_Type,       // Specifier -> TYPE
+    PROD_Specifier_Struct,     // Specifier -> StructSpecifier
+    PROD_StructSpecifier_Def,  // StructSpecifier -> STRUCT OptTag LC DefList RC
+    PROD_StructSpecifier_Tag,  // StructSpecifier -> STRUCT Tag
+    PROD_OptTag,               // OptTag -> ID
+    PROD_Tag,                  // Tag -> ID
+    PROD_VarDec_ID,            // VarDec -> ID
+    PROD_VarDec_Array,         // VarDec -> VarDec LB INT RB
+    PROD_FunDec_Params,        // FunDec -> ID LP VarList RP
+    PROD_FunDec_NoParams,      // FunDec -> ID LP RP
+    PROD_VarList_List,         // VarList -> ParamDec COMMA VarList
+    PROD_VarList_Single,       // VarList -> ParamDec
+    PROD_ParamDec,             // ParamDec -> Specifier VarDec
+    PROD_CompSt,               // CompSt -> LC DefList StmtList RC
+    PROD_StmtList,             // StmtList -> Stmt StmtList
+    PROD_Stmt_Exp,             // Stmt -> Exp SEMI
+    PROD_Stmt_CompSt,          // Stmt -> CompSt
+    PROD_Stmt_Return,          // Stmt -> RETURN Exp SEMI
+    PROD_Stmt_If,              // Stmt -> IF LP Exp RP Stmt
+    PROD_Stmt_IfElse,          // Stmt -> IF LP Exp RP Stmt ELSE Stmt
+    PROD_Stmt_While,           // Stmt -> WHILE LP Exp RP Stmt
+    PROD_DefList,              // DefList -> Def DefList
+    PROD_Def,                  // Def -> Specifier DecList SEMI
+    PROD_DecList_Single,       // DecList -> Dec
+    PROD_DecList_List,         // DecList -> Dec COMMA DecList
+    PROD_Dec_VarDec,           // Dec -> VarDec
+    PROD_Dec_Init,             // Dec -> VarDec ASSIGNOP Exp
+    PROD_Exp_Assign,           // Exp -> Exp ASSIGNOP Exp
+    PROD_Exp_And,              // Exp -> Exp AND Exp
+    PROD_Exp_Or,               // Exp -> Exp OR Exp
+    PROD_Exp_Relop,            // Exp -> Exp RELOP Exp
+    PROD_Exp_Plus,             // Exp -> Exp PLUS Exp
+    PROD_Exp_Minus,            // Exp -> Exp MINUS Exp
+    PROD_Exp_Star,             // Exp -> Exp STAR Exp
+    PROD_Exp_Div,              // Exp -> Exp DIV Exp
+    PROD_Exp_Paren,            // Exp -> LP Exp RP
+    PROD_Exp_Neg,              // Exp -> MINUS Exp
+    PROD_Exp_Not,              // Exp -> NOT Exp
+    PROD_Exp_Call,             // Exp -> ID LP Args RP
+    PROD_Exp_CallNoArgs,       // Exp -> ID LP RP
+    PROD_Exp_Index,            // Exp -> Exp LB Exp RB
+    PROD_Exp_Field,            // Exp -> Exp DOT ID
+    PROD_Exp_ID,               // Exp -> ID
+    PROD_Exp_INT,              // Exp -> INT
+    PROD_Exp_FLOAT,            // Exp -> FLOAT
+    PROD_Args_List,            // Args -> Exp COMMA Args
+    PROD_Args_Single,          // Args -> Exp
+    PROD_COUNT
+} ASTProduction;
+
+/* 语法树节点在节点池中的下标，0 表示空节点；语法分析时节点池会扩容，只能保存下标 */
+typedef unsigned int ASTNodeId;
+
+/* 抽象语法树节点结构：节点连续存放在节点池中，子节点下标连续存放在子节点表中，词法单元的值存放在字符串表中 */
 typedef struct ASTNode {
-    int lineno;                     // 行号
-    ASTNodeType type;              // 节点类型
-    char* name;                    // 节点名称
-    char* value;                   // 节点值
-    struct ASTNode* firstChild;    // 第一个子节点
-    struct ASTNode* nextSibling;   // 下一个兄弟节点
+    int lineno;                    // 行号
+    unsigned char kind;            // 节点种类 ASTNodeKind
+    unsigned char production;      // 产生式编号 ASTProduction
+    unsigned short childCount;     // 子节点个数，空产生式得到的子节点不占位
+    unsigned int value;            // 节点值在字符串表中的偏移，0 为空串
+    unsigned int children;         // 第一个子节点在子节点表中的位置，按产生式右部顺序排列
 } ASTNode;
 
 /* Type_ 节点信息 */
@@ -91,15 +202,17 @@ typedef struct SymbolTableNode_
     int isAddress;
     int offset;
     char *structName;
-    SymbolTableNode sameHashSymbolTableNode;
-    SymbolTableNode controlScopeSymbolTableNode;
+    SymbolTableNode sameHashSymbolTableNode;     // 同一哈希桶中的下一个符号，内层作用域的符号在前
+    SymbolTableNode controlScopeSymbolTableNode; // 同一作用域中的下一个符号，后加入的在前
 } SymbolTableNode_;
 
-/* HashTable 符号表 */
+/* HashTable 作用域：退出时它的符号从哈希桶中摘下，但仍挂在作用域上，中间代码生成时重新进入 */
 typedef struct HashTableNode_
 {
-    SymbolTableNode symbolTableNode;
-    HashTableNode nextHashTableNode;
+    SymbolTableNode symbolTableNode;   // 作用域中的符号
+    HashTableNode nextHashTableNode;   // 按创建顺序排列的下一个作用域
+    HashTableNode enclosingScope;      // 外层作用域
+    ASTNode *ownerNode;                // 建立作用域的语法树节点：函数的 ExtDef 或语句中的 CompSt
 } HashTableNode_;
 
 /* FunctionTable 函数表 */
@@ -151,7 +264,7 @@ struct Operand_
     } type;
     int var_no;     //标号数
     int value;      //数值
-    char *varName;  //变量名
+    char *varName;  //变量名，驻留后的名字，可直接用于符号表查找；临时变量等没有名字的操作数为 NULL
     char *funcName; //函数名
     int depth;
 } Operand_;
@@ -178,7 +291,8 @@ struct InterCode
         CALL_InterCode,        //调用函数，并将其返回值赋给x x := CALL f
         PARAM_InterCode,       //函数参数声明 PARAM x
         READ_InterCode,        //从控制台读取x的值 READ x
-        WRITE_InterCode        //向控制台打印x的值 WRITE x
+        WRITE_InterCode,       //向控制台打印x的值 WRITE x
+        PHI_InterCode          //SSA形式的φ函数，只在优化阶段出现 x := PHI(y1, y2, ...)
     } kind;
     union
     {
@@ -199,6 +313,12 @@ struct InterCode
             Operand op1, op2, label;
             char *relop;
         } ifgotoOP; // IFGOTO
+        struct
+        {
+            Operand result;
+            Operand *args; // 第i个参数来自所在基本块的第i个前驱
+            int argCount;
+        } phiOP; // PHI
     } u;
 } InterCode;
 
@@ -208,6 +328,16 @@ struct InterCodes_
     InterCodes prev, next;
 } InterCodes_; //双向链表
 
+/* TextBuffer 只追加的文本缓冲区，生成结束后一次写入文件 */
+typedef struct TextBuffer_
+{
+    char *data;
+    size_t size;
+    size_t capacity;
+} TextBuffer_;
+
+typedef TextBuffer_ *TextBuffer;
+
 extern ASTNode* ast_root;
 extern int yylineno;
 extern int varNo;
@@ -217,9 +347,22 @@ extern InterCodes interCodeListHead;
 extern InterCodes interCodeListTail;
 
 /* AST节点操作函数 */
-ASTNode* ast_create_node(const char* name, const char* value, ASTNodeType type, int lineno);
-void ast_add_child(ASTNode* parent, int num_children, ...);
-void ast_destroy(ASTNode* root);
+/* 在节点池中创建节点，value 复制到字符串表中 */
+ASTNodeId ast_create_node(int kind, int production, const char* value, int lineno);
+/* 产生式右部最多的符号个数（Stmt -> IF LP Exp RP Stmt ELSE Stmt） */
+#define AST_MAX_CHILDREN 7
+/* 创建标识符节点，name 必须是 intern_name 返回的驻留名字，节点中只保存它在驻留表中的编号 */
+ASTNodeId ast_create_id_node(const char* name, int lineno);
+/* 按产生式右部顺序挂上子节点，父节点的行号取第一个子节点的行号 */
+void ast_add_child(ASTNodeId parent, int num_children, ...);
+/* 由下标取节点；语法分析结束后节点池不再扩容，取得的指针一直有效 */
+ASTNode* ast_node(ASTNodeId id);
+/* 节点名称，只用于打印语法树和调试输出 */
+const char* ast_name(const ASTNode* node);
+/* 节点值，词法单元以外的节点为空串 */
+char* ast_value(const ASTNode* node);
+/* 释放节点池、子节点表和字符串表；中间代码的操作数仍引用其中的名字，须在目标代码生成之后调用 */
+void ast_release(void);
 void ast_print(ASTNode* root, int depth);
 
 void print_node_info(const char* name, const char* value);
@@ -233,15 +376,36 @@ int to_Dec(char *str);
 char* ita(int num, char *str);
 int My_atoi(char *str);
 unsigned int hash_pjw(char *name);
+
+/* 标识符驻留表：每个不同的名字只保存一份并记下 hash_pjw 的值，驻留后的名字可以直接比较指针 */
+/* 返回 text 的驻留副本，第一次出现时加入驻留表 */
+char* intern_name(const char* text);
+/* 以下函数的 name 必须是 intern_name 返回的非空驻留名字（不检查，传入其他指针是未定义行为）：取预先算好的哈希值和在驻留表中的编号 */
+unsigned int intern_hash(const char* name);
+unsigned int intern_index(const char* name);
+char* intern_at(unsigned int index);
+/* 释放全部驻留名字，须在最后一次使用名字之后调用 */
+void intern_release(void);
+/* 取第 childnum 个子节点，越界返回 NULL */
 ASTNode *getChild(ASTNode *root, int childnum);
 
+/* 文本缓冲区函数 */
+void text_append(TextBuffer buffer, const char *text, size_t length);
+void text_append_string(TextBuffer buffer, const char *text);
+void text_append_char(TextBuffer buffer, char c);
+/* 追加十进制整数，不经过 printf 的格式解析 */
+void text_append_int(TextBuffer buffer, long long value);
+/* 用一次 fwrite 写出缓冲区内容并清空 */
+void text_write(TextBuffer buffer, FILE *file);
+void text_free(TextBuffer buffer);
+
 /* 中间代码相关函数 */
 /* 生成新的中间代码节点 */
 void ir_generate_code(int opKind, ...);
 /* 构造操作数对象 */
 Operand ir_create_operand(int opKind, int dataType, ...);
 /* 格式化输出操作数 */
-void ir_output_operand(Operand op, FILE *outFile);
+void ir_output_operand(Operand op, TextBuffer buffer);
 /* 输出所有中间代码到文件 */
 void ir_write_codes(FILE *outFile);
 /* 创建操作数的深拷贝 */